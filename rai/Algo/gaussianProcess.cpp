@@ -94,14 +94,15 @@ void GaussianProcess::recompute() {
     }
   }
   gram = gram + obsVar * eye(gram.d0);
-  inverse_SymPosDef(Ginv, gram);
-  if(!dN) {
-    if(N) GinvY = Ginv * (Y-Mu_func-mu); else GinvY.clear();
-  } else {
-    arr Yfull; Yfull.append(Y-Mu_func-mu); Yfull.append(dY);
-    GinvY = Ginv * Yfull;
+  cholG.clear();
+  for(i=0; i<gram.d0; i++) {
+    arr k(i);
+    for(j=0; j<i; j++) k(j) = gram(i, j);
+    cholesky_appendPacked(cholG, k, gram(i, i));
   }
-  //cout <<"gram=" <<gram <<" Ginv=" <<Ginv <<endl;
+  arr Yfull; Yfull.append(Y-Mu_func-mu); Yfull.append(dY);
+  GinvY = cholesky_solvePacked(cholG, cholesky_solvePacked(cholG, Yfull), true);
+  //cout <<"gram=" <<gram <<" cholG=" <<cholG <<endl;
 }
 
 void GaussianProcess::appendObservation(const arr& x, double y) {
@@ -110,11 +111,20 @@ void GaussianProcess::appendObservation(const arr& x, double y) {
   Y.append(y);
   X.reshape(N+1, x.N);
   Y.reshape(N+1);
+  if(dY.N || cholG.N!=N*(N+1)/2 || GinvY.N!=N) { recompute(); return; }
+
+  //-- append a row to the packed Cholesky factor in O(N^2), instead of refactoring the Gram matrix
+  //(a tiny or negative pivot, due to a (nearly) duplicate input, is jittered by cholesky_appendPacked)
+  arr k(N), Yc(N+1), xi;
+  for(uint i=0; i<N; i++) { xi.referToDim(X, i); k(i) = cov(kernelP, xi, x); Yc(i) = Y(i) - mu_func(xi, priorP) - mu; }
+  Yc(N) = y - mu_func(x, priorP) - mu;
+  cholesky_appendPacked(cholG, k, cov(kernelP, x, x) + obsVar);
+  GinvY = cholesky_solvePacked(cholG, cholesky_solvePacked(cholG, Yc), true);
 #if RAI_GP_DEBUG
-  arr iG=Ginv;
+  arr L=cholG;
   recompute();
-  double err=maxDiff(iG, Ginv);
-  CHECK(err<1e-6, "mis-updated inverse Gram matrix" <<err <<endl <<iG <<Ginv);
+  double err=maxDiff(L, cholG);
+  CHECK(err<1e-6, "mis-updated Cholesky factor" <<err <<endl <<L <<cholG);
 #endif
 }
 
@@ -138,7 +148,7 @@ double GaussianProcess::max_var() {
 
 void GaussianProcess::evaluate(const arr& x, double& y, double& sig, bool calcSig) {
   uint i, N=Y.N, dN=dY.N;
-  /*static*/ arr k, xi, Ginvk; //danny: why was there a static
+  /*static*/ arr k, xi; //danny: why was there a static
   if(N+dN==0) { //no data
     y = mu_func(x, priorP) + mu;
     sig=::sqrt(cov(kernelP, x, x));
@@ -151,8 +161,7 @@ void GaussianProcess::evaluate(const arr& x, double& y, double& sig, bool calcSi
 
   y = scalarProduct(k, GinvY) + mu_func(x, priorP) + mu;
   if(calcSig) {
-    op_innerProduct(Ginvk, Ginv, k);
-    sig = cov(kernelP, x, x) - scalarProduct(k, Ginvk);
+    sig = cov(kernelP, x, x) - sumOfSqr(cholesky_solvePacked(cholG, k)); //k^T G^-1 k = |L^-1 k|^2
     //if(sig<=10e-10) {
     //cout << "---" << endl;
     //cout << "x==" << x << endl;
@@ -168,9 +177,9 @@ void GaussianProcess::evaluate(const arr& x, double& y, double& sig, bool calcSi
 }
 
 double GaussianProcess::log_likelihood() {
-  arr gram;
-  inverse_SymPosDef(gram, Ginv);
-  return (-.5*~Y*GinvY - .5*log(length(gram)) - (X.N+dX.N)/2 * log(2*RAI_PI))(0); // actually a degenerated array of size 1x1
+  double logDet=0.; //log|G| = 2 sum_i log L_ii
+  for(uint i=0; i<GinvY.N; i++) logDet += 2.*::log(cholG.elem(i*(i+3)/2));
+  return (-.5*~Y*GinvY - .5*logDet - (X.N+dX.N)/2 * log(2*RAI_PI))(0); // actually a degenerated array of size 1x1
 }
 
 /** vector of covariances between test point and N+dN observation points */
@@ -375,12 +384,40 @@ void GaussianProcess::gradientV(arr& grad, const arr& x) {
   arr k, dk;
   k_star(x, k);
   dk_star(x, dk);
-  grad = -2.0*~k*Ginv*dk;
+  grad = -2.0*~cholesky_solvePacked(cholG, k)*cholesky_solvePacked(cholG, dk); //k^T G^-1 dk = (L^-1 k)^T (L^-1 dk)
 }
 
-void GaussianProcess::evaluate(const arr& X, arr& Y, arr& S) {
-  uint i;
-  arr xi;
-  Y.resize(X.d0); S.resize(X.d0);
-  for(i=0; i<X.d0; i++) { xi.referToDim(X, i); evaluate(xi, Y(i), S(i)); }
+void GaussianProcess::evaluate(const arr& Z, arr& Y, arr& S) {
+  uint i, j, N=this->Y.N;
+  arr zi, xj;
+  Y.resize(Z.d0); S.resize(Z.d0);
+  if(dY.N || !N || GinvY.N!=N) { //derivative observations: point by point
+    for(i=0; i<Z.d0; i++) { zi.referToDim(Z, i); evaluate(zi, Y(i), S(i)); }
+    return;
+  }
+
+  //-- all cross-covariances as one matrix; the Gauss kernel via squared distances and exp over contiguous memory
+  arr Ks;
+  if(cov==GaussKernel) {
+    GaussKernelParams& P = *((GaussKernelParams*)kernelP);
+    Ks = sqrDistances(Z, X);
+    for(double *k=Ks.p, *kstop=Ks.p+Ks.N; k!=kstop; k++) *k = P.priorVar*::exp(-.5 * *k/P.widthVar);
+  } else {
+    Ks.resize(Z.d0, N);
+    for(i=0; i<Z.d0; i++) {
+      zi.referToDim(Z, i);
+      for(j=0; j<N; j++) { xj.referToDim(X, j); Ks(i, j) = cov(kernelP, zi, xj); }
+    }
+  }
+
+  //-- means and variances with matrix products instead of one inner product per query
+  Y = Ks*GinvY;
+  arr V = cholesky_solvePacked(cholG, ~Ks); //L^-1 Ks^T, all queries at once: the variance reduction of query i is |V(:,i)|^2
+  S.setZero();
+  for(j=0; j<N; j++) for(i=0; i<Z.d0; i++) { double v=V(j, i); S(i) += v*v; }
+  for(i=0; i<Z.d0; i++) {
+    zi.referToDim(Z, i);
+    Y(i) += mu_func(zi, priorP) + mu;
+    S(i) = ::sqrt(cov(kernelP, zi, zi) - S(i));
+  }
 }
@@ -22,7 +22,7 @@ struct GaussianProcess {
   arr X, Y;   ///< data
   arr dX, dY; ///< derivative data
   uintA dI;  ///< derivative data (derivative indexes)
-  arr Ginv, GinvY, ig2;  ///< inverse gram matrix (and a second buffer for push/pop)
+  arr cholG, GinvY, ig2;  ///< Cholesky factor of the gram matrix (packed, see cholesky_appendPacked), G^-1 Y, and a second buffer for push/pop
 
   //--prior function
   double mu; ///< const bias of the GP
@@ -58,18 +58,18 @@ struct GaussianProcess {
 
   GaussianProcess(const GaussianProcess& f) {
     X=f.X; Y=f.Y; dX=f.dX; dY=f.dY; dI=f.dI;
-    Ginv=f.Ginv; GinvY=f.GinvY; ig2=f.ig2;
+    cholG=f.cholG; GinvY=f.GinvY; ig2=f.ig2;
     mu=f.mu; mu_func=f.mu_func; priorP=f.priorP;
     cov=f.cov; dcov=f.dcov; covF_D=f.covF_D;
     covD_D=f.covD_D; covDD_F=f.covDD_F; covDD_D=f.covDD_D;
     kernelP=f.kernelP; obsVar=f.obsVar;
   }
 
-  void clear() { X.clear(); Y.clear(); dX.clear(); dY.clear(); dI.clear(); Ginv.clear(); GinvY.clear(); ig2.clear(); }
+  void clear() { X.clear(); Y.clear(); dX.clear(); dY.clear(); dI.clear(); cholG.clear(); GinvY.clear(); ig2.clear(); }
 
   void copyFrom(GaussianProcess& f) {
     X=f.X; Y=f.Y; dX=f.dX; dY=f.dY; dI=f.dI;
-    Ginv=f.Ginv; GinvY=f.GinvY; ig2=f.ig2;
+    cholG=f.cholG; GinvY=f.GinvY; ig2=f.ig2;
     mu=f.mu; mu_func=f.mu_func; priorP=f.priorP;
     cov=f.cov; dcov=f.dcov; covF_D=f.covF_D;
     covD_D=f.covD_D; covDD_F=f.covDD_F; covDD_D=f.covDD_D;
@@ -117,7 +117,7 @@ struct GaussianProcess {
 
   void recompute(const arr& X, const arr& Y);             ///< calculates the inv Gram matrix for the given data
   void recompute();                                      ///< recalculates the inv Gram matrix for the current data
-  void appendObservation(const arr& x, double y);     ///< add a new datum to the data and updates the inv Gram matrix
+  void appendObservation(const arr& x, double y);     ///< add a new datum to the data and grows the Cholesky factor (in O(N^2), without derivative data)
   void appendDerivativeObservation(const arr& x, double dy, uint i);
   void appendGradientObservation(const arr& x, const arr& dydx);
 
@@ -131,8 +131,8 @@ struct GaussianProcess {
   void k_star(const arr& x, arr& k);
   void dk_star(const arr& x, arr& k);
 
-  void push(const arr& x, double y) { ig2=Ginv; appendObservation(x, y); recompute(); }
-  void pop() { Ginv=ig2; X.resizeCopy(X.d0-1, X.d1); Y.resizeCopy(Y.N-1); }
+  void push(const arr& x, double y) { ig2=cholG; appendObservation(x, y); }
+  void pop() { cholG=ig2; X.resizeCopy(X.d0-1, X.d1); Y.resizeCopy(Y.N-1); }
 };
 
 #define KRONEKER(a, b)   ( ((a)==(b)) ? 1 : 0 )
@@ -250,6 +250,7 @@ inline void randomFunction(GaussianProcess& gp, arr& Xbase, bool illustrate, boo
   uint i;
   //gp.setKernel(&stdKernel, GaussKernel);
   if(!fromPosterior) gp.clear();
+  gp.recompute(); //for the changed obsVar; appendObservation then keeps the inverse Gram matrix up to date
 
 //  Xbase.randomPermute();
   //gp.X.resize(0, 1); gp.Y.resize(0); //clear current data
@@ -262,7 +263,6 @@ inline void randomFunction(GaussianProcess& gp, arr& Xbase, bool illustrate, boo
     gp.evaluate(x, y, sig);      //sample it from the GP itself
     y+=sig*rnd.gauss();        //with standard deviation..
     gp.appendObservation(x, y);
-    gp.recompute();
   }
 
   gp.obsVar=orgObsVar;
@@ -10,6 +10,7 @@
 #include "../Core/util.h"
 
 #include <math.h>
+#include <algorithm>
 
 //==============================================================================
 //
@@ -325,21 +326,19 @@ void CubicPiece::set(const arr& x0, const arr& v0, const arr& x1, const arr& v1,
 }
 
 void CubicPiece::eval(arr& x, arr& xDot, arr& xDDot, double t) const {
-  double t2=t*t, t3=t*t2;
+  //(elementwise, so that presized x, xDot, xDDot are not reallocated)
+  uint n=d.N;
   if(!!x){
-    x = d;
-    x += t*c;
-    x += t2*b;
-    x += t3*a;
+    x.resize(n);
+    for(uint i=0; i<n; i++) x.p[i] = d.p[i] + t*(c.p[i] + t*(b.p[i] + t*a.p[i]));
   }
   if(!!xDot){
-    xDot = c;
-    xDot += (2.*t)*b;
-    xDot += (3.*t2)*a;
+    xDot.resize(n);
+    for(uint i=0; i<n; i++) xDot.p[i] = c.p[i] + t*(2.*b.p[i] + (3.*t)*a.p[i]);
   }
   if(!!xDDot){
-    xDDot = 2.*b;
-    xDDot += (6.*t)*a;
+    xDDot.resize(n);
+    for(uint i=0; i<n; i++) xDDot.p[i] = 2.*b.p[i] + (6.*t)*a.p[i];
   }
 }
 
@@ -437,6 +436,97 @@ arr CubicSpline::eval(const arr& T, uint diff) const{
   return x;
 }
 
+//==============================================================================
+
+void PiecewisePolynomial::set(const Spline& S) {
+  CHECK(S.knotPoints.N, "spline is empty");
+  uint D=S.degree+1, n=S.knotPoints.d1;
+
+  //-- pieces are the non-empty knot intervals
+  times.clear();
+  for(uint i=0; i+1<S.knotTimes.N; i++) if(S.knotTimes(i+1)>S.knotTimes(i)) {
+      if(!times.N) times.append(S.knotTimes(i));
+      times.append(S.knotTimes(i+1));
+    }
+  if(!times.N) { //zero duration: a single constant piece
+    times = {S.knotTimes(0), S.knotTimes(0)};
+    coeffs.resize(1, D, n).setZero();
+    coeffs[0][0] = S.knotPoints[0];
+    return;
+  }
+
+  //-- interpolate each piece at D interior samples (in normalized time u=s/tau), via Newton's divided differences
+  uint K=times.N-1;
+  coeffs.resize(K, D, n);
+  arr u(D), F(D, n), C(D, n);
+  for(uint j=0; j<D; j++) u(j) = (j+.5)/D;
+  for(uint k=0; k<K; k++) {
+    double tau = times(k+1)-times(k);
+    for(uint j=0; j<D; j++) F[j] = S.eval(times(k) + tau*u(j));
+    for(uint l=1; l<D; l++) for(uint j=D-1; j>=l; j--) F[j] = (F[j]-F[j-1]) / (u(j)-u(j-l));
+    //expand the Newton form into monomials
+    C.setZero();
+    C[0] = F[D-1];
+    for(uint j=D-1; j--;) {
+      for(uint m=D-1; m>0; m--) C[m] = C[m-1] - u(j)*C[m];
+      C[0] = F[j] - u(j)*C[0];
+    }
+    for(uint m=0; m<D; m++) coeffs[k][m] = C[m] / pow(tau, m);
+  }
+}
+
+void PiecewisePolynomial::set(const CubicSpline& S) {
+  CHECK(S.pieces.N, "spline is empty");
+  uint n=S.pieces(0).d.N;
+  times = S.times;
+  coeffs.resize(S.pieces.N, 4, n);
+  for(uint k=0; k<S.pieces.N; k++) {
+    const CubicPiece& P = S.pieces(k);
+    coeffs[k][0] = P.d;
+    coeffs[k][1] = P.c;
+    coeffs[k][2] = P.b;
+    coeffs[k][3] = P.a;
+  }
+}
+
+uint PiecewisePolynomial::getPiece(double t) const {
+  uint K=coeffs.d0;
+  uint k = std::upper_bound(times.p, times.p+times.N, t) - times.p;
+  if(k) k--;
+  if(k>=K) k=K-1;
+  return k;
+}
+
+void PiecewisePolynomial::eval(arr& x, arr& xDot, arr& xDDot, double t) const {
+  CHECK(coeffs.N, "polynomial is empty");
+  uint D=coeffs.d1, n=coeffs.d2;
+  uint k;
+  double s;
+  bool hold=false;
+  if(t<times.first()) { k=0; s=0.; hold=true; }
+  else if(t>=times.last()) { k=coeffs.d0-1; s=times(k+1)-times(k); hold=true; }
+  else { k=getPiece(t); s=t-times(k); }
+
+  if(!!x) x.resize(n);
+  if(!!xDot) xDot.resize(n);
+  if(!!xDDot) xDDot.resize(n);
+  const double* c = coeffs.p + k*D*n;
+  for(uint i=0; i<n; i++) {
+    //Horner's scheme, including first and second derivative
+    double y=0., yDot=0., yDDot=0.;
+    for(uint j=D; j--;) {
+      yDDot = yDDot*s + 2.*yDot;
+      yDot = yDot*s + y;
+      y = y*s + c[j*n+i];
+    }
+    if(!!x) x.p[i] = y;
+    if(!!xDot) xDot.p[i] = hold?0.:yDot;
+    if(!!xDDot) xDDot.p[i] = hold?0.:yDDot;
+  }
+}
+
+//==============================================================================
+
 arr CubicSplineLeapCost(const arr& x0, const arr& v0, const arr& x1, const arr& v1, double tau, const arr& tauJ) {
   arr D = (x1-x0) - (.5*tau)*(v0+v1);
   if(tauJ.N){
@@ -81,6 +81,28 @@ struct CubicSpline{
 
 //==============================================================================
 
+/// the piecewise polynomial form of a Spline or CubicSpline, for allocation-free evaluation (e.g. in real-time threads):
+/// set() caches the coefficients of every piece, eval() only binary-searches the piece and runs Horner's scheme
+struct PiecewisePolynomial {
+  arr times;  ///< start times of the pieces, and the end time of the last
+  arr coeffs; ///< (#pieces, degree+1, dim): x(t) = sum_j coeffs(k,j,:) (t-times(k))^j on piece k
+
+  void set(const Spline& S);
+  void set(const CubicSpline& S);
+  void clear() { times.clear(); coeffs.clear(); }
+
+  uint getPiece(double t) const;
+  /// does not allocate if x, xDot, xDDot already have size dim() (or are NoArr); before begin() and after end() the
+  /// boundary position is held with zero velocity and acceleration
+  void eval(arr& x, arr& xDot, arr& xDDot, double t) const;
+
+  uint dim() const { return coeffs.d2; }
+  double begin() const { return times.first(); }
+  double end() const { return times.last(); }
+};
+
+//==============================================================================
+
 arr CubicSplineLeapCost(const arr& x0, const arr& v0, const arr& x1, const arr& v1, double tau, const arr& tauJ={});
 arr CubicSplineMaxJer(const arr& x0, const arr& v0, const arr& x1, const arr& v1, double tau, const arr& tauJ={});
 arr CubicSplineMaxAcc(const arr& x0, const arr& v0, const arr& x1, const arr& v1, double tau, const arr& tauJ={});
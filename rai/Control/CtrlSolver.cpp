@@ -62,14 +62,14 @@ void CtrlSolver::update(const arr& q_real, const arr& qDot_real, rai::Configurat
   //-- pushback frame states of roots (e.g. moving objects)
   uintA roots = framesToIndices(C.getRoots());
   for(int t=-komo.k_order; t<0; t++){
-    arr Xt = komo.pathConfig.getFrameState(roots+komo.timeSlices(komo.k_order+t+1,0)->ID);
-    komo.pathConfig.setFrameState(Xt, roots+komo.timeSlices(komo.k_order+t,0)->ID);
+    arr Xt = komo.pathConfig.getFrameState(komo.timeSlices[komo.k_order+t+1].sub(roots));
+    komo.pathConfig.setFrameState(Xt, komo.timeSlices[komo.k_order+t].sub(roots));
   }
   //-- if C given, adopt frame states of roots (e.g. moving objects)
   if(!!C){
     arr X = C.getFrameState(roots);
-    komo.pathConfig.setFrameState(X, roots+komo.timeSlices(komo.k_order-1,0)->ID);
-    komo.pathConfig.setFrameState(X, roots+komo.timeSlices(komo.k_order,0)->ID);
+    komo.pathConfig.setFrameState(X, komo.timeSlices[komo.k_order-1].sub(roots));
+    komo.pathConfig.setFrameState(X, komo.timeSlices[komo.k_order].sub(roots));
   }
   //-- use the q_real and qDot_real to define the prefix
   //the joint state:
@@ -38,7 +38,18 @@ SecMPC::SecMPC(KOMO& komo, int subSeqStart, int subSeqStop, double timeCost, dou
 
 //===========================================================================
 
+SecMPC::~SecMPC(){
+  stopThreads();
+}
+
+//===========================================================================
+
 void SecMPC::updateWaypoints(const rai::Configuration& C){
+  CHECK(!isThreaded(), "the waypoint layer is stepped by its thread");
+  updateWaypoints(C, msg);
+}
+
+void SecMPC::updateWaypoints(const rai::Configuration& C, rai::String& msg){
   waypointMPC.reinit(C); //adopt all frames in C as prefix (also positions of objects)
   waypointMPC.solve(opt.verbose-2);
 
@@ -52,8 +63,13 @@ void SecMPC::updateWaypoints(const rai::Configuration& C){
 //===========================================================================
 
 void SecMPC::updateTiming(const rai::Configuration& C, const ObjectiveL& phi, const arr& q_real){
+  CHECK(!isThreaded(), "the timing layer is stepped by its thread");
+  updateTiming(C, phi, q_real, waypointMPC.path({subSeqStart, subSeqStop}), msg);
+}
+
+void SecMPC::updateTiming(const rai::Configuration& C, const ObjectiveL& phi, const arr& q_real, const arr& path, rai::String& msg){
   //-- adopt the new path
-  timingMPC.set_updatedWaypoints(waypointMPC.path({subSeqStart, subSeqStop}), setNextWaypointTangent);
+  timingMPC.set_updatedWaypoints(path, setNextWaypointTangent);
 
   //-- progress time (potentially phase)
   if(!timingMPC.done() && ctrlTimeDelta>0.){
@@ -118,15 +134,23 @@ void SecMPC::updateTiming(const rai::Configuration& C, const ObjectiveL& phi, co
 //===========================================================================
 
 void SecMPC::updateShortPath(const rai::Configuration& C){
+  CHECK(!isThreaded(), "the short path layer is stepped by its thread");
+  SecMPC_Spline sp;
+  getSpline(sp);
+  sp.feasible = waypointMPC.feasible;
+  updateShortPath(C, sp, msg);
+}
+
+void SecMPC::updateShortPath(const rai::Configuration& C, const SecMPC_Spline& spline, rai::String& msg){
   shortMPC.reinit(C); //adopt all frames in C as prefix (also positions of objects)
-  shortMPC.reinit(q_refAdapted, qDot_ref_atLastUpdate);
+  shortMPC.reinit(spline.q_refAdapted, spline.qDot_ref);
   rai::CubicSpline S;
 #if 0
   timingMPC.getCubicSpline(S, q_ref, qDot_ref);
   if(!S.pieces.N) return;
 #else
 //  timingMPC.getCubicSpline(S, q_ref_atLastUpdate, qDot_ref_atLastUpdate);
-  auto sp = getSpline(ctrlTime_atLastUpdate, true);
+  auto sp = spline.get(spline.ctrlTime, true);
   if(!sp.pts.N){ shortMPC.feasible=false; return; }
   S.set(sp.pts, sp.vels, sp.times);
 #endif
@@ -135,7 +159,7 @@ void SecMPC::updateShortPath(const rai::Configuration& C){
   CHECK_EQ(times.N, shortMPC.komo.T, "");
   CHECK_EQ(pts.d0, shortMPC.komo.T, "");
   for(int t=0;t<(int)pts.d0;t++){
-    shortMPC.komo.setConfiguration_qOrg(t, q_refAdapted); //pts[t]);
+    shortMPC.komo.setConfiguration_qOrg(t, spline.q_refAdapted); //pts[t]);
     std::shared_ptr<GroundedObjective> ob = shortMPC.komo.objs.elem(t - (int)pts.d0);
     ob->feat->setTarget(pts[t]);
 //    cout <<off <<' ' <<t <<' ' <<ob->feat->shortTag(C) <<ob->feat->scale <<ob->feat->target <<ob->timeSlices <<endl;
@@ -163,19 +187,34 @@ void SecMPC::updateShortPath(const rai::Configuration& C){
 
   msg <<" \tPATH #" <<shortMPC.komo.pathConfig.setJointStateCount;
   msg <<' ' <<shortMPC.komo.sos <<'|' <<shortMPC.komo.ineq + shortMPC.komo.eq;
-  if(!shortMPC.feasible) msg <<'!' <<wayInfeasible;
+  if(!shortMPC.feasible) msg <<'!';
 }
 
 //===========================================================================
 
-void SecMPC::cycle(const rai::Configuration& C, const arr& q_ref, const arr& qDot_ref, const arr& q_real, const arr& qDot_real, double ctrlTime){
-  //-- store ctrl state at start of this cycle
+void SecMPC::setCtrlState(const arr& q_ref, const arr& qDot_ref, double ctrlTime){
   if(ctrlTime_atLastUpdate>0.){
     ctrlTimeDelta = ctrlTime - ctrlTime_atLastUpdate;
   }
   ctrlTime_atLastUpdate = ctrlTime;
   q_ref_atLastUpdate = q_ref;
   qDot_ref_atLastUpdate = qDot_ref;
+}
+
+void SecMPC::cycle(const rai::Configuration& C, const arr& q_ref, const arr& qDot_ref, const arr& q_real, const arr& qDot_real, double ctrlTime){
+  if(isThreaded()){ //only hand the control state to the layer threads
+    SecMPC_CtrlState& x = state.back();
+    x.X = C.getFrameState();
+    x.q_ref = q_ref;  x.qDot_ref = qDot_ref;
+    x.q_real = q_real;  x.qDot_real = qDot_real;
+    x.ctrlTime = ctrlTime;
+    x.wallTime = rai::realTime();
+    state.publish(ctrlTime);
+    return;
+  }
+
+  //-- store ctrl state at start of this cycle
+  setCtrlState(q_ref, qDot_ref, ctrlTime);
 
   msg.clear();
   msg <<std::setprecision(3);
@@ -186,33 +225,62 @@ void SecMPC::cycle(const rai::Configuration& C, const arr& q_ref, const arr& qDo
   updateShortPath(C);
 }
 
-rai::CubicSplineCtor SecMPC::getSpline(double realtime, bool prependRef){
-  if(!waypointMPC.feasible) return {};
+void SecMPC::getSpline(SecMPC_Spline& sp){
+  sp.pts = timingMPC.getWaypoints();
+  sp.vels = timingMPC.getVels();
+  sp.times = timingMPC.getTimes();
+  CHECK_EQ(sp.vels.d0, sp.times.N, "");
+  sp.q_ref = q_ref_atLastUpdate;
+  sp.qDot_ref = qDot_ref_atLastUpdate;
+  sp.q_refAdapted = q_refAdapted;
+  sp.ctrlTime = ctrlTime_atLastUpdate;
+}
+
+rai::CubicSplineCtor SecMPC_Spline::get(double realtime, bool prependRef) const{
+  if(!feasible) return {};
 //  if(timingMPC.done() || !waypointMPC.feasible) return {};
-  arr pts = timingMPC.getWaypoints();
-  arr vels = timingMPC.getVels();
-  arr times = timingMPC.getTimes();
-  CHECK_EQ(vels.d0, times.N, "");
-  times -= realtime - ctrlTime_atLastUpdate; //ctrlTimeLast=when the timing was optimized; realtime=time now; -> shift spline to stich it at realtime
+  arr pts = this->pts;
+  arr vels = this->vels;
+  arr times = this->times;
+  times -= realtime - ctrlTime; //ctrlTime=when the timing was optimized; realtime=time now; -> shift spline to stich it at realtime
 //  if(times.first()<tauCutoff) return {};
   if(q_refAdapted.N){ //this will overrideHard the spline, as first time is negative;
     pts.prepend(q_refAdapted);
-    vels.prepend(qDot_ref_atLastUpdate);
-    times.prepend(0. - (realtime - ctrlTime_atLastUpdate));
+    vels.prepend(qDot_ref);
+    times.prepend(0. - (realtime - ctrlTime));
   }else if(prependRef){
-    pts.prepend(q_ref_atLastUpdate);
-    vels.prepend(qDot_ref_atLastUpdate);
-    times.prepend(0. - (realtime - ctrlTime_atLastUpdate));
+    pts.prepend(q_ref);
+    vels.prepend(qDot_ref);
+    times.prepend(0. - (realtime - ctrlTime));
   }
   return {pts, vels, times};
 }
 
+rai::CubicSplineCtor SecMPC::getSpline(double realtime, bool prependRef){
+  SecMPC_Spline sp;
+  if(isThreaded()){
+    if(!spline.read(sp)) return {};
+    ctrlStats.add(rai::realTime()-sp.wallTime, realtime-sp.ctrlTime);
+  }else{
+    getSpline(sp);
+    sp.feasible = waypointMPC.feasible;
+  }
+  return sp.get(realtime, prependRef);
+}
+
 rai::CubicSplineCtor SecMPC::getShortPath_debug(double realtime){
-  if(timingMPC.done() || !waypointMPC.feasible) return {};
+  SecMPC_Spline spl;
+  if(isThreaded()){ //(the timing layer's state belongs to its thread)
+    if(!spline.read(spl)) return {};
+  }else{
+    if(timingMPC.done()) return {};
+    getSpline(spl);
+    spl.feasible = waypointMPC.feasible;
+  }
 
   rai::CubicSpline S;
 //  timingMPC.getCubicSpline(S, q_ref_atLastUpdate, qDot_ref_atLastUpdate);
-  auto sp = getSpline(ctrlTime_atLastUpdate, true);
+  auto sp = spl.get(spl.ctrlTime, true);
   if(!sp.pts.N) return {};
   S.set(sp.pts, sp.vels, sp.times);
 
@@ -225,7 +293,7 @@ rai::CubicSplineCtor SecMPC::getShortPath_debug(double realtime){
   arr times = sp.times, pts=sp.pts, vels=sp.vels;
 #endif
 
-  times -= realtime - ctrlTime_atLastUpdate; //ctrlTimeLast=when the timing was optimized; realtime=time now; -> shift spline to stich it at realtime
+  times -= realtime - spl.ctrlTime; //ctrlTimeLast=when the timing was optimized; realtime=time now; -> shift spline to stich it at realtime
 //  while(times.N && times.first()<tauCutoff){
 //    times.remove(0);
 //    pts.delRows(0);
@@ -234,14 +302,14 @@ rai::CubicSplineCtor SecMPC::getShortPath_debug(double realtime){
   return {pts, vels, times};
 }
 
-rai::CubicSplineCtor SecMPC::getShortPath(double realtime){
-  if(/*timingMPC.done() || */!waypointMPC.feasible || !shortMPC.feasible){ return {}; }
-  arr times = shortMPC.times; //komo.getPath_times();
-  arr pts = shortMPC.path;
-  arr vels = shortMPC.vels;
+rai::CubicSplineCtor SecMPC_ShortPath::get(double realtime) const{
+  if(/*timingMPC.done() || */!feasible){ return {}; }
+  arr times = this->times; //komo.getPath_times();
+  arr pts = path;
+  arr vels = this->vels;
   if(!pts.N) return {};
 
-  times -= realtime - ctrlTime_atLastUpdate; //ctrlTimeLast=when the timing was optimized; realtime=time now; -> shift spline to stich it at realtime
+  times -= realtime - ctrlTime; //ctrlTime=when the timing was optimized; realtime=time now; -> shift spline to stich it at realtime
 //  while(times.N && times.first()<tauCutoff){
 //    times.remove(0);
 //    pts.delRows(0);
@@ -250,6 +318,20 @@ rai::CubicSplineCtor SecMPC::getShortPath(double realtime){
   return {pts, vels, times};
 }
 
+rai::CubicSplineCtor SecMPC::getShortPath(double realtime){
+  SecMPC_ShortPath P;
+  if(isThreaded()){
+    if(!shortPath.read(P)) return {};
+  }else{
+    P.feasible = waypointMPC.feasible && shortMPC.feasible;
+    if(!P.feasible) return {};
+    P.times = shortMPC.times;
+    P.path = shortMPC.path;
+    P.vels = shortMPC.vels;
+    P.ctrlTime = ctrlTime_atLastUpdate;
+  }
+  return P.get(realtime);
+}
 
 void SecMPC::report(const rai::Configuration& C) {
 #if 0
@@ -259,5 +341,129 @@ void SecMPC::report(const rai::Configuration& C) {
     <<' ' <<phi.maxError(C, 1.5+timingMPC.phase)
    <<' ' <<phi.maxError(C, 2.+timingMPC.phase);
 #endif
+  if(isThreaded()){
+    SecMPC_Waypoints W;
+    SecMPC_Spline S;
+    SecMPC_ShortPath P;
+    waypoints.read(W);  spline.read(S);  shortPath.read(P);
+    msg.clear() <<S.msg <<W.msg <<P.msg;
+  }
   cout <<msg <<endl;
+  if(isThreaded() && opt.verbose>1) reportLatency(cout);
+}
+
+//===========================================================================
+
+void SecMPC::startThreads(const rai::Configuration& C){
+  CHECK(!isThreaded(), "threads are already running");
+  wayC.copy(C);
+  timingC.copy(C);
+  shortC.copy(C);
+  timingObjectives.clear();
+  for(const shared_ptr<Objective>& o:waypointMPC.komo.objectives){ //(only those read by maxError; features may cache during evaluation)
+    if((o->type==OT_eq || o->type==OT_ineq) && !o->feat->order) timingObjectives.append(make_shared<Objective>(o->feat->deepCopy(), o->type, o->name, o->times));
+  }
+  wayThread = run([this](){ stepWaypoints(); return AS_running; }, opt.wayInterval);
+  timingThread = run([this](){ stepTiming(); return AS_running; }, opt.timingInterval);
+  shortThread = run([this](){ stepShortPath(); return AS_running; }, opt.shortInterval);
+}
+
+void SecMPC::stopThreads(){
+  wayThread.reset();
+  timingThread.reset();
+  shortThread.reset();
+}
+
+void SecMPC::stepWaypoints(){
+  if(!state.read(wayState)) return; //no control state yet
+  wayC.setFrameState(wayState.X);
+
+  SecMPC_Waypoints& W = waypoints.back();
+  W.msg.clear() <<std::setprecision(3);
+  updateWaypoints(wayC, W.msg);
+  W.path = waypointMPC.path({subSeqStart, subSeqStop});
+  W.feasible = waypointMPC.feasible;
+  W.ctrlTime = wayState.ctrlTime;
+  W.wallTime = wayState.wallTime;
+  waypoints.publish(W.ctrlTime);
+
+  wayStats.add(rai::realTime()-W.wallTime, state.ctrlTime()-W.ctrlTime);
+}
+
+void SecMPC::stepTiming(){
+  if(!waypoints.revision()) return; //no waypoints yet
+  waypoints.readIfNew(timingWaypoints, timingWaypointsRevision);
+  state.read(timingState);
+  timingC.setFrameState(timingState.X);
+
+  //-- same as cycle(), but for the latest control state
+  setCtrlState(timingState.q_ref, timingState.qDot_ref, timingState.ctrlTime);
+  SecMPC_Spline& S = spline.back();
+  S.msg.clear() <<std::setprecision(3) <<"SecMPC d:" <<ctrlTimeDelta;
+  updateTiming(timingC, timingObjectives, timingState.q_real, timingWaypoints.path, S.msg);
+  getSpline(S);
+  S.feasible = timingWaypoints.feasible;
+  S.wallTime = timingState.wallTime;
+  spline.publish(S.ctrlTime);
+
+  timingStats.add(rai::realTime()-S.wallTime, state.ctrlTime()-S.ctrlTime);
+}
+
+void SecMPC::stepShortPath(){
+  if(!spline.read(shortSpline)) return; //no timing yet
+  state.read(shortState);
+  shortC.setFrameState(shortState.X);
+
+  SecMPC_ShortPath& P = shortPath.back();
+  P.msg.clear() <<std::setprecision(3);
+  updateShortPath(shortC, shortSpline, P.msg);
+  P.feasible = shortSpline.feasible && shortMPC.feasible;
+  P.times = shortMPC.times;
+  P.path = shortMPC.path;
+  P.vels = shortMPC.vels;
+  P.ctrlTime = shortSpline.ctrlTime;
+  P.wallTime = shortSpline.wallTime;
+  shortPath.publish(P.ctrlTime);
+
+  shortStats.add(rai::realTime()-P.wallTime, state.ctrlTime()-P.ctrlTime);
+}
+
+void SecMPC::reportLatency(std::ostream& os){
+  os <<"SecMPC layer latencies [s] (wall: ctrl state published -> result published; lag: ctrlTime at completion - ctrlTime of result)" <<endl;
+  wayStats.write(os, "way", opt.wayInterval);
+  timingStats.write(os, "timing", opt.timingInterval);
+  shortStats.write(os, "short", opt.shortInterval);
+  ctrlStats.write(os, "ctrl", -1.);
+}
+
+//===========================================================================
+
+void SecMPC_LayerStats::add(double _latency, double _lag){
+  auto lock = mutex(RAI_HERE);
+  n++;
+  latency += _latency;  if(_latency>latencyMax) latencyMax=_latency;
+  lag += _lag;  if(_lag>lagMax) lagMax=_lag;
+  double now = rai::realTime();
+  if(lastDone>=0.){
+    double d = now-lastDone;
+    nPeriods++;
+    period += d;
+    periodSqr += d*d;
+  }
+  lastDone = now;
+}
+
+void SecMPC_LayerStats::write(std::ostream& os, const char* name, double targetPeriod){
+  auto lock = mutex(RAI_HERE);
+  os <<"  " <<std::setw(6) <<name <<": #" <<n;
+  if(!n){ os <<endl; return; }
+  os <<" latency: " <<latency/n <<" (max " <<latencyMax <<")"
+     <<" lag: " <<lag/n <<" (max " <<lagMax <<")";
+  if(nPeriods){
+    double m = period/nPeriods;
+    os <<" period: " <<m;
+    if(targetPeriod>0.) os <<" (target " <<targetPeriod <<")";
+    os <<" jitter: " <<sqrt(std::max(0., periodSqr/nPeriods - m*m));
+  }
+  os <<endl;
 }
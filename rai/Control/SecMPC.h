@@ -4,6 +4,8 @@
 #include "ShortPathMPC.h"
 #include "TimingMPC.h"
 
+#include <Core/thread.h>
+
 //===========================================================================
 
 namespace rai {
@@ -11,11 +13,74 @@ namespace rai {
     RAI_PARAM("SecMPC/", int, verbose, 1)
     RAI_PARAM("SecMPC/", double, precision, .1)
     RAI_PARAM("SecMPC/", double, tauCutoff, .0)
+    RAI_PARAM("SecMPC/", double, wayInterval, .2) //beat intervals of the layer threads (see SecMPC::startThreads)
+    RAI_PARAM("SecMPC/", double, timingInterval, .05)
+    RAI_PARAM("SecMPC/", double, shortInterval, .1)
   };
 }//namespace
 
 //===========================================================================
 
+/// versioned double buffer handing results from one producing thread to any consumers: the producer fills back()
+/// without holding a lock and publish() only flips the front slot; readers copy the front slot under a short read lock
+template<class T> struct SecMPC_Handoff {
+  T slots[2];
+  Var<uint> front; ///< index of the front slot; its revision counts publications, its data_time is the ctrlTime of the published result
+
+  T& back(){ return slots[1-front.data->data]; } //(only the producer flips front, so it reads it unlocked)
+  void publish(double ctrlTime){ front.set(ctrlTime)() = 1-front.data->data; }
+  uint read(T& x){ RToken<uint> f(*front.data, &front.data->data); x = slots[f()]; return front.data->revision; } ///< returns the revision copied (0: nothing published yet)
+  bool readIfNew(T& x, uint& lastRevision){ if(revision()==lastRevision) return false; lastRevision=read(x); return true; }
+  uint revision(){ return front.data->getRevision(); }
+  double ctrlTime(){ RToken<uint> f(*front.data, &front.data->data); return front.data->data_time; }
+};
+
+/// the control state handed to the layer threads
+struct SecMPC_CtrlState {
+  arr X, q_ref, qDot_ref, q_real, qDot_real;
+  double ctrlTime=-1.;
+  double wallTime=0.; ///< rai::realTime() when it was published
+};
+
+/// layer results; ctrlTime and wallTime are those of the control state they were computed from
+struct SecMPC_Waypoints {
+  arr path;
+  bool feasible=false;
+  double ctrlTime=-1., wallTime=0.;
+  rai::String msg;
+};
+
+struct SecMPC_Spline {
+  arr pts, vels, times; ///< times relative to ctrlTime
+  arr q_ref, qDot_ref, q_refAdapted;
+  bool feasible=false;
+  double ctrlTime=-1., wallTime=0.;
+  rai::String msg;
+  rai::CubicSplineCtor get(double realtime, bool prependRef) const;
+};
+
+struct SecMPC_ShortPath {
+  arr times, path, vels;
+  bool feasible=false;
+  double ctrlTime=-1., wallTime=0.;
+  rai::String msg;
+  rai::CubicSplineCtor get(double realtime) const;
+};
+
+/// completion statistics of a threaded SecMPC layer
+struct SecMPC_LayerStats {
+  Mutex mutex;
+  uint n=0, nPeriods=0;
+  double latency=0., latencyMax=0.; ///< wall time from publishing a control state to publishing the result computed from it
+  double lag=0., lagMax=0.;         ///< latest ctrlTime at completion minus the ctrlTime the result was computed from
+  double lastDone=-1., period=0., periodSqr=0.; ///< intervals between completions (their std deviation is the jitter)
+
+  void add(double _latency, double _lag);
+  void write(std::ostream& os, const char* name, double targetPeriod);
+};
+
+//===========================================================================
+
 struct SecMPC{
   WaypointMPC waypointMPC;
   TimingMPC timingMPC;
@@ -25,6 +90,7 @@ struct SecMPC{
   bool setNextWaypointTangent;
   rai::String msg;
 
+  //-- state of the timing layer (in threaded mode only touched by the timing thread)
   double ctrlTimeDelta = 0.;
   double ctrlTime_atLastUpdate = -1.;
   arr q_ref_atLastUpdate, qDot_ref_atLastUpdate, q_refAdapted;
@@ -34,7 +100,17 @@ struct SecMPC{
 
   rai::SecMPC_Options opt;
 
+  //-- threaded mode: each layer is stepped by its own thread at its own rate; cycle() only publishes the control state,
+  //   getSpline()/getShortPath() return the latest published results
+  SecMPC_Handoff<SecMPC_CtrlState> state;
+  SecMPC_Handoff<SecMPC_Waypoints> waypoints;
+  SecMPC_Handoff<SecMPC_Spline> spline;
+  SecMPC_Handoff<SecMPC_ShortPath> shortPath;
+  SecMPC_LayerStats wayStats, timingStats, shortStats, ctrlStats;
+  shared_ptr<ScriptThread> wayThread, timingThread, shortThread;
+
   SecMPC(KOMO& komo, int subSeqStart=0, int subSeqStop=-1, double timeCost=1e0, double ctrlCost=1e0, bool _setNextWaypointTangent=true, const StringA& explicitCollisions={});
+  ~SecMPC();
 
   void updateWaypoints(const rai::Configuration& C);
   void updateTiming(const rai::Configuration& C, const ObjectiveL& phi, const arr& q_real);
@@ -44,6 +120,30 @@ struct SecMPC{
   rai::CubicSplineCtor getShortPath(double realtime);
   rai::CubicSplineCtor getShortPath_debug(double realtime);
   void report(const rai::Configuration& C);
+
+  /// starts the layer threads (C is copied per thread; the KOMO given to the constructor must not be touched until stopThreads);
+  /// while they run, the layers are only stepped by their threads -- use cycle(), getSpline() and getShortPath()
+  void startThreads(const rai::Configuration& C);
+  void stopThreads();
+  bool isThreaded() const{ return wayThread!=nullptr; }
+  void reportLatency(std::ostream& os);
+
+private:
+  rai::Configuration wayC, timingC, shortC;
+  SecMPC_CtrlState wayState, timingState, shortState;
+  SecMPC_Waypoints timingWaypoints;
+  ObjectiveL timingObjectives; ///< the timing thread's copies of the waypoint constraints (the waypoint thread evaluates the originals)
+  SecMPC_Spline shortSpline;
+  uint timingWaypointsRevision=0;
+
+  void setCtrlState(const arr& q_ref, const arr& qDot_ref, double ctrlTime);
+  void updateWaypoints(const rai::Configuration& C, rai::String& msg);
+  void updateTiming(const rai::Configuration& C, const ObjectiveL& phi, const arr& q_real, const arr& path, rai::String& msg);
+  void updateShortPath(const rai::Configuration& C, const SecMPC_Spline& sp, rai::String& msg);
+  void getSpline(SecMPC_Spline& sp);
+  void stepWaypoints();
+  void stepTiming();
+  void stepShortPath();
 };
 
 
@@ -18,6 +18,7 @@ void SplineRunner::set(const arr& x, const arr& t, const arr& x0, bool append) {
     double last = refTimes.last();
     refTimes.append(t+last);
     refSpline.set(2, refPoints, refTimes);
+    refPoly.set(refSpline);
   } else {
     refPoints = x;
     refTimes = t;
@@ -26,24 +27,24 @@ void SplineRunner::set(const arr& x, const arr& t, const arr& x0, bool append) {
       refPoints.prepend(x0);
     }
     refSpline.set(2, refPoints, refTimes);
+    refPoly.set(refSpline);
     phase=0.;
   }
 }
 
 arr SplineRunner::run(double dt, arr& qref_dot) {
-  if(refSpline.knotPoints.N) {
-    //read out the new reference
-    phase += dt;
-    double maxPhase = refSpline.knotTimes.last();
-    arr q_ref = refSpline.eval(phase);
-    if(!!qref_dot) qref_dot = refSpline.eval(phase, 1);
-    if(phase>maxPhase) { //clear spline buffer
-      q_ref = refPoints[-1];
-      stop();
-    }
-    return q_ref;
-  }
-  return {};
+  arr q_ref;
+  if(!run(q_ref, qref_dot, dt)) return {};
+  return q_ref;
+}
+
+bool SplineRunner::run(arr& q_ref, arr& qref_dot, double dt) {
+  if(!refPoly.coeffs.N) return false;
+  //read out the new reference
+  phase += dt;
+  refPoly.eval(q_ref, qref_dot, NoArr, phase); //(after the end, this holds the last point)
+  if(phase>refPoly.end()) stop(); //clear spline buffer
+  return true;
 }
 
 double SplineRunner::timeToGo() {
@@ -57,6 +58,7 @@ void SplineRunner::stop() {
   refPoints.clear();
   refTimes.clear();
   refSpline.clear();
+  refPoly.clear();
 }
 
 } //namespace
@@ -14,11 +14,13 @@ namespace rai {
 
 struct SplineRunner {
   rai::Spline refSpline; // reference spline constructed from ref
+  rai::PiecewisePolynomial refPoly; // the same in polynomial form, for allocation-free evaluation
   arr refPoints, refTimes; // the knot points and times of the spline
   double phase=0.; // current phase in the spline
 
   void set(const arr& x, const arr& t, const arr& x0, bool append);
   arr run(double dt, arr& qref_dot=NoArr);
+  bool run(arr& qref, arr& qref_dot, double dt); // allocation-free if qref, qref_dot are presized (or NoArr); false if there is no reference
   double timeToGo();
   void stop();
 };
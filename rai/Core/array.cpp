@@ -62,6 +62,7 @@ const bool lapackSupported=true;
 const bool lapackSupported=false;
 #endif
 int64_t globalMemoryTotal=0, globalMemoryBound=1ull<<32; //this is 1GB
+std::atomic<uint64_t> globalMemoryAllocs{0}; //counts (re)allocations (atomic: arrays are allocated from ThreadPool workers) -- e.g. to test that real-time code doesn't allocate
 bool globalMemoryStrict=false;
 const char* arrayElemsep=", ";
 const char* arrayLinesep=",\n ";
@@ -542,6 +543,132 @@ arr pseudoInverse(const arr& A, const arr& Winv, double eps) {
   return Ainv;
 }
 
+/** @brief modified Cholesky (Gill, Murray & Wright) of a dense symmetric A, in place: A+E = L D L^T, where the diagonal
+  shift E>=0 is chosen during the factorization so that D>=delta and L stays bounded (E=0 if A is sufficiently pos-def).
+  The strict lower triangle of A is overwritten by the unit lower L, d becomes diag(D). Returns max(E): with a single
+  factorization this detects indefiniteness and still yields a pos-def system (a descent direction in Newton methods). */
+double choleskyModified(arr& A, arr& d, double delta) {
+  CHECK(A.nd==2 && A.d0==A.d1 && !isSpecial(A), "requires a dense square matrix");
+  uint n=A.d0;
+  d.resize(n);
+  if(!n) return 0.;
+  double *a=A.p;
+
+  //-- bound beta^2 on the elements of L D^{1/2}
+  double gamma=0., xi=0.;
+  for(uint i=0; i<n; i++) {
+    gamma = rai::MAX(gamma, fabs(a[i*n+i]));
+    for(uint j=0; j<i; j++) xi = rai::MAX(xi, fabs(a[i*n+j]));
+  }
+  double beta2 = rai::MAX(gamma, (n>1 ? xi/::sqrt(double(n*n-1)) : 0.));
+  beta2 = rai::MAX(beta2, 1e-15);
+  delta *= rai::MAX(1., gamma+xi);
+
+  arr w(n);
+  double maxShift=0.;
+  for(uint j=0; j<n; j++) {
+    double *Lj=a+j*n;
+    for(uint k=0; k<j; k++) w.p[k] = Lj[k]*d.p[k];
+    //column j of C = A - L D L^T (rows are contiguous: dot products over the first j entries)
+    double cjj = Lj[j];
+    for(uint k=0; k<j; k++) cjj -= Lj[k]*w.p[k];
+    double theta=0.;
+    for(uint i=j+1; i<n; i++) {
+      double *Li=a+i*n;
+      double cij = Li[j];
+      for(uint k=0; k<j; k++) cij -= Li[k]*w.p[k];
+      Li[j] = cij;
+      theta = rai::MAX(theta, fabs(cij));
+    }
+    double dj = rai::MAX(fabs(cjj), rai::MAX(theta*theta/beta2, delta));
+    if(dj-cjj>maxShift) maxShift=dj-cjj;
+    d.p[j] = dj;
+    for(uint i=j+1; i<n; i++) a[i*n+j] /= dj;
+  }
+  return maxShift;
+}
+
+/// solves (L D L^T) x = b given the factors of choleskyModified
+arr choleskyModified_solve(const arr& L, const arr& d, const arr& b) {
+  uint n=L.d0;
+  CHECK(b.nd==1 && b.N==n && d.N==n, "");
+  arr x=b;
+  const double *l=L.p;
+  //L y = b
+  for(uint i=0; i<n; i++) {
+    const double *Li=l+i*n;
+    double s=x.p[i];
+    for(uint k=0; k<i; k++) s -= Li[k]*x.p[k];
+    x.p[i]=s;
+  }
+  //D z = y
+  for(uint i=0; i<n; i++) x.p[i] /= d.p[i];
+  //L^T x = z (row-wise: subtract each solved x_i from the entries above)
+  for(uint i=n; i--;) {
+    const double *Li=l+i*n;
+    double xi=x.p[i];
+    for(uint k=0; k<i; k++) x.p[k] -= Li[k]*xi;
+  }
+  return x;
+}
+
+/** @brief grows the Cholesky factor L L^T = A of a sym pos-def matrix by one row/column in O(n^2): k are the new
+  off-diagonal entries A(n,0..n-1), kk the new diagonal entry. L is lower triangular in packed row-wise storage (row i
+  starts at i(i+1)/2), so that appending a row is just appending memory. If the new pivot is numerically
+  non-positive, it is clipped to 1e-12 kk (i.e., a tiny jitter is added to kk). */
+void cholesky_appendPacked(arr& L, const arr& k, double kk) {
+  uint n=k.N;
+  CHECK_EQ(L.N, n*(n+1)/2, "packed factor doesn't match the new row");
+  arr l = cholesky_solvePacked(L, k);
+  double dd = kk - sumOfSqr(l);
+  if(dd<=1e-12*kk) dd=1e-12*kk;
+  l.append(::sqrt(dd));
+  L.append(l);
+}
+
+/// solves L x = b (or L^T x = b) for a packed lower-triangular L (see cholesky_appendPacked); for a matrix b (n x m)
+/// all m columns are solved at once
+arr cholesky_solvePacked(const arr& L, const arr& b, bool transposed) {
+  uint n=b.d0, m=(b.nd==2 ? b.d1 : 1);
+  CHECK_EQ(L.N, n*(n+1)/2, "");
+  arr x=b;
+  if(!n) return x;
+  double *X=x.p;
+  if(m==1) { //(vector: plain dot products)
+    if(!transposed) {
+      for(uint i=0; i<n; i++) {
+        const double *Li=L.p+i*(i+1)/2;
+        double s=X[i];
+        for(uint k=0; k<i; k++) s -= Li[k]*X[k];
+        X[i] = s/Li[i];
+      }
+    } else {
+      for(uint i=n; i--;) {
+        const double *Li=L.p+i*(i+1)/2;
+        double xi = (X[i] /= Li[i]);
+        for(uint k=0; k<i; k++) X[k] -= Li[k]*xi;
+      }
+    }
+    return x;
+  }
+  if(!transposed) {
+    for(uint i=0; i<n; i++) {
+      const double *Li=L.p+i*(i+1)/2;
+      double *xi=X+i*m;
+      for(uint k=0; k<i; k++) { double l=Li[k]; const double *xk=X+k*m; for(uint c=0; c<m; c++) xi[c] -= l*xk[c]; }
+      for(uint c=0; c<m; c++) xi[c] /= Li[i];
+    }
+  } else {
+    for(uint i=n; i--;) {
+      const double *Li=L.p+i*(i+1)/2;
+      double *xi=X+i*m;
+      for(uint c=0; c<m; c++) xi[c] /= Li[i];
+      for(uint k=0; k<i; k++) { double l=Li[k]; double *xk=X+k*m; for(uint c=0; c<m; c++) xk[c] -= l*xi[c]; }
+    }
+  }
+  return x;
+}
+
 /// the determinant of a 2D squared matrix
 double determinant(const arr& A);
 
@@ -11,6 +11,7 @@
 #include "array.h"
 
 #include <algorithm>
+#include <atomic>
 
 #define ARRAY_flexiMem true
 
@@ -22,6 +23,7 @@ namespace rai {
 
 //fwd declarations
 extern int64_t globalMemoryTotal, globalMemoryBound;
+extern std::atomic<uint64_t> globalMemoryAllocs;
 extern bool globalMemoryStrict;
 
 extern uint lineCount;
@@ -305,6 +307,7 @@ template<class T> void Array<T>::resizeMEM(uint n, bool copy, int Mforce) {
       LOG(0) <<"using massive memory: " <<(globalMemoryTotal>>20) <<"MB";
     }
     if(Mnew) {
+      globalMemoryAllocs.fetch_add(1, std::memory_order_relaxed);
       if(memMove==1){
         if(p){
           p=(T*)realloc(p, Mnew*sizeT);
@@ -595,6 +595,43 @@ double sqrDistance(const arr& v, const arr& w) {
   return t;
 }
 
+/// all pairwise squared distances D(i,j)=|X1[i]-X2[j]|^2 of the rows, as |X1[i]|^2 + |X2[j]|^2 - 2 X1 X2^T (one matrix product)
+arr sqrDistances(const arr& X1, const arr& X2) {
+  CHECK(X1.nd==2 && X2.nd==2 && X1.d1==X2.d1, "sqrDistances needs two matrices with rows of equal dimension");
+  uint n=X1.d0, m=X2.d0, d=X1.d1;
+  arr D(n, m);
+  if(!n || !m) return D;
+  if(!d) { D.setZero(); return D; }
+  D = X1 * ~X2;
+  arr s1(n), s2(m);
+  for(uint i=0; i<n; i++) s1.p[i] = sumOfSqr(X1[i]);
+  for(uint j=0; j<m; j++) s2.p[j] = sumOfSqr(X2[j]);
+  for(uint i=0; i<n; i++) {
+    double* Di = D.p+i*m;
+    for(uint j=0; j<m; j++) {
+      double dij = s1.p[i] + s2.p[j] - 2.*Di[j];
+      Di[j] = dij>0. ? dij : 0.; //(cancellation for nearby points)
+    }
+  }
+  return D;
+}
+
+arr KernelFunction::kernelMatrix(const arr& X1, const arr& X2, arr& J, arr& H) {
+  uint n=X1.d0, m=X2.d0, d=X1.d1;
+  arr K(n, m);
+  if(!!J) J.resize(n*m, d);
+  if(!!H) H.resize(n*m, d*d);
+  arr g, h;
+  for(uint i=0; i<n; i++) for(uint j=0; j<m; j++) {
+      K(i, j) = k(X1[i], X2[j], (!!J ? g : NoArr), (!!H ? h : NoArr));
+      if(!!J) J[i*m+j] = g;
+      if(!!H) H[i*m+j] = h.reshape(d*d);
+    }
+  if(!!J) J.reshape(n, m, d);
+  if(!!H) H.reshape({n, m, d, d});
+  return K;
+}
+
 double maxDiff(const arr& v, const arr& w, uint* im) {
   CHECK_EQ(v.N, w.N,
            "maxDiff on different array dimensions (" <<v.N <<", " <<w.N <<")");
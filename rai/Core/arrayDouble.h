@@ -325,6 +325,9 @@ typedef std::function<double(arr& g, arr& H, const arr& x)> ScalarFunction;
 /// a kernel function
 struct KernelFunction {
   virtual double k(const arr& x1, const arr& x2, arr& g1=NoArr, arr& Hx1=NoArr) = 0;
+  /// K(i,j)=k(X1[i], X2[j]), optionally with gradients J(i,j,:) and Hessians H(i,j,:,:) w.r.t. X1[i] -- the default calls
+  /// k() pair by pair; kernels overload this with a vectorized version
+  virtual arr kernelMatrix(const arr& X1, const arr& X2, arr& J=NoArr, arr& H=NoArr);
   virtual ~KernelFunction() {}
 };
 
@@ -432,6 +435,10 @@ void inverse_LU(arr& Xinv, const arr& X);
 void inverse_SymPosDef(arr& Ainv, const arr& A);
 inline arr inverse_SymPosDef(const arr& A) { arr Ainv; inverse_SymPosDef(Ainv, A); return Ainv; }
 arr pseudoInverse(const arr& A, const arr& Winv=NoArr, double robustnessEps=1e-10);
+double choleskyModified(arr& A, arr& d, double delta=1e-8);
+arr choleskyModified_solve(const arr& L, const arr& d, const arr& b);
+void cholesky_appendPacked(arr& L, const arr& k, double kk);
+arr cholesky_solvePacked(const arr& L, const arr& b, bool transposed=false);
 void gaussFromData(arr& a, arr& A, const arr& X);
 void rotationFromAtoB(arr& R, const arr& a, const arr& v);
 
@@ -513,6 +520,7 @@ double maxRelDiff(const arr& v, const arr& w, double tol);
 //double sqrDistance(const arr& v, const arr& w, const array<bool>& mask);
 double sqrDistance(const arr& g, const arr& v, const arr& w);
 double euclideanDistance(const arr& v, const arr& w);
+arr sqrDistances(const arr& X1, const arr& X2);
 double metricDistance(const arr& g, const arr& v, const arr& w);
 
 //min max
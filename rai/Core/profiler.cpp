@@ -0,0 +1,190 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "profiler.h"
+#include "util.ipp"
+
+#include <chrono>
+#include <map>
+#include <iomanip>
+
+namespace rai {
+
+std::atomic<bool> Profiler::enabled(true);
+
+namespace {
+
+const auto profileStart = std::chrono::steady_clock::now();
+
+double profileTime() { //microseconds, as the Chrome trace format
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - profileStart).count();
+}
+
+struct ProfileEvent {
+  const char* name;
+  double begin, end; ///< end<0: scope still open
+  uint depth;
+};
+
+struct ProfileCount {
+  const char* name;
+  double time, total;
+};
+
+struct ProfileThread {
+  std::mutex mutex; //(only contended while the trace is written)
+  uint id;
+  uint depth=0;
+  uint generation=0; ///< incremented by clear()
+  std::vector<ProfileEvent> events;
+  std::vector<ProfileCount> counts;
+  std::map<const char*, double> totals;
+};
+
+struct ProfileData {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ProfileThread>> threads; //(outlive their threads, so that exited threads are still reported)
+  uint maxEvents;
+  String traceFile;
+
+  ProfileData() {
+    Profiler::enabled = getParameter<bool>("Profiler/enabled", true);
+    maxEvents = getParameter<double>("Profiler/maxEvents", 1e6);
+    traceFile = getParameter<String>("Profiler/traceFile", String());
+  }
+};
+
+ProfileData& profileData() {
+  static ProfileData D;
+  //registered after D is constructed, so it runs before D's destruction
+  static bool writeAtExit = D.traceFile.N && !std::atexit([]() { Profiler::writeChromeTrace(profileData().traceFile); });
+  (void)writeAtExit;
+  return D;
+}
+
+ProfileThread& profileThread() {
+  thread_local ProfileThread* T=nullptr;
+  if(!T) {
+    ProfileData& D = profileData();
+    std::lock_guard<std::mutex> lock(D.mutex);
+    D.threads.push_back(std::make_shared<ProfileThread>());
+    T = D.threads.back().get();
+    T->id = D.threads.size()-1;
+  }
+  return *T;
+}
+
+struct ProfileNode {
+  const char* name;
+  uint calls=0;
+  double total=0., max=0.;
+  std::map<std::string, ProfileNode> children; //(by string: equal literals of different files may have different addresses)
+
+  void write(std::ostream& os, uint depth, double parentTotal) const {
+    os <<std::string(2*depth, ' ') <<name <<"  calls: " <<calls <<"  total: " <<1e-3*total <<"ms  max: " <<1e-3*max <<"ms";
+    if(parentTotal>0.) os <<"  (" <<100.*total/parentTotal <<"%)";
+    os <<endl;
+    for(auto& c:children) c.second.write(os, depth+1, total);
+  }
+};
+
+} //namespace
+
+int Profiler::begin(const char* name, uint& generation) {
+  ProfileThread& T = profileThread();
+  if(!enabled) return -1;
+  std::lock_guard<std::mutex> lock(T.mutex);
+  if(T.events.size()>=profileData().maxEvents) return -1;
+  generation = T.generation;
+  T.events.push_back({name, profileTime(), -1., T.depth++});
+  return T.events.size()-1;
+}
+
+void Profiler::end(int event, uint generation) {
+  double time = profileTime();
+  ProfileThread& T = profileThread();
+  std::lock_guard<std::mutex> lock(T.mutex);
+  T.depth--;
+  if(generation==T.generation) T.events[event].end = time; //(otherwise clear() was called within the scope)
+}
+
+void Profiler::count(const char* name, double n) {
+  if(!enabled) return;
+  ProfileThread& T = profileThread();
+  std::lock_guard<std::mutex> lock(T.mutex);
+  double& total = T.totals[name];
+  total += n;
+  if(T.counts.size()<profileData().maxEvents) T.counts.push_back({name, profileTime(), total});
+}
+
+void Profiler::clear() {
+  ProfileData& D = profileData();
+  std::lock_guard<std::mutex> lock(D.mutex);
+  for(auto& T:D.threads) {
+    std::lock_guard<std::mutex> lockT(T->mutex);
+    T->generation++;
+    T->events.clear();
+    T->counts.clear();
+    T->totals.clear();
+  }
+}
+
+void Profiler::writeChromeTrace(const char* filename) {
+  ProfileData& D = profileData();
+  std::ofstream fil(filename);
+  CHECK(fil.good(), "could not open '" <<filename <<"'");
+  fil <<std::fixed <<std::setprecision(3) <<"{\"traceEvents\":[";
+  const char* sep="\n";
+  std::lock_guard<std::mutex> lock(D.mutex);
+  for(auto& T:D.threads) {
+    std::lock_guard<std::mutex> lockT(T->mutex);
+    fil <<sep <<"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" <<T->id <<",\"args\":{\"name\":\"thread " <<T->id <<"\"}}";
+    sep=",\n";
+    for(const ProfileEvent& e:T->events) {
+      if(e.end<0.) continue;
+      fil <<sep <<"{\"name\":\"" <<e.name <<"\",\"ph\":\"X\",\"ts\":" <<e.begin <<",\"dur\":" <<e.end-e.begin
+          <<",\"pid\":0,\"tid\":" <<T->id <<'}';
+    }
+    for(const ProfileCount& c:T->counts) {
+      fil <<sep <<"{\"name\":\"" <<c.name <<"\",\"ph\":\"C\",\"ts\":" <<c.time <<",\"pid\":0,\"tid\":" <<T->id
+          <<",\"args\":{\"value\":" <<c.total <<"}}";
+    }
+  }
+  fil <<"\n]}" <<endl;
+}
+
+void Profiler::report(std::ostream& os) {
+  ProfileData& D = profileData();
+  std::lock_guard<std::mutex> lock(D.mutex);
+  for(auto& T:D.threads) {
+    std::lock_guard<std::mutex> lockT(T->mutex);
+    if(!T->events.size() && !T->totals.size()) continue;
+    //-- events are in pre-order: rebuild the call tree along the stack of open scopes
+    ProfileNode root;
+    root.name = "thread";
+    std::vector<ProfileNode*> stack = {&root};
+    for(const ProfileEvent& e:T->events) {
+      if(e.end<0.) continue;
+      stack.resize(std::min<size_t>(e.depth+1, stack.size()));
+      ProfileNode& n = stack.back()->children[e.name];
+      n.name = e.name;
+      n.calls++;
+      double dt = e.end-e.begin;
+      n.total += dt;
+      if(dt>n.max) n.max=dt;
+      stack.push_back(&n);
+    }
+    os <<"thread " <<T->id <<endl;
+    for(auto& c:root.children) c.second.write(os, 1, 0.);
+    std::map<std::string, double> totals;
+    for(auto& c:T->totals) totals[c.first] += c.second;
+    for(auto& c:totals) os <<"  " <<c.first <<"  count: " <<c.second <<endl;
+  }
+}
+
+} //namespace
@@ -0,0 +1,63 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "util.h"
+
+#include <atomic>
+
+//===========================================================================
+//
+// scoped timers and counters
+//
+// RAI_PROFILE("name") times the enclosing scope, RAI_PROFILE_COUNT("name", n) adds n to a counter; the name must be a
+// string literal. Both compile to nothing unless RAI_PROFILE is defined (make PROFILE=1). Scopes nest per thread;
+// each thread records into its own buffer, so recording never waits for other threads.
+//
+// parameters: Profiler/enabled (default true), Profiler/traceFile (if set, the Chrome trace is written there at exit),
+// Profiler/maxEvents (per thread; later scopes are dropped)
+//
+
+#ifdef RAI_PROFILE
+#  define RAI_PROFILE_CAT2(a, b) a##b
+#  define RAI_PROFILE_CAT(a, b) RAI_PROFILE_CAT2(a, b)
+#  define RAI_PROFILE(name) rai::ProfileScope RAI_PROFILE_CAT(_profileScope, __LINE__)(name)
+#  define RAI_PROFILE_COUNT(name, n) rai::Profiler::count(name, n)
+#else
+#  define RAI_PROFILE(name)
+#  define RAI_PROFILE_COUNT(name, n)
+#endif
+
+namespace rai {
+
+struct Profiler {
+  static std::atomic<bool> enabled;
+
+  /// Chrome trace event format (load in chrome://tracing or ui.perfetto.dev): one complete event per scope, counters as
+  /// counter events
+  static void writeChromeTrace(const char* filename);
+  /// call tree of all threads with calls, total and max time per scope, and the counter totals
+  static void report(std::ostream& os=cout);
+  /// scopes that are open during clear() are not recorded
+  static void clear();
+
+  //-- used by ProfileScope and RAI_PROFILE_COUNT
+  static int begin(const char* name, uint& generation);
+  static void end(int event, uint generation);
+  static void count(const char* name, double n);
+};
+
+struct ProfileScope {
+  int event;
+  uint generation; ///< of the thread's event buffer, which clear() increments: event indices of earlier generations are stale
+  ProfileScope(const char* name) : event(Profiler::enabled ? Profiler::begin(name, generation) : -1) {}
+  ~ProfileScope() { if(event>=0) Profiler::end(event, generation); }
+};
+
+} //namespace
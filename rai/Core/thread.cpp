@@ -572,6 +572,118 @@ void signalhandler(int s) {
   }
 }
 
+//===========================================================================
+//
+// ThreadPool
+//
+
+namespace {
+thread_local const ThreadPool* thisPool=nullptr;
+thread_local uint thisWorker=0;
+}
+
+ThreadPool::ThreadPool(uint numWorkers, bool pinThreads) {
+  for(uint i=0; i<=numWorkers; i++) queues.push_back(std::make_unique<Queue>());
+  for(uint i=0; i<numWorkers; i++) workers.emplace_back(&ThreadPool::loop, this, i, pinThreads);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stop=true;
+  }
+  wakeUp.notify_all();
+  for(std::thread& th:workers) th.join();
+}
+
+ThreadPool& ThreadPool::global() {
+  static rai::ThreadPool_Options opt;
+  static uint n = opt.numThreads>0 ? opt.numThreads : std::thread::hardware_concurrency();
+  static ThreadPool pool(n>1 ? n-1 : 0, opt.pinThreads); //(the thread waiting for a loop works as well)
+  return pool;
+}
+
+uint ThreadPool::queueOfThisThread() const {
+  if(thisPool==this) return thisWorker;
+  return queues.size()-1;
+}
+
+void ThreadPool::run(TaskGroup& group, const std::function<void()>& task) {
+  group.pending++;
+  Queue& Q = *queues[queueOfThisThread()];
+  {
+    std::lock_guard<std::mutex> lock(Q.mutex);
+    queued++;
+    Q.tasks.push_back({task, &group});
+  }
+  if(!workers.size()) return; //wait() runs it
+  { std::lock_guard<std::mutex> lock(sleepMutex); } //(a worker can't be between checking 'queued' and sleeping)
+  wakeUp.notify_one();
+}
+
+bool ThreadPool::pop(uint q, Task& task, bool newest) {
+  Queue& Q = *queues[q];
+  std::lock_guard<std::mutex> lock(Q.mutex);
+  if(Q.tasks.empty()) return false;
+  if(newest) { task = std::move(Q.tasks.back()); Q.tasks.pop_back(); }
+  else { task = std::move(Q.tasks.front()); Q.tasks.pop_front(); }
+  queued--;
+  return true;
+}
+
+bool ThreadPool::runOne(uint q) {
+  Task task;
+  if(!pop(q, task, true)) { //own queue empty: steal the oldest task of the others
+    uint n=queues.size(), k=1;
+    for(; k<n; k++) if(pop((q+k)%n, task, false)) break;
+    if(k==n) return false;
+  }
+  TaskGroup& group = *task.group;
+  try {
+    task.f();
+  } catch(...) {
+    std::lock_guard<std::mutex> lock(group.mutex);
+    if(!group.error) group.error = std::current_exception();
+  }
+  //(under the lock: the waiting thread may destroy the group as soon as pending is zero)
+  std::lock_guard<std::mutex> lock(group.mutex);
+  if(!--group.pending) group.finished.notify_all();
+  return true;
+}
+
+void ThreadPool::wait(TaskGroup& group) {
+  uint q = queueOfThisThread();
+  while(group.pending) {
+    if(runOne(q)) continue;
+    //the remaining tasks are running on other threads
+    std::unique_lock<std::mutex> lock(group.mutex);
+    group.finished.wait(lock, [&group]() { return !group.pending; });
+  }
+  std::lock_guard<std::mutex> lock(group.mutex); //(the thread of the last task may still hold it)
+  if(group.error) std::rethrow_exception(group.error);
+}
+
+void ThreadPool::loop(uint i, bool pin) {
+  thisPool = this;
+  thisWorker = i;
+#ifndef RAI_MSVC
+  pthread_setname_np(pthread_self(), STRING("pool_" <<i));
+  if(pin) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(i % std::thread::hardware_concurrency(), &cpus);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if(rc) LOG(-1) <<"pinning pool thread " <<i <<" failed: " <<strerror(rc);
+  }
+#endif
+  for(;;) {
+    if(runOne(i)) continue;
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    wakeUp.wait(lock, [this]() { return stop || queued>0; });
+    if(stop && !queued) return;
+  }
+}
+
 //===========================================================================
 //
 // Utils
@@ -15,6 +15,12 @@
 #include <shared_mutex>
 #include <condition_variable>
 #include <thread>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <exception>
 
 enum ThreadState { tsIsClosed=-6, tsToOpen=-1, tsLOOPING=-2, tsBEATING=-3, tsIDLE=0, tsToStep=1, tsToClose=-4,  tsFAILURE=-5,  }; //positive states indicate steps-to-go
 struct Signaler;
@@ -280,6 +286,70 @@ inline bool wait(const VarL& acts, double timeout=-1.) {
   return Event(acts, _allPositive).waitForStatusEq(AS_true, 0, timeout);
 }
 
+//===========================================================================
+
+/// copy/resize helpers of SeqVar (plain memcpy for trivially copyable T; arr has a fixed size)
+template<class T> void seqVar_copy(T& to, const T& from) {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqVar<T> requires a trivially copyable T (or arr)");
+  memcpy((void*)&to, (const void*)&from, sizeof(T));
+}
+template<class T> void seqVar_resize(T& x, const T& like) {}
+template<class T> void seqVar_checkSize(const T& value, const T& x) {}
+inline void seqVar_copy(arr& to, const arr& from) { memcpy(to.p, from.p, from.N*sizeof(double)); }
+inline void seqVar_checkSize(const arr& value, const arr& x) {
+  CHECK_EQ(x.N, value.N, "SeqVar<arr> has a fixed size (set by its constructor)");
+}
+inline void seqVar_resize(arr& x, const arr& like) { if(x.N!=like.N) x.resizeAs(like); }
+
+/** A variable for high-rate single-writer/multi-reader data (e.g., q_real and qDot_real written by a simulation or robot
+    thread). Instead of the RWLock it is guarded by a seqlock: set() never waits for readers, and get() never blocks the
+    writer -- a reader only repeats its copy if a write overlapped it. T must be trivially copyable, or an arr whose size
+    is fixed by the constructor. The revision, write/data times and listeners (Event::listenTo) work as for Var<T>;
+    listeners are called by the writer after it published. */
+template<class T>
+struct SeqVar {
+  struct Data : Var_base {
+    std::atomic<uint> seq={0}; ///< odd while a write is in progress; seq/2 is the revision
+    T value;
+    Data(const char* name) : Var_base(name), value() {}
+  };
+  shared_ptr<Data> data;
+
+  SeqVar(const char* name=0) : data(make_shared<Data>(name)) {}
+  SeqVar(const T& init, const char* name=0) : SeqVar(name) { data->value=init; }
+
+  void set(const T& x, double dataTime=-1.) {
+    seqVar_checkSize(data->value, x); //(before the write starts: throwing while seq is odd would block all readers)
+    uint s = data->seq.load(std::memory_order_relaxed);
+    data->seq.store(s+1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    seqVar_copy(data->value, x);
+    data->seq.store(s+2, std::memory_order_release);
+    //revision, times and listeners as for Var (readers of the value never take this lock)
+    data->writeAccess();
+    if(dataTime>=0.) data->data_time=dataTime;
+    data->deAccess();
+  }
+
+  /// copies the latest value into x (for arr: without allocation once x has the right size); returns its revision
+  uint get(T& x) const {
+    seqVar_resize(x, data->value);
+    for(;;) {
+      uint s = data->seq.load(std::memory_order_acquire);
+      if(!(s&1)) {
+        seqVar_copy(x, data->value);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(data->seq.load(std::memory_order_relaxed)==s) return s/2;
+      }
+      std::this_thread::yield();
+    }
+  }
+  T get() const { T x; get(x); return x; }
+
+  uint getRevision() const { return data->seq.load(std::memory_order_acquire)/2; }
+  operator Var_base& () { return *data; }
+};
+
 //===========================================================================
 //
 // Timing helpers
@@ -406,6 +476,91 @@ inline shared_ptr<ScriptThread> run(const std::function<int ()>& script, double
   return make_shared<ScriptThread>(script, beatIntervalSec);
 }
 
+//===========================================================================
+//
+// thread pool and parallel loops
+//
+
+namespace rai {
+struct ThreadPool_Options {
+  RAI_PARAM("ThreadPool/", int, numThreads, 0) //threads of parallel loops, including the calling thread (0: std::thread::hardware_concurrency())
+  RAI_PARAM("ThreadPool/", bool, pinThreads, false) //pin worker i to core i
+};
+}
+
+/** A work-stealing pool of worker threads: each worker owns a task deque (it pops its newest task, idle workers steal
+    the oldest); tasks run from outside the pool go to a shared queue. A thread waiting for a TaskGroup runs pending tasks
+    meanwhile -- so tasks may run and wait for nested tasks, and a pool without workers runs everything in wait(). */
+struct ThreadPool {
+  struct TaskGroup {
+    std::atomic<uint> pending={0};
+    std::exception_ptr error; ///< the first exception thrown by a task, rethrown by wait()
+    std::mutex mutex;         ///< guards error and the completion of the last task
+    std::condition_variable finished;
+  };
+
+  ThreadPool(uint numWorkers, bool pinThreads=false);
+  ~ThreadPool();
+
+  uint size() const { return workers.size(); } ///< number of worker threads (not counting the waiting thread)
+  void run(TaskGroup& group, const std::function<void()>& task);
+  void wait(TaskGroup& group);
+
+  static ThreadPool& global(); ///< sized by ThreadPool/numThreads (created on first use)
+
+ private:
+  struct Task { std::function<void()> f; TaskGroup* group=nullptr; };
+  struct Queue { std::mutex mutex; std::deque<Task> tasks; };
+  std::vector<std::thread> workers;
+  std::vector<std::unique_ptr<Queue>> queues; ///< one per worker, the last is the shared queue
+  std::mutex sleepMutex;
+  std::condition_variable wakeUp;
+  std::atomic<uint> queued={0};
+  bool stop=false;
+
+  uint queueOfThisThread() const;
+  bool pop(uint q, Task& task, bool newest);
+  bool runOne(uint q);
+  void loop(uint i, bool pin);
+};
+
+/// number of indices per chunk for a parallel loop over n indices (grain=0: about 4 chunks per thread)
+inline uint parallel_grain(uint n, uint grain, const ThreadPool& pool) {
+  if(grain) return grain;
+  uint chunks = 4*(pool.size()+1);
+  return n>chunks ? (n+chunks-1)/chunks : 1;
+}
+
+/// calls f(i) for all i in [begin, end), distributing chunks of grain indices over the pool
+template<class F> void parallel_for(uint begin, uint end, const F& f, uint grain=0, ThreadPool& pool=ThreadPool::global()) {
+  if(end<=begin) return;
+  grain = parallel_grain(end-begin, grain, pool);
+  ThreadPool::TaskGroup group;
+  for(uint b=begin; b<end; b+=grain) {
+    uint e = std::min(b+grain, end);
+    pool.run(group, [&f, b, e]() { for(uint i=b; i<e; i++) f(i); });
+  }
+  pool.wait(group);
+}
+
+/// reduces f(i) over [begin, end) with op, where init must be the identity of op; the chunk results are combined in
+/// order, so the result does not depend on the scheduling (only on the grain)
+template<class T, class F, class Op> T parallel_reduce(uint begin, uint end, const T& init, const F& f, const Op& op,
+                                                       uint grain=0, ThreadPool& pool=ThreadPool::global()) {
+  if(end<=begin) return init;
+  grain = parallel_grain(end-begin, grain, pool);
+  std::vector<T> partial((end-begin+grain-1)/grain, init);
+  ThreadPool::TaskGroup group;
+  for(uint c=0; c<partial.size(); c++) {
+    uint b = begin+c*grain, e = std::min(b+grain, end);
+    pool.run(group, [&f, &op, &partial, c, b, e]() { for(uint i=b; i<e; i++) partial[c] = op(partial[c], f(i)); });
+  }
+  pool.wait(group);
+  T x = init;
+  for(const T& p:partial) x = op(x, p);
+  return x;
+}
+
 // ================================================
 //
 // template definitions
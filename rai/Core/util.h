@@ -554,6 +554,8 @@ struct OpenGLDrawOptions{
   bool enableLighting=true;
 
   float pclPointSize=-1.;
+  uint meshLod=0; ///< level of detail for drawing mesh shapes (see Shape::lod)
+  bool meshBuffers=true; ///< draw meshes from cached GPU vertex/index buffers (see Mesh::glDraw)
 };
 
 //===========================================================================
@@ -29,14 +29,187 @@ Depth2PointCloud::~Depth2PointCloud() {
 void Depth2PointCloud::step() {
   _depth = depth.get();
 
+  rai::Transformation _pose = pose.get(); //this is relative to "/base_link"
+
+  if(compact) {
+    fused.fx=fx; fused.fy=fy; fused.px=px; fused.py=py;
+    fused.compute(_depth, _pose);
+    cloud.set() = fused.points;
+    if(fused.computeNormals) normals.set() = fused.normals;
+    return;
+  }
+
   depthData2pointCloud(_points, _depth, fx, fy, px, py);
 
-  rai::Transformation _pose = pose.get(); //this is relative to "/base_link"
   if(!_pose.isZero()) _pose.applyOnPointArray(_points);
 
   points.set() = _points;
 }
 
+//===========================================================================
+
+void DepthToPointCloud::compute(const floatA& depth, const rai::Transformation& pose) {
+  uint H=depth.d0, W=depth.d1;
+  CHECK_EQ(depth.nd, 2, "");
+  CHECK(fx>0, "need a focal length greater zero!(not implemented for ortho yet)");
+  float _fy = std::isnan(fy) ? fx : fy;
+  float _px = std::isnan(px) ? .5f*W : px;
+  float _py = std::isnan(py) ? .5f*H : py;
+  float ifx=1.f/fx, ify=1.f/_fy;
+
+  //-- camera to world, in float
+  float R[9] = {1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f}, t[3] = {0.f, 0.f, 0.f};
+  if(!pose.isZero()) {
+    double m[9];
+    pose.rot.getMatrix(m);
+    for(uint k=0; k<9; k++) R[k]=m[k];
+    t[0]=pose.pos.x; t[1]=pose.pos.y; t[2]=pose.pos.z;
+  }
+
+  //-- blocks of rows, each compacted into its own buffers
+  const uint rowsPerBlock=8;
+  uint nBlocks = (H+rowsPerBlock-1)/rowsPerBlock;
+  blockPoints.resize(nBlocks);  blockPixels.resize(nBlocks);
+  if(computeNormals) blockNormals.resize(nBlocks);
+  parallel_for(0, nBlocks, [&](uint b) {
+    uint i0=b*rowsPerBlock, i1=rai::MIN(i0+rowsPerBlock, H);
+    floatA& P = blockPoints[b];
+    uintA& I = blockPixels[b];
+    P.resize((i1-i0)*W, 3);
+    I.resize((i1-i0)*W);
+    floatA wx(W), wy(W), wz(W), nx, ny, nz;
+    byteA valid(W), hasNormal;
+    if(computeNormals) {
+      nx.resize(W);  ny.resize(W);  nz.resize(W);  hasNormal.resize(W);
+      floatA& N = blockNormals[b];
+      N.resize((i1-i0)*W, 3);
+    }
+    uint n=0;
+    for(uint i=i0; i<i1; i++) {
+      const float* d = depth.p+i*W;
+      float yc = -(i-_py)*ify;
+      //branch-free: unproject, transform and mark valid pixels of the whole row (vectorizes)
+      for(uint j=0; j<W; j++) {
+        float cz=-d[j], cx=d[j]*(j-_px)*ifx, cy=d[j]*yc;
+        wx.p[j] = R[0]*cx + R[1]*cy + R[2]*cz + t[0];
+        wy.p[j] = R[3]*cx + R[4]*cy + R[5]*cz + t[1];
+        wz.p[j] = R[6]*cx + R[7]*cy + R[8]*cz + t[2];
+        valid.p[j] = (d[j]>=minDepth) & (d[j]<=maxDepth) & (d[j]>=0.f); //(false for nan)
+      }
+      if(computeNormals) {
+        //camera frame normals: cross product of the central differences along the image grid (one-sided at borders)
+        uint iu = (i ? i-1 : i), id = (i+1<H ? i+1 : i);
+        const float *du=depth.p+iu*W, *dd=depth.p+id*W;
+        float ycu = -(iu-_py)*ify, ycd = -(id-_py)*ify;
+        for(uint j=0; j<W; j++) {
+          uint jl = j-(j>0), jr = j+(j+1<W);
+          float d0=d[j], dl=d[jl], dr=d[jr];
+          float ax = (dr*(jr-_px) - dl*(jl-_px))*ifx, ay = (dr-dl)*yc, az = dl-dr;
+          float cx = (dd[j]-du[j])*(j-_px)*ifx, cy = dd[j]*ycd - du[j]*ycu, cz = du[j]-dd[j];
+          float mx = ay*cz-az*cy, my = az*cx-ax*cz, mz = ax*cy-ay*cx;
+          float dot = d0*((j-_px)*ifx*mx + yc*my - mz); //n . p0: flip to face the camera at the origin
+          float sign = (dot>0.f) ? -1.f : 1.f;
+          nx.p[j]=sign*mx;  ny.p[j]=sign*my;  nz.p[j]=sign*mz;
+          float jump = normalMaxJump*d0;
+          hasNormal.p[j] = (fabsf(dl-d0)<=jump) & (fabsf(dr-d0)<=jump) & (fabsf(du[j]-d0)<=jump) & (fabsf(dd[j]-d0)<=jump)
+                           & (jl!=jr) & (iu!=id);
+        }
+      }
+      //compaction
+      for(uint j=0; j<W; j++) if(valid.p[j]) {
+          float* q=P.p+3*n;
+          q[0]=wx.p[j];  q[1]=wy.p[j];  q[2]=wz.p[j];
+          if(computeNormals) {
+            float* nk = blockNormals[b].p+3*n;
+            float m[3] = {nx.p[j], ny.p[j], nz.p[j]};
+            float l = sqrtf(m[0]*m[0]+m[1]*m[1]+m[2]*m[2]);
+            if(hasNormal.p[j] && l>0.f) {
+              for(uint c=0; c<3; c++) nk[c] = (R[3*c]*m[0] + R[3*c+1]*m[1] + R[3*c+2]*m[2])/l;
+            } else {
+              nk[0]=nk[1]=nk[2]=0.f;
+            }
+          }
+          I.p[n++] = i*W+j;
+        }
+    }
+    P.resizeCopy(n, 3);
+    I.resizeCopy(n);
+    if(computeNormals) blockNormals[b].resizeCopy(n, 3);
+  }, 1);
+
+  //-- concatenate the blocks in order
+  uint n=0;
+  for(uint b=0; b<nBlocks; b++) n += blockPixels[b].N;
+  points.resize(n, 3);
+  pixels.resize(n);
+  if(computeNormals) normals.resize(n, 3); else normals.clear();
+  n=0;
+  for(uint b=0; b<nBlocks; b++) {
+    uint m=blockPixels[b].N;
+    if(!m) continue;
+    memmove(points.p+3*n, blockPoints[b].p, 3*m*sizeof(float));
+    memmove(pixels.p+n, blockPixels[b].p, m*sizeof(uint));
+    if(computeNormals) memmove(normals.p+3*n, blockNormals[b].p, 3*m*sizeof(float));
+    n+=m;
+  }
+
+  if(voxelSize>0.f) voxelDownsample();
+}
+
+void DepthToPointCloud::voxelDownsample() {
+  //voxels are numbered in the order of their first point; each is accumulated in place at its number (<= the point's)
+  //open addressing hash table: voxel key -> voxel number
+  uint size=1024;
+  while(size<2*points.d0) size<<=1;
+  voxelKeys.resize(size);
+  voxelKeys.setZero();
+  voxelIds.resize(size);
+  uintA count;
+  count.resize(points.d0);
+  float iv=1.f/voxelSize;
+  uint n=0, lastVoxel=0;
+  uint64_t lastKey=0;
+  for(uint k=0; k<points.d0; k++) {
+    const float* p = points.p+3*k;
+    uint64_t key=1; //(leading 1: 0 marks empty slots)
+    for(uint c=0; c<3; c++) key = (key<<21) | (uint64_t(int64_t(floorf(p[c]*iv)) + (1<<20)) & ((1<<21)-1));
+    bool isNew=false;
+    if(key!=lastKey) { //(neighboring pixels mostly fall into the same voxel)
+      uint h = uint((key*0x9E3779B97F4A7C15ull)>>32) & (size-1);
+      while(voxelKeys.p[h] && voxelKeys.p[h]!=key) h = (h+1) & (size-1);
+      isNew = !voxelKeys.p[h];
+      if(isNew) { voxelKeys.p[h]=key; voxelIds.p[h]=n; }
+      lastKey=key;
+      lastVoxel=voxelIds.p[h];
+    }
+    uint v = lastVoxel;
+    if(isNew) {
+      if(v!=k) {
+        memmove(points.p+3*v, p, 3*sizeof(float));
+        if(normals.N) memmove(normals.p+3*v, normals.p+3*k, 3*sizeof(float));
+        pixels.p[v] = pixels.p[k];
+      }
+      count.p[v] = 1;
+      n++;
+    } else {
+      for(uint c=0; c<3; c++) points.p[3*v+c] += p[c];
+      if(normals.N) for(uint c=0; c<3; c++) normals.p[3*v+c] += normals.p[3*k+c];
+      count.p[v]++;
+    }
+  }
+  points.resizeCopy(n, 3);
+  pixels.resizeCopy(n);
+  for(uint v=0; v<n; v++) for(uint c=0; c<3; c++) points.p[3*v+c] /= count.p[v];
+  if(normals.N) {
+    normals.resizeCopy(n, 3);
+    for(uint v=0; v<n; v++) {
+      float* nv = normals.p+3*v;
+      float l = sqrtf(nv[0]*nv[0]+nv[1]*nv[1]+nv[2]*nv[2]);
+      if(l>0.f) for(uint c=0; c<3; c++) nv[c] /= l;
+    }
+  }
+}
+
 void depthData2pointCloud(arr& pts, const floatA& depth, float fx, float fy, float px, float py) {
   uint H=depth.d0, W=depth.d1;
 
@@ -13,16 +13,52 @@
 
 #include <math.h>
 
+//===========================================================================
+/// fused depth -> world point cloud: unprojects, filters (depth range) and compacts the valid pixels and transforms them
+/// to the world frame in a single pass over blocks of rows (in parallel on ThreadPool::global); the per-pixel loops are
+/// branch-free, so that they vectorize. Optionally with normals from the image grid and voxel-grid downsampling.
+struct DepthToPointCloud {
+  float fx=NAN, fy=NAN, px=NAN, py=NAN; ///< intrinsics as in depthData2pointCloud
+  float minDepth=0.f, maxDepth=INFINITY; ///< pixels outside [minDepth, maxDepth] (and negative or nan depths) are dropped
+  float voxelSize=0.f;                   ///< >0: one point per occupied voxel (the centroid, with the averaged normal)
+  bool computeNormals=false;
+  float normalMaxJump=.05f;              ///< no normal (zero) across depth jumps larger than this fraction of the depth
+
+  //outputs (in the order of the pixels, or of the first pixel of each voxel)
+  floatA points;  ///< (n,3), world frame
+  floatA normals; ///< (n,3) if computeNormals, unit and facing the camera; zero where the neighbors are invalid
+  uintA pixels;   ///< (n) source pixel i*W+j (the first pixel of each voxel)
+
+  DepthToPointCloud() {}
+  DepthToPointCloud(const arr& Fxypxy) : fx(Fxypxy(0)), fy(Fxypxy(1)), px(Fxypxy(2)), py(Fxypxy(3)) {}
+
+  /// pose: the camera frame (as for depthData2pointCloud: looking along -z, y up); zero -> points in the camera frame
+  void compute(const floatA& depth, const rai::Transformation& pose=0);
+
+ private:
+  std::vector<floatA> blockPoints, blockNormals;
+  std::vector<uintA> blockPixels;
+  rai::Array<uint64_t> voxelKeys;
+  uintA voxelIds;
+  void voxelDownsample();
+};
+
+//===========================================================================
+
 struct Depth2PointCloud : Thread {
   //inputs
   Var<floatA> depth;
   Var<rai::Transformation> pose;
   //outputs
-  Var<arr> points;
+  Var<arr> points;       ///< dense (H,W,3) -- unless compact
+  Var<floatA> cloud;     ///< only if compact: the compacted world-frame points of the fused pipeline
+  Var<floatA> normals;   ///< only if compact and fused.computeNormals
 
   float fx, fy, px, py;
   floatA _depth;
   arr _points;
+  bool compact=false;      ///< use the fused pipeline (configured in fused) and write cloud/normals instead of points
+  DepthToPointCloud fused;
 
   Depth2PointCloud(Var<floatA>& _depth, float _fx=NAN, float _fy=NAN, float _px=NAN, float _py=NAN);
   Depth2PointCloud(Var<floatA>& _depth, const arr& Fxypxy);
@@ -7,6 +7,7 @@
     --------------------------------------------------------------  */
 
 #include "fclInterface.h"
+#include "../Core/profiler.h"
 
 #ifdef RAI_FCL
 
@@ -14,6 +15,7 @@
 #if FCL_MINOR_VERSION >= 6
 #  include <fcl/fcl.h>
 typedef fcl::CollisionObject<float> CollObject;
+typedef fcl::CollisionGeometry<float> CollGeometry;
 typedef fcl::Vector3<float> Vec3f;
 typedef fcl::Quaternionf Quaternionf;
 typedef fcl::BroadPhaseCollisionManager<float> BroadPhaseCollisionManager;
@@ -29,6 +31,7 @@ typedef fcl::DistanceResult<float> DistanceResult;
 #  include <fcl/collision.h>
 #  include <fcl/collision_data.h>
 typedef fcl::CollisionObject CollObject;
+typedef fcl::CollisionGeometry CollGeometry;
 typedef fcl::Vec3f Vec3f;
 typedef fcl::Quaternion3f Quaternionf;
 typedef fcl::BroadPhaseCollisionManager BroadPhaseCollisionManager;
@@ -45,10 +48,20 @@ struct ConvexGeometryData {
   intA polygons;
 };
 
+struct FclStaticObjects {
+  std::vector<CollObject*> objects;
+  shared_ptr<BroadPhaseCollisionManager> manager;
+  uintA collisions; //static-static pairs, queried once with the given cutoff
+  double cutoff;
+  ~FclStaticObjects() { for(CollObject* obj:objects) delete obj; }
+};
+
 struct FclInterface_self{
   Array<shared_ptr<struct ConvexGeometryData>> convexGeometryData;
   std::vector<CollObject*> objects;
+  std::vector<std::shared_ptr<CollGeometry>> models; //(shared with copies of the interface)
   shared_ptr<BroadPhaseCollisionManager> manager;
+  shared_ptr<FclStaticObjects> statics; //(shared with copies of the interface)
 
   static bool BroadphaseCallback(CollObject* o1, CollObject* o2, void* cdata_);
 };
@@ -94,6 +107,7 @@ FclInterface::FclInterface(const Array<shared_ptr<Mesh>>& geometries, double _cu
       CollObject* obj = new CollObject(model, fcl::Transform3f());
       obj->setUserData((void*)(i));
       self->objects.push_back(obj);
+      self->models.push_back(model);
     }
   }
 
@@ -106,36 +120,103 @@ FclInterface::FclInterface(const Array<shared_ptr<Mesh>>& geometries, double _cu
   self->manager->setup();
 }
 
+FclInterface::FclInterface(const FclInterface& base)
+  : cutoff(base.cutoff) {
+  self = new FclInterface_self;
+  self->convexGeometryData = base.self->convexGeometryData;
+  self->models = base.self->models;
+  self->statics = base.self->statics;
+  for(size_t i=0; i<base.self->objects.size(); i++) {
+    CollObject* obj = new CollObject(self->models[i], fcl::Transform3f());
+    obj->setUserData(base.self->objects[i]->getUserData());
+    self->objects.push_back(obj);
+  }
+  self->manager = make_shared<DynamicAABBTreeCollisionManager>();
+  self->manager->registerObjects(self->objects);
+  self->manager->setup();
+}
+
 FclInterface::~FclInterface() {
   for(size_t i = 0; i < self->objects.size(); ++i)
     delete self->objects[i];
   delete self;
 }
 
+void FclInterface::setStaticObjects(const uintA& ids, const arr& X) {
+  CHECK(!self->statics, "static objects have already been set");
+  CHECK_EQ(X.d0, self->convexGeometryData.N, "");
+  self->statics = make_shared<FclStaticObjects>();
+  std::vector<CollObject*> dynamics;
+  std::vector<std::shared_ptr<CollGeometry>> dynamicModels; //(models stay aligned with objects)
+  for(size_t k=0; k<self->objects.size(); k++) {
+    CollObject* obj = self->objects[k];
+    uint i = (long int)obj->getUserData();
+    if(!ids.contains(i)) { dynamics.push_back(obj); dynamicModels.push_back(self->models[k]); continue; }
+    obj->setTranslation(Vec3f(X(i, 0), X(i, 1), X(i, 2)));
+    obj->setQuatRotation(Quaternionf(X(i, 3), X(i, 4), X(i, 5), X(i, 6)));
+    obj->computeAABB();
+    self->statics->objects.push_back(obj);
+  }
+  self->objects = dynamics;
+  self->models = dynamicModels;
+
+  self->manager = make_shared<DynamicAABBTreeCollisionManager>();
+  self->manager->registerObjects(self->objects);
+  self->manager->setup();
+  self->statics->manager = make_shared<DynamicAABBTreeCollisionManager>();
+  self->statics->manager->registerObjects(self->statics->objects);
+  self->statics->manager->setup();
+
+  //static-static pairs don't change: query them once
+  collisions.clear();
+  self->statics->manager->collide(this, FclInterface_self::BroadphaseCallback);
+  self->statics->collisions = collisions;
+  self->statics->cutoff = cutoff;
+  collisions.clear();
+
+  X_lastQuery.clear();
+  cutoff_lastQuery=-2.;
+}
+
 void FclInterface::step(const arr& X, double _cutoff) {
+  RAI_PROFILE("FclInterface::step");
   CHECK_EQ(X.nd, 2, "");
   CHECK_EQ(X.d0, self->convexGeometryData.N, "");
   CHECK_EQ(X.d1, 7, "");
 
+  bool moved=false;
   for(auto* obj:self->objects) {
     uint i = (long int)obj->getUserData();
     if(i<X_lastQuery.d0 && maxDiff(X_lastQuery[i], X[i])<1e-8) continue;
     obj->setTranslation(Vec3f(X(i, 0), X(i, 1), X(i, 2)));
     obj->setQuatRotation(Quaternionf(X(i, 3), X(i, 4), X(i, 5), X(i, 6)));
     obj->computeAABB();
+    moved=true;
   }
-  self->manager->update();
 
   double defaultCutoff = cutoff;
   if(_cutoff>=0) cutoff = _cutoff;
 
+  //nothing changed since the last query -> collisions are still valid
+  if(!moved && cutoff==cutoff_lastQuery) {
+    cutoff = defaultCutoff;
+    return;
+  }
+  self->manager->update();
+  cutoff_lastQuery = cutoff;
+
   collisions.clear();
   self->manager->collide(this, FclInterface_self::BroadphaseCallback);
+  if(self->statics) {
+    self->manager->collide(self->statics->manager.get(), this, FclInterface_self::BroadphaseCallback); //(only reads the static tree -> safe across concurrent copies)
+    if(cutoff==self->statics->cutoff) collisions.append(self->statics->collisions);
+    else self->statics->manager->collide(this, FclInterface_self::BroadphaseCallback);
+  }
   collisions.reshape(-1, 2);
 
   if(_cutoff>=0) cutoff = defaultCutoff;
 
-  X_lastQuery = X;
+  if(moved) X_lastQuery = X;
 }
 
 void FclInterface::addCollision(void* userData1, void* userData2) {
@@ -169,6 +250,8 @@ bool FclInterface_self::BroadphaseCallback(CollObject* o1, CollObject* o2, void*
 
 #else //RAI_FCL
 rai::FclInterface::FclInterface(const rai::Array<shared_ptr<Mesh>>& _geometries, double _cutoff) { NICO }
+rai::FclInterface::FclInterface(const FclInterface& base) { NICO }
 rai::FclInterface::~FclInterface() { NICO }
-void rai::FclInterface::step(const arr& X) { NICO }
+void rai::FclInterface::setStaticObjects(const uintA& ids, const arr& X) { NICO }
+void rai::FclInterface::step(const arr& X, double _cutoff) { NICO }
 #endif
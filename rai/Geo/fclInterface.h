@@ -18,10 +18,13 @@ struct FclInterface {
   double cutoff=0.; //0 -> perform fine boolean collision check; >0 -> perform fine distance computations; <0 -> only broadphase
   uintA collisions; //return values!
   arr X_lastQuery;  //memory to check whether an object has moved in consecutive queries
+  double cutoff_lastQuery=-2.; //(-2: no query yet) if neither objects nor cutoff changed, step() reuses the last collisions
 
   FclInterface(const Array<shared_ptr<Mesh>>& geometries, double _cutoff=0.);
+  FclInterface(const FclInterface& base); //shares the geometry models of base, but has own collision objects and broadphase manager -> can be stepped concurrently with base
   ~FclInterface();
 
+  void setStaticObjects(const uintA& ids, const arr& X); //moves these objects (at poses X) into a separate static broadphase (shared with later copies); static-static pairs are queried only once
   void step(const arr& X, double _cutoff=-1.);
 
 protected:
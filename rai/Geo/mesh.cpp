@@ -9,13 +9,17 @@
 #include "mesh.h"
 #include "qhull.h"
 #include "mesh_readAssimp.h"
+#include "signedDistanceFunctions.h"
 
 #include "../Algo/ann.h"
 #include "../Optim/newton.h"
 #include "../Core/graph.h"
+#include "../Core/thread.h"
 
 #include <limits>
 #include <algorithm>
+#include <map>
+#include <queue>
 #include <math.h>
 
 #ifdef RAI_PLY
@@ -23,6 +27,7 @@
 #endif
 
 #ifdef RAI_GL
+#  include "../Gui/opengl.h"
 #  include <GL/glew.h>
 #  include <GL/gl.h>
 #endif
@@ -62,6 +67,7 @@ Mesh::Mesh()
     parsing_pos_end(std::numeric_limits<long>::max())*/{}
 
 void Mesh::clear() {
+  revision++;
   V.clear(); Vn.clear();
   if(C.nd==2) C.clear();
   T.clear(); Tn.clear();
@@ -69,6 +75,7 @@ void Mesh::clear() {
 }
 
 void Mesh::setBox(bool edgesOnly) {
+  revision++;
   clear();
   double verts[24] = {
     -.5, -.5, -.5,
@@ -109,18 +116,21 @@ void Mesh::setBox(bool edgesOnly) {
 }
 
 void Mesh::setBox(const arr& lo, const arr& up, bool edgesOnly){
+  revision++;
   setBox(edgesOnly);
   scale(up-lo);
   translate(.5*(lo+up));
 }
 
 Mesh& Mesh::setDot() {
+  revision++;
   clear();
   V.resize(1, 3).setZero();
   return *this;
 }
 
 void Mesh::setLine(double l) {
+  revision++;
   clear();
   V.resize(2, 3).setZero();
   V(0, 2) = -.5*l;
@@ -128,6 +138,7 @@ void Mesh::setLine(double l) {
 }
 
 void Mesh::setQuad(double x_width, double y_width, const byteA& _texImg, bool flipY, bool texByReference){
+  revision++;
   clear();
   V = {
     -.5*x_width, -.5*y_width, 0,
@@ -157,6 +168,7 @@ void Mesh::setQuad(double x_width, double y_width, const byteA& _texImg, bool fl
 }
 
 void Mesh::setTetrahedron() {
+  revision++;
   clear();
   double s2=RAI_SQRT2/3., s6=sqrt(6.)/3.;
   double verts[12] = { 0., 0., 1., 2.*s2, 0., -1./3., -s2, s6, -1./3., -s2, -s6, -1./3. };
@@ -168,6 +180,7 @@ void Mesh::setTetrahedron() {
 }
 
 void Mesh::setOctahedron() {
+  revision++;
   clear();
   double verts[18] = {
     1, 0, 0,
@@ -188,6 +201,7 @@ void Mesh::setOctahedron() {
 }
 
 void Mesh::setDodecahedron() {
+  revision++;
   clear();
   double a = 1/sqrt(3.), b = sqrt((3.-sqrt(5.))/6.), c=sqrt((3.+sqrt(5.))/6.);
   double verts[60] = {
@@ -227,6 +241,7 @@ void Mesh::setDodecahedron() {
 }
 
 void Mesh::setSphere(uint fineness) {
+  revision++;
   setOctahedron();
 //  setDodecahedron();
 //  setTetrahedron();
@@ -238,6 +253,7 @@ void Mesh::setSphere(uint fineness) {
 }
 
 void Mesh::setHalfSphere(uint fineness) {
+  revision++;
   setOctahedron();
   V.resizeCopy(5, 3);
   T.resizeCopy(4, 3);
@@ -249,6 +265,7 @@ void Mesh::setHalfSphere(uint fineness) {
 }
 
 void Mesh::setCylinder(double r, double l, uint fineness) {
+  revision++;
   clear();
   uint div = 4 * (1 <<fineness);
   V.resize(2*div+2, 3);
@@ -287,6 +304,7 @@ void Mesh::setCylinder(double r, double l, uint fineness) {
 }
 
 void Mesh::setSSBox(double x_width, double y_width, double z_height, double r, uint fineness) {
+  revision++;
   CHECK(r>=0. && x_width>=2.*r && y_width>=2.*r && z_height>=2.*r, "width/height includes radius!");
   setSphere(fineness);
   scale(r sphereSweptFactor);
@@ -299,6 +317,7 @@ void Mesh::setSSBox(double x_width, double y_width, double z_height, double r, u
 }
 
 void Mesh::setCapsule(double r, double l, uint fineness) {
+  revision++;
   uint i;
   setSphere(fineness);
   scale(r);
@@ -310,6 +329,7 @@ void Mesh::setCapsule(double r, double l, uint fineness) {
   Array, the elements of which are indices referring to vertices in
   the vertex list (V) */
 void Mesh::setGrid(uint X, uint Y) {
+  revision++;
   CHECK(X>1 && Y>1, "grid has to be at least 2x2");
   CHECK_EQ(V.d0, X*Y, "don't have X*Y mesh-vertices to create grid faces");
   uint i, j, k=T.d0;
@@ -325,6 +345,7 @@ void Mesh::setGrid(uint X, uint Y) {
 }
 
 Mesh& Mesh::setRandom(uint vertices) {
+  revision++;
   clear();
   V.resize(vertices, 3);
   rndUniform(V, -1., 1.);
@@ -335,6 +356,7 @@ Mesh& Mesh::setRandom(uint vertices) {
 }
 
 void Mesh::subDivide() {
+  revision++;
   uint v=V.d0, t=T.d0;
   V.resizeCopy(v+3*t, 3);
   uintA newT(4*t, 3);
@@ -355,6 +377,7 @@ void Mesh::subDivide() {
 }
 
 void Mesh::subDivide(uint i) {
+  revision++;
   uint v=V.d0, t=T.d0;
   V.resizeCopy(v+3, 3);
   T.resizeCopy(t+3, 3);
@@ -369,28 +392,33 @@ void Mesh::subDivide(uint i) {
   T(t, 0)=v+2; T(t, 1)=v+1; T(t, 2)=c;   t++;
 }
 
-void Mesh::scale(double s) {  V *= s; }
+void Mesh::scale(double s) {  revision++;  V *= s; }
 
 void Mesh::scale(double sx, double sy, double sz) {
+  revision++;
   uint i;
   for(i=0; i<V.d0; i++) {  V(i, 0)*=sx;  V(i, 1)*=sy;  V(i, 2)*=sz;  }
 }
 
 void Mesh::scale(const arr& s){
+  revision++;
   scale(s.elem(0), s.elem(1), s.elem(2));
 }
 
 void Mesh::translate(double dx, double dy, double dz) {
+  revision++;
   uint i;
   for(i=0; i<V.d0; i++) {  V(i, 0)+=dx;  V(i, 1)+=dy;  V(i, 2)+=dz;  }
 }
 
 void Mesh::translate(const arr& d) {
+  revision++;
   CHECK_EQ(d.N, 3, "");
   translate(d.elem(0), d.elem(1), d.elem(2));
 }
 
 void Mesh::transform(const Transformation& t) {
+  revision++;
   t.applyOnPointArray(V);
 }
 
@@ -401,6 +429,7 @@ Vector Mesh::center() {
 }
 
 void Mesh::box() {
+  revision++;
   double x, X, y, Y, z, Z, m;
   x=X=V(0, 0);
   y=Y=V(0, 1);
@@ -421,6 +450,7 @@ void Mesh::box() {
 }
 
 void Mesh::addMesh(const Mesh& mesh2, const Transformation& X) {
+  revision++;
   uint n=V.d0, tn=tex.d0, t=T.d0, tt=Tt.d0;
   if(V.N==C.N){
     if(mesh2.V.N==mesh2.C.N) C.append(mesh2.C);
@@ -451,6 +481,7 @@ void Mesh::addMesh(const Mesh& mesh2, const Transformation& X) {
 }
 
 void Mesh::addConvex(const arr& points, const arr& color){
+  revision++;
   Mesh sub;
   sub.V = getHull(points, sub.T);
   if(!!color) sub.C = color;
@@ -459,6 +490,7 @@ void Mesh::addConvex(const arr& points, const arr& color){
 }
 
 void Mesh::makeConvexHull() {
+  revision++;
   if(V.d0<=1) return;
 #if 1
   V = getHull(V, T);
@@ -494,6 +526,7 @@ void Mesh::makeConvexHull() {
 }
 
 void Mesh::makeTriangleFan() {
+  revision++;
   T.clear();
   for(uint i=1; i+1<V.d0; i++) {
     T.append(uintA{0, i, i+1});
@@ -503,6 +536,7 @@ void Mesh::makeTriangleFan() {
 }
 
 void Mesh::makeLines() {
+  revision++;
   T.resize(V.d0-1, 2);
 //  T[0] = {V.d0-1, 0};
   for(uint i=1; i<V.d0; i++) {
@@ -561,6 +595,7 @@ uint Mesh::getComponents(){
 }
 
 void Mesh::setSSCvx(const arr& core, double r, uint fineness) {
+  revision++;
   if(r>0.) {
     Mesh ball;
     ball.setSphere(fineness);
@@ -739,6 +774,7 @@ void permuteVertices(Mesh& m, uintA& p) {
 /** @brief delete all void triangles (with vertex indices (0, 0, 0)) and void
   vertices (not used for triangles or strips) */
 void Mesh::deleteUnusedVertices() {
+  revision++;
   if(!V.N) return;
   uintA p;
   uintA u;
@@ -770,6 +806,7 @@ bool COMP(uint i, uint j) {
 /** @brief delete all void triangles (with vertex indices (0, 0, 0)) and void
   vertices (not used for triangles or strips) */
 void Mesh::fuseNearVertices(double tol) {
+  revision++;
   if(!V.N) return;
   uintA p;
   uint i, j;
@@ -817,6 +854,7 @@ void Mesh::fuseNearVertices(double tol) {
 }
 
 void Mesh::deleteVertices(uintA& delLabels){
+  revision++;
   CHECK_EQ(delLabels.N, V.d0, "");
   uintA p;
   p.setStraightPerm(V.d0);
@@ -859,6 +897,7 @@ void getTriNormals(const Mesh& m, arr& Tn) {
 
 /// flips all faces
 void Mesh::flipFaces() {
+  revision++;
   uint i, a;
   for(i=0; i<T.d0; i++) {
     a=T(i, 0);
@@ -867,8 +906,201 @@ void Mesh::flipFaces() {
   }
 }
 
+namespace {
+/// symmetric 4x4 error quadric (Garland & Heckbert), stored as its upper triangle
+struct Quadric {
+  double q[10];
+  Quadric() { memset(q, 0, sizeof(q)); }
+  void addPlane(double a, double b, double c, double d, double w) {
+    q[0]+=w*a*a; q[1]+=w*a*b; q[2]+=w*a*c; q[3]+=w*a*d;
+    q[4]+=w*b*b; q[5]+=w*b*c; q[6]+=w*b*d;
+    q[7]+=w*c*c; q[8]+=w*c*d;
+    q[9]+=w*d*d;
+  }
+  void operator+=(const Quadric& Q) { for(uint i=0; i<10; i++) q[i]+=Q.q[i]; }
+  double error(const Vector& x) const {
+    return q[0]*x.x*x.x + 2.*q[1]*x.x*x.y + 2.*q[2]*x.x*x.z + 2.*q[3]*x.x
+           + q[4]*x.y*x.y + 2.*q[5]*x.y*x.z + 2.*q[6]*x.y
+           + q[7]*x.z*x.z + 2.*q[8]*x.z
+           + q[9];
+  }
+  /// the point minimizing the error; false if the quadric is (near) singular
+  bool optimum(Vector& x) const {
+    double a=q[0], b=q[1], c=q[2], d=q[4], e=q[5], f=q[7];
+    double A=d*f-e*e, B=c*e-b*f, C=b*e-c*d;
+    double det = a*A + b*B + c*C;
+    if(fabs(det)<1e-12*(fabs(a)+fabs(d)+fabs(f)+1e-20)*(a*a+d*d+f*f)) return false;
+    double D=a*f-c*c, E=b*c-a*e, F=a*d-b*b;
+    x.set(-(A*q[3] + B*q[6] + C*q[8])/det,
+          -(B*q[3] + D*q[6] + E*q[8])/det,
+          -(C*q[3] + E*q[6] + F*q[8])/det);
+    return true;
+  }
+};
+
+struct Collapse {
+  double cost;
+  uint a, b, stampA, stampB;
+  Vector x;
+  bool operator<(const Collapse& c) const { return cost>c.cost; } //min-heap
+};
+}
+
+void Mesh::decimate(uint targetTris, double maxError) {
+  revision++;
+  if(!T.d0 || (T.d0<=targetTris && maxError<0.)) return;
+  CHECK_EQ(T.d1, 3, "decimation requires a triangle mesh");
+
+  //-- weld exact vertex duplicates (as in imported, flat-shaded meshes); connectivity is needed below
+  {
+    std::map<std::tuple<double, double, double>, uint> unique;
+    uintA p(V.d0);
+    for(uint i=0; i<V.d0; i++) p(i) = unique.emplace(std::make_tuple(V(i, 0), V(i, 1), V(i, 2)), i).first->second;
+    for(uint& t:T) t = p(t);
+  }
+
+  //-- per-vertex triangle lists and quadrics of the (area weighted) triangle planes
+  uint nV=V.d0;
+  std::vector<std::vector<uint>> vertTris(nV);
+  std::vector<Quadric> Q(nV);
+  boolA triDead(T.d0);
+  triDead.setZero();
+  uint nT=0;
+  auto vert = [&](uint i) { return Vector(&V(i, 0)); };
+  for(uint t=0; t<T.d0; t++) {
+    uint a=T(t, 0), b=T(t, 1), c=T(t, 2);
+    if(a==b || b==c || a==c) { triDead(t)=true; continue; }
+    Vector n = (vert(b)-vert(a)) ^ (vert(c)-vert(a));
+    double area = n.length();
+    if(area>1e-20) {
+      n /= area;
+      Quadric K;
+      K.addPlane(n.x, n.y, n.z, -(n*vert(a)), .5*area);
+      Q[a]+=K; Q[b]+=K; Q[c]+=K;
+    }
+    for(uint j=0; j<3; j++) vertTris[T(t, j)].push_back(t);
+    nT++;
+  }
+
+  //-- boundary edges get a (heavily weighted) perpendicular plane, so that borders are preserved
+  {
+    std::map<std::pair<uint, uint>, int> edges;
+    for(uint t=0; t<T.d0; t++) if(!triDead(t)) for(uint j=0; j<3; j++) {
+          uint a=T(t, j), b=T(t, (j+1)%3);
+          edges[{rai::MIN(a, b), rai::MAX(a, b)}] += (a<b ? 1 : -1);
+        }
+    for(auto& e:edges) if(e.second) { //unmatched orientation -> boundary
+        uint a=e.first.first, b=e.first.second, t=0;
+        for(uint tt:vertTris[a]) if(T(tt, 0)==b || T(tt, 1)==b || T(tt, 2)==b) { t=tt; break; }
+        Vector edge = vert(b)-vert(a);
+        Vector n = (vert(T(t, 1))-vert(T(t, 0))) ^ (vert(T(t, 2))-vert(T(t, 0)));
+        Vector m = edge ^ n;
+        double len = m.length();
+        if(len<1e-20) continue;
+        m /= len;
+        Quadric K;
+        K.addPlane(m.x, m.y, m.z, -(m*vert(a)), 1e3*edge.lengthSqr());
+        Q[a]+=K; Q[b]+=K;
+      }
+  }
+
+  //-- candidate collapses
+  uintA stamp(nV);
+  stamp.setZero();
+  boolA vertDead(nV);
+  vertDead.setZero();
+  std::priority_queue<Collapse> heap;
+  auto pushCollapse = [&](uint a, uint b) {
+    Quadric K=Q[a];
+    K+=Q[b];
+    Collapse c;
+    c.a=a; c.b=b; c.stampA=stamp(a); c.stampB=stamp(b);
+    if(!K.optimum(c.x)) { //pick the best of the end and mid points
+      Vector cand[3] = {vert(a), vert(b), .5*(vert(a)+vert(b))};
+      c.x = cand[0];
+      for(uint i=1; i<3; i++) if(K.error(cand[i])<K.error(c.x)) c.x=cand[i];
+    }
+    c.cost = K.error(c.x);
+    heap.push(c);
+  };
+  auto neighbors = [&](uintA& N, uint a) {
+    N.clear();
+    for(uint t:vertTris[a]) if(!triDead(t)) for(uint j=0; j<3; j++) if(T(t, j)!=a) N.setAppend(T(t, j));
+  };
+  uintA Na, Nb;
+  for(uint a=0; a<nV; a++) {
+    neighbors(Na, a);
+    for(uint b:Na) if(a<b) pushCollapse(a, b);
+  }
+
+  //-- collapse edges in order of their error
+  while(nT>targetTris && heap.size()) {
+    Collapse c = heap.top();
+    heap.pop();
+    uint a=c.a, b=c.b;
+    if(vertDead(a) || vertDead(b) || stamp(a)!=c.stampA || stamp(b)!=c.stampB) continue; //outdated
+    if(maxError>=0. && c.cost>maxError) break;
+
+    //link condition: common neighbors must be exactly the opposite vertices of the shared triangles
+    neighbors(Na, a);
+    neighbors(Nb, b);
+    uint common=0, shared=0;
+    for(uint v:Na) if(Nb.contains(v)) common++;
+    for(uint t:vertTris[a]) if(!triDead(t) && (T(t, 0)==b || T(t, 1)==b || T(t, 2)==b)) shared++;
+    if(common!=shared) continue;
+
+    //reject collapses that flip a triangle
+    bool flip=false;
+    for(uint v:{a, b}) for(uint t:vertTris[v]) {
+        if(triDead(t) || flip) continue;
+        uint i=T(t, 0), j=T(t, 1), k=T(t, 2);
+        bool hasA = (i==a || j==a || k==a), hasB = (i==b || j==b || k==b);
+        if(hasA && hasB) continue; //this triangle is removed by the collapse
+        Vector x[3] = {vert(i), vert(j), vert(k)};
+        Vector n0 = (x[1]-x[0]) ^ (x[2]-x[0]);
+        for(uint l=0; l<3; l++) if(T(t, l)==v) x[l]=c.x;
+        Vector n1 = (x[1]-x[0]) ^ (x[2]-x[0]);
+        if(n0*n1 <= .1*n0.length()*n1.length()) flip=true;
+      }
+    if(flip) continue;
+
+    //collapse b into a
+    V(a, 0)=c.x.x;  V(a, 1)=c.x.y;  V(a, 2)=c.x.z;
+    Q[a]+=Q[b];
+    for(uint t:vertTris[b]) {
+      if(triDead(t)) continue;
+      if(T(t, 0)==a || T(t, 1)==a || T(t, 2)==a) { triDead(t)=true; nT--; continue; }
+      for(uint l=0; l<3; l++) if(T(t, l)==b) T(t, l)=a;
+      vertTris[a].push_back(t);
+    }
+    vertTris[b].clear();
+    vertDead(b)=true;
+    stamp(a)++; //invalidates all queued collapses of a; only those change cost
+    neighbors(Na, a);
+    for(uint v:Na) pushCollapse(a, v);
+  }
+
+  //-- compact
+  uint n=0;
+  for(uint t=0; t<T.d0; t++) if(!triDead(t)) {
+      if(Tt.d0==T.d0) for(uint j=0; j<3; j++) Tt(n, j) = Tt(t, j);
+      for(uint j=0; j<3; j++) T(n, j) = T(t, j);
+      n++;
+    }
+  T.resizeCopy(n, 3);
+  if(Tt.d0) Tt.resizeCopy(n, 3);
+  Vn.clear();
+  Tn.clear();
+  graph.clear();
+  ann.reset();
+  uint nC=C.d0;
+  deleteUnusedVertices();
+  if(nC==nV) C.resizeCopy(V.d0, 3);
+}
+
 /// check whether this is really a closed mesh, and flip inconsistent faces
 void Mesh::clean() {
+  revision++;
   uint i, j, idist=0;
   Vector a, b, c, m;
   double mdist=0.;
@@ -1277,6 +1509,7 @@ void Mesh::writeTriFile(const char* filename) {
 }
 
 void Mesh::readTriFile(std::istream& is) {
+  revision++;
   uint i, nV, nT;
   is >>PARSE("TRI") >>nV >>nT;
   V.resize(nV, 3);
@@ -1295,6 +1528,7 @@ void Mesh::writeOffFile(const char* filename) {
 }
 
 void Mesh::readOffFile(std::istream& is) {
+  revision++;
   uint i, k, nVertices, nFaces, nEdges, alpha;
   bool color;
   String tag;
@@ -1319,6 +1553,7 @@ void Mesh::readOffFile(std::istream& is) {
 }
 
 void Mesh::readPlyFile(std::istream& is) {
+  revision++;
   uint i, k, nVertices, nFaces;
   String str;
   is >>PARSE("ply") >>PARSE("format") >>str;
@@ -1425,6 +1660,7 @@ bool ply_check_property(PlyElement* elem, const char* prop_name) {
 }
 
 void Mesh::readPLY(const char* fn) {
+  revision++;
   struct PlyFace {    unsigned char nverts;  int* verts; };
   struct Vertex {    double x,  y,  z ;  byte r, g, b; };
   uint _nverts=0, _ntrigs=0;
@@ -1536,6 +1772,7 @@ void Mesh::writeArr(std::ostream& os) {
 }
 
 void Mesh::readArr(std::istream& is) {
+  revision++;
   Graph G(is);
   G.get(V, "V");
   G.get(T, "T");
@@ -1546,6 +1783,7 @@ void Mesh::readArr(std::istream& is) {
 }
 
 void Mesh::readPts(std::istream& is) {
+  revision++;
   floatA pts;
   pts.read(is);
   if(pts.d1==3){
@@ -1604,12 +1842,37 @@ uintA getSubMeshPositions(const char* filename) {
 
 #ifdef RAI_GL
 
-/// GL routine to draw a Mesh
-void Mesh::glDraw(struct OpenGL& gl) {
-  GLboolean lightingEnabled=true;
-  glGetBooleanv(GL_LIGHTING, &lightingEnabled);
+/// GL vertex/index buffers of a mesh, living in the context of one OpenGL
+struct MeshGLBuffers {
+  std::weak_ptr<OpenGLReleasedBuffers> owner; //(expires with the OpenGL, and its context with all buffers)
+  GLuint vbo=0, ibo=0;
+  size_t normalOffset=0, colorOffset=0;
+  bool hasColors=false;
+  uint64_t signature=0;
+
+  ~MeshGLBuffers() {
+    std::shared_ptr<OpenGLReleasedBuffers> o = owner.lock();
+    if(!o) return;
+    auto lock = o->mutex(RAI_HERE); //we can't delete here: the owner's context is likely not current
+    o->buffers.push_back(vbo);
+    o->buffers.push_back(ibo);
+  }
+};
 
-  if(glDrawOptions(gl).drawColors) {
+/// identifies the geometry uploaded to buffers: the mesh revision and the array locations and sizes (O(1) per draw)
+static uint64_t glBufferSignature(const Mesh& m) {
+  uint64_t h=14695981039346656037ull;
+  auto mix = [&h](uint64_t x) { h ^= x; h *= 1099511628211ull; };
+  mix(m.revision);
+  for(const arr* a: {&m.V, &m.Vn, &m.C}) { mix((uint64_t)a->p); mix(a->N); }
+  mix((uint64_t)m.T.p);
+  mix(m.T.N);
+  return h;
+}
+
+static void glSetMeshColor(const Mesh& m, OpenGL& gl, bool lightingEnabled) {
+  const arr& C = m.C;
+  if(GLDrawer::glDrawOptions(gl).drawColors) {
     if(C.nd==1) {
       CHECK(C.N>=1 && C.N<=4, "need a basic color");
       GLfloat col[4];
@@ -1626,6 +1889,95 @@ void Mesh::glDraw(struct OpenGL& gl) {
       else glColor4fv(col);
     }
   }
+}
+
+/// binds (and if needed first uploads) vertex, normal, color and index buffers for triangle meshes without texture coordinates
+bool Mesh::glBindBuffers(OpenGL& gl) {
+  if(!glDrawOptions(gl).meshBuffers || !glGenBuffers) return false; //(GLEW not initialized)
+  if(!T.N || T.d1!=3 || tex.N) return false;
+  GLboolean lightingEnabled=true;
+  glGetBooleanv(GL_LIGHTING, &lightingEnabled);
+  bool drawColors = glDrawOptions(gl).drawColors;
+  if(drawColors && C.nd==2 && C.d0==V.d0 && lightingEnabled) return false; //vertex colors with lighting -> drawn vertex-wise
+  if(V.d0!=Vn.d0 || T.d0!=Tn.d0) computeNormals();
+
+  std::shared_ptr<OpenGLReleasedBuffers> owner = gl.releasedBuffers;
+  uint64_t signature = glBufferSignature(*this);
+  if(!glBuffers || glBuffers->owner.lock()!=owner || glBuffers->signature!=signature) {
+    if(glBuffers && glBuffers->owner.lock() && glBuffers->owner.lock()!=owner) return false; //buffers live in another (existing) context -> don't thrash
+    //(a new buffer object, as copies of this mesh may still share the old one)
+    glBuffers = make_shared<MeshGLBuffers>();
+    MeshGLBuffers& B = *glBuffers;
+    B.owner = owner;
+    B.signature = signature;
+    B.hasColors = (C.N==V.N);
+    floatA data(V.N*(B.hasColors?3:2));
+    for(uint i=0; i<V.N; i++) { data.elem(i)=V.elem(i); data.elem(V.N+i)=Vn.elem(i); }
+    if(B.hasColors) for(uint i=0; i<V.N; i++) data.elem(2*V.N+i)=C.elem(i);
+    B.normalOffset = V.N*sizeof(float);
+    B.colorOffset = 2*V.N*sizeof(float);
+    glGenBuffers(1, &B.vbo);
+    glGenBuffers(1, &B.ibo);
+    glBindBuffer(GL_ARRAY_BUFFER, B.vbo);
+    glBufferData(GL_ARRAY_BUFFER, data.N*sizeof(float), data.p, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, B.ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, T.N*sizeof(uint), T.p, GL_STATIC_DRAW);
+  } else {
+    glBindBuffer(GL_ARRAY_BUFFER, glBuffers->vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, glBuffers->ibo);
+  }
+
+  glShadeModel(GL_SMOOTH);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_NORMAL_ARRAY);
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glVertexPointer(3, GL_FLOAT, 0, (void*)0);
+  glNormalPointer(GL_FLOAT, 0, (void*)glBuffers->normalOffset);
+  if(drawColors && glBuffers->hasColors) {
+    glEnableClientState(GL_COLOR_ARRAY);
+    glPushAttrib(GL_ENABLE_BIT); //(restored in glUnbindBuffers)
+    glDisable(GL_LIGHTING); //because lighting requires ambiance colors to be set..., not just color..
+    glColorPointer(3, GL_FLOAT, 0, (void*)glBuffers->colorOffset);
+  } else {
+    glDisableClientState(GL_COLOR_ARRAY);
+  }
+  return true;
+}
+
+void Mesh::glUnbindBuffers(OpenGL& gl) {
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  if(glDrawOptions(gl).drawColors && glBuffers->hasColors) {
+    glDisableClientState(GL_COLOR_ARRAY);
+    glPopAttrib(); //(the lighting state before glBindBuffers)
+  }
+}
+
+void Mesh::glDrawInstances(OpenGL& gl, const rai::Array<Transformation>& poses, const std::function<void(uint)>& beginInstance, const std::function<void(uint)>& endInstance) {
+  double GLmatrix[16];
+  bool buffers = glBindBuffers(gl);
+  if(buffers) {
+    GLboolean lightingEnabled=true;
+    glGetBooleanv(GL_LIGHTING, &lightingEnabled);
+    glSetMeshColor(*this, gl, lightingEnabled);
+  }
+  for(uint i=0; i<poses.N; i++) {
+    if(beginInstance) beginInstance(i);
+    poses(i).getAffineMatrixGL(GLmatrix);
+    glLoadMatrixd(GLmatrix);
+    if(buffers) glDrawElements(GL_TRIANGLES, T.N, GL_UNSIGNED_INT, (void*)0);
+    else glDraw(gl);
+    if(endInstance) endInstance(i);
+  }
+  if(buffers) glUnbindBuffers(gl);
+}
+
+/// GL routine to draw a Mesh
+void Mesh::glDraw(struct OpenGL& gl) {
+  GLboolean lightingEnabled=true;
+  glGetBooleanv(GL_LIGHTING, &lightingEnabled);
+
+  glSetMeshColor(*this, gl, lightingEnabled);
 
   if(!T.N) { //-- draw point cloud
     if(!V.N) return;
@@ -1733,6 +2085,12 @@ void Mesh::glDraw(struct OpenGL& gl) {
 
   //-- draw the mesh
   if((!C.N || C.nd==1 || !glDrawOptions(gl).drawColors || (C.d0==V.d0 && !lightingEnabled))  //we have colors for each vertex
+      && (!tex.N || !Tt.N) && glBindBuffers(gl)) { //retained mode: cached buffers
+
+    glDrawElements(GL_TRIANGLES, T.N, GL_UNSIGNED_INT, (void*)0);
+    glUnbindBuffers(gl);
+
+  } else if((!C.N || C.nd==1 || !glDrawOptions(gl).drawColors || (C.d0==V.d0 && !lightingEnabled))  //we have colors for each vertex
       && (!tex.N || !Tt.N)) { //we have no tex or tex coords for each vertex -> use index arrays
 
     //  glShadeModel(GL_FLAT);
@@ -1850,6 +2208,9 @@ void Mesh::glDraw(struct OpenGL& gl) {
 #else //RAI_GL
 
 void Mesh::glDraw(struct OpenGL&) { NICO }
+void Mesh::glDrawInstances(struct OpenGL&, const rai::Array<Transformation>&, const std::function<void(uint)>&, const std::function<void(uint)>&) { NICO }
+bool Mesh::glBindBuffers(struct OpenGL&) { return false; }
+void Mesh::glUnbindBuffers(struct OpenGL&) {}
 void glDrawMesh(void*) { NICO }
 void glTransform(const Transformation&) { NICO }
 #endif
@@ -1979,92 +2340,226 @@ double GJK_distance(Mesh& mesh1, Mesh& mesh2,
 
 #ifdef RAI_Lewiner
 
-void Mesh::setImplicitSurface(const ScalarFunction& f, double lo, double hi, uint res) {
-  setImplicitSurface(f, lo, hi, lo, hi, lo, hi, res);
+namespace {
+uint numImplicitSurfaceSlabs(uint jobs) {
+  uint n = ThreadPool::global().size()+1;
+  if(n>jobs) n=jobs;
+  return n ? n : 1;
 }
 
-void Mesh::setImplicitSurface(const ScalarFunction& f, double xLo, double xHi, double yLo, double yHi, double zLo, double zHi, uint res) {
-  MarchingCubes mc(res, res, res);
+/* runs marching cubes on the slab k0..k1 (last grid index) of gridValues and returns vertices in grid coordinates */
+void marchingCubesSlab(arr& V, uintA& T, const arr& gridValues, uint k0, uint k1) {
+  uint d0=gridValues.d0, d1=gridValues.d1, d2=gridValues.d2;
+  MarchingCubes mc(d0, d1, k1-k0+1);
   mc.init_all() ;
-
-  //compute data
-  uint k=0, j=0, i=0;
-  float x, y, z;
-  for(k=0; k<res; k++) {
-    z = zLo+k*(zHi-zLo)/res;
-    for(j=0; j<res; j++) {
-      y = yLo+j*(yHi-yLo)/res;
-      for(i=0; i<res; i++) {
-        x = xLo+i*(xHi-xLo)/res;
-        mc.set_data(f(NoArr, NoArr, arr{(double)x, (double)y, (double)z}), i, j, k) ;
+  //transposing copy (Lewiner's data runs in x first), tiled over 8 x-rows to keep reads and writes cache friendly
+  for(uint i0=0; i0<d0; i0+=8) for(uint j=0; j<d1; j++) for(uint k=k0; k<=k1; k++) {
+        for(uint i=i0; i<d0 && i<i0+8; i++) mc.set_data(gridValues.p[(i*d1+j)*d2+k], i, j, k-k0);
       }
-    }
-  }
 
   mc.run();
   mc.clean_temps();
 
-  //convert to Mesh
-  clear();
   V.resize(mc.nverts(), 3);
   T.resize(mc.ntrigs(), 3);
-  for(i=0; i<V.d0; i++) {
-    V(i, 0)=xLo+mc.vert(i)->x*(xHi-xLo)/res;
-    V(i, 1)=yLo+mc.vert(i)->y*(yHi-yLo)/res;
-    V(i, 2)=zLo+mc.vert(i)->z*(zHi-zLo)/res;
+  for(uint i=0; i<V.d0; i++) {
+    V(i, 0)=mc.vert(i)->x;
+    V(i, 1)=mc.vert(i)->y;
+    V(i, 2)=mc.vert(i)->z + k0;
   }
-  for(i=0; i<T.d0; i++) {
+  for(uint i=0; i<T.d0; i++) {
     T(i, 0)=mc.trig(i)->v1;
     T(i, 1)=mc.trig(i)->v2;
     T(i, 2)=mc.trig(i)->v3;
   }
 }
+}
+
+void Mesh::setImplicitSurface(const ScalarFunction& f, double lo, double hi, uint res) {
+  revision++;
+  setImplicitSurface(f, lo, hi, lo, hi, lo, hi, res);
+}
+
+void Mesh::setImplicitSurface(const ScalarFunction& f, double xLo, double xHi, double yLo, double yHi, double zLo, double zHi, uint res) {
+  revision++;
+  arr lo = {xLo, yLo, zLo};
+  arr step = {(xHi-xLo)/res, (yHi-yLo)/res, (zHi-zLo)/res};
+  arr gridValues(res, res, res);
+  arr x(3);
+  for(uint i=0; i<res; i++) for(uint j=0; j<res; j++) for(uint k=0; k<res; k++) {
+        x.p[0] = lo.p[0]+i*step.p[0];
+        x.p[1] = lo.p[1]+j*step.p[1];
+        x.p[2] = lo.p[2]+k*step.p[2];
+        gridValues(i, j, k) = f(NoArr, NoArr, x);
+      }
+  setImplicitSurface(gridValues, lo, lo+double(res-1)*step);
+}
+
+void Mesh::setImplicitSurface(SDF& f, double lo, double hi, uint res, bool adaptive) {
+  revision++;
+  setImplicitSurface(f, lo, hi, lo, hi, lo, hi, res, adaptive);
+}
+
+void Mesh::setImplicitSurface(SDF& f, double xLo, double xHi, double yLo, double yHi, double zLo, double zHi, uint res, bool adaptive) {
+  revision++;
+  //same sampling as the ScalarFunction version, but evaluated batch-wise in parallel x-slabs
+  arr lo = {xLo, yLo, zLo};
+  arr step = {(xHi-xLo)/res, (yHi-yLo)/res, (zHi-zLo)/res};
+  arr gridValues(res, res, res);
+
+  //-- adaptive: evaluate the centers of blocks of B^3 cells first; blocks whose center distance exceeds
+  //   the block's half diagonal cannot contain the surface (assuming f is a distance), and their samples
+  //   are filled with the center value instead of being evaluated
+  const uint B=8, nb=(res-1+B-1)/B;
+  auto blockEnd = [&](uint b) { return std::min((b+1)*B, res-1); };
+  auto blockOf = [&](uint i) { return std::min(i/B, nb-1); };
+  byteA needed;
+  arr blockValues;
+  if(adaptive && nb>1) {
+    arr C(nb*nb*nb, 3), radius(nb*nb*nb);
+    uint b=0;
+    for(uint b0=0; b0<nb; b0++) for(uint b1=0; b1<nb; b1++) for(uint b2=0; b2<nb; b2++) {
+          uint bi[3] = {b0, b1, b2};
+          double r2=0.;
+          for(uint a=0; a<3; a++) {
+            double from=bi[a]*B, to=blockEnd(bi[a]);
+            C(b, a) = lo(a) + .5*(from+to)*step(a);
+            r2 += rai::sqr(.5*(to-from)*step(a));
+          }
+          radius(b++) = sqrt(r2) + sqrt(sumOfSqr(step)); //one voxel margin
+        }
+    f.evalBatch(blockValues, NoArr, C);
+
+    needed.resize(res, res, res).setZero();
+    b=0;
+    for(uint b0=0; b0<nb; b0++) for(uint b1=0; b1<nb; b1++) for(uint b2=0; b2<nb; b2++) {
+          if(fabs(blockValues(b)) <= radius(b)) {
+            for(uint i=b0*B; i<=blockEnd(b0); i++) for(uint j=b1*B; j<=blockEnd(b1); j++) for(uint k=b2*B; k<=blockEnd(b2); k++) {
+                  needed(i, j, k)=1;
+                }
+          }
+          b++;
+        }
+  }
+
+  //-- evaluate the (needed) grid samples, one x-slab per batch; each task runs a chunk of slabs with one sample buffer
+  uint grain = parallel_grain(res, 0, ThreadPool::global());
+  parallel_for(0, (res+grain-1)/grain, [&](uint c) {
+    arr X(res*res, 3), Xn, y;
+    uintA idx(res*res);
+    for(uint i=c*grain; i<res && i<(c+1)*grain; i++) {
+      uint n=0;
+      for(uint j=0; j<res; j++) for(uint k=0; k<res; k++) {
+          if(needed.N && !needed(i, j, k)) {
+            uint b = (blockOf(i)*nb + blockOf(j))*nb + blockOf(k);
+            gridValues(i, j, k) = blockValues(b);
+            continue;
+          }
+          double* x = X.p+3*n;
+          x[0] = lo.p[0]+i*step.p[0];
+          x[1] = lo.p[1]+j*step.p[1];
+          x[2] = lo.p[2]+k*step.p[2];
+          idx(n++) = j*res+k;
+        }
+      if(!n) continue;
+      Xn.referToRange(X, 0, n-1);
+      f.evalBatch(y, NoArr, Xn);
+      double* slab = gridValues.p+i*res*res;
+      for(uint l=0; l<n; l++) slab[idx(l)] = y.p[l];
+    }
+  }, 1);
+
+  if(!needed.N) {
+    setImplicitSurface(gridValues, lo, lo+double(res-1)*step);
+    return;
+  }
+
+  //-- adaptive: only the bounding box of the needed samples is handed to marching cubes
+  uintA a={res, res, res}, b={0, 0, 0};
+  for(uint i=0; i<res; i++) for(uint j=0; j<res; j++) for(uint k=0; k<res; k++) if(needed(i, j, k)) {
+          uint idx[3] = {i, j, k};
+          for(uint d=0; d<3; d++) { if(idx[d]<a(d)) a(d)=idx[d];  if(idx[d]>b(d)) b(d)=idx[d]; }
+        }
+  if(a(0)>b(0)) { clear(); return; }
+  arr crop(b(0)-a(0)+1, b(1)-a(1)+1, b(2)-a(2)+1);
+  for(uint i=0; i<crop.d0; i++) for(uint j=0; j<crop.d1; j++) {
+      memmove(&crop(i, j, 0), &gridValues(a(0)+i, a(1)+j, a(2)), crop.d2*crop.sizeT);
+    }
+  arr cropLo = lo + step%rai::convert<double>(a);
+  setImplicitSurface(crop, cropLo, cropLo + step%rai::convert<double>(b-a));
+}
 
 void Mesh::setImplicitSurface(const floatA& gridValues, const arr& lo, const arr& hi){
+  revision++;
   arr D;
   copy(D,gridValues);
   setImplicitSurface(D, lo, hi);
 }
 
 void Mesh::setImplicitSurface(const arr& gridValues, const arr& lo, const arr& hi){
+  revision++;
   CHECK_EQ(gridValues.nd, 3, "");
 
-  MarchingCubes mc(gridValues.d0, gridValues.d1, gridValues.d2);
-  mc.init_all() ;
-  uint k=0, j=0, i=0;
-  for(k=0; k<gridValues.d2; k++) {
-    for(j=0; j<gridValues.d1; j++) {
-      for(i=0; i<gridValues.d0; i++) {
-        mc.set_data(gridValues(i,j,k), i, j, k) ;
+  //-- split the last grid axis into slabs (sharing their boundary plane) and run marching cubes on each in parallel
+  uint d2=gridValues.d2;
+  uint numSlabs = numImplicitSurfaceSlabs((d2-1)/16);
+  uintA from(numSlabs+1);
+  for(uint s=0; s<=numSlabs; s++) from(s) = (s*(d2-1))/numSlabs;
+  rai::Array<arr> slabV(numSlabs);
+  rai::Array<uintA> slabT(numSlabs);
+  parallel_for(0, numSlabs, [&](uint s) { marchingCubesSlab(slabV(s), slabT(s), gridValues, from(s), from(s+1)); }, 1);
+
+  //-- merge: vertices on a seam plane were created identically by both neighboring slabs and are welded
+  clear();
+  uint nV=0, nT=0;
+  for(uint s=0; s<numSlabs; s++) { nV += slabV(s).d0; nT += slabT(s).d0; }
+  V.resize(nV, 3);
+  T.resize(nT, 3);
+  nV=nT=0;
+  std::map<std::pair<double, double>, uint> seam;
+  uintA map;
+  for(uint s=0; s<numSlabs; s++) {
+    const arr& Vs = slabV(s);
+    map.resize(Vs.d0);
+    double seamLo=from(s), seamHi=from(s+1);
+    for(uint i=0; i<Vs.d0; i++) {
+      const double* v = &Vs(i, 0);
+      if(s>0 && v[2]==seamLo) {
+        auto it = seam.find({v[0], v[1]});
+        CHECK(it!=seam.end(), "seam vertex of slab " <<s <<" has no counterpart");
+        map(i) = it->second;
+        continue;
       }
+      map(i) = nV;
+      memmove(&V(nV, 0), v, 3*V.sizeT);
+      nV++;
+    }
+    if(s>0) seam.clear();
+    if(s+1<numSlabs) for(uint i=0; i<Vs.d0; i++) if(Vs(i, 2)==seamHi) seam[{Vs(i, 0), Vs(i, 1)}] = map(i);
+    for(uint i=0; i<slabT(s).d0; i++) {
+      for(uint j=0; j<3; j++) T(nT, j) = map(slabT(s)(i, j));
+      nT++;
     }
   }
+  V.resizeCopy(nV, 3);
 
-  mc.run();
-  mc.clean_temps();
-
-  //convert to Mesh
-  clear();
-  V.resize(mc.nverts(), 3);
-  T.resize(mc.ntrigs(), 3);
-  for(i=0; i<V.d0; i++) {
-    V(i, 0)=lo(0)+mc.vert(i)->x*(hi(0)-lo(0))/(gridValues.d0-1);
-    V(i, 1)=lo(1)+mc.vert(i)->y*(hi(1)-lo(1))/(gridValues.d1-1);
-    V(i, 2)=lo(2)+mc.vert(i)->z*(hi(2)-lo(2))/(gridValues.d2-1);
-  }
-  for(i=0; i<T.d0; i++) {
-    T(i, 0)=mc.trig(i)->v1;
-    T(i, 1)=mc.trig(i)->v2;
-    T(i, 2)=mc.trig(i)->v3;
+  //-- grid to world coordinates
+  for(uint i=0; i<V.d0; i++) {
+    V(i, 0)=lo(0)+V(i, 0)*(hi(0)-lo(0))/(gridValues.d0-1);
+    V(i, 1)=lo(1)+V(i, 1)*(hi(1)-lo(1))/(gridValues.d1-1);
+    V(i, 2)=lo(2)+V(i, 2)*(hi(2)-lo(2))/(gridValues.d2-1);
   }
 }
 
 #else //Lewiner
 void Mesh::setImplicitSurface(const ScalarFunction& f, double lo, double hi, uint res) {  NICO  }
+void Mesh::setImplicitSurface(SDF& f, double lo, double hi, uint res, bool adaptive) { NICO }
+void Mesh::setImplicitSurface(SDF& f, double xLo, double xHi, double yLo, double yHi, double zLo, double zHi, uint res, bool adaptive) { NICO }
 void Mesh::setImplicitSurface(const floatA& gridValues, const arr& lo, const arr& hi) { NICO }
 #endif
 
 void Mesh::setImplicitSurfaceBySphereProjection(const ScalarFunction& f, double rad, uint fineness){
+  revision++;
   setSphere(fineness);
   scale(rad);
 
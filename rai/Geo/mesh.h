@@ -17,6 +17,7 @@ namespace rai { struct Mesh; }
 typedef rai::Array<rai::Mesh> MeshA;
 typedef rai::Array<rai::Mesh*> MeshL;
 struct ANN;
+struct SDF;
 
 namespace rai {
 
@@ -42,14 +43,19 @@ struct Mesh : GLDrawer {
   shared_ptr<ANN> ann;
 
   rai::Transformation glX; ///< transform (only used for drawing! Otherwise use applyOnPoints)  (optional)
+  shared_ptr<struct MeshGLBuffers> glBuffers; ///< cached GL vertex/index buffers (created by glDraw; recreated when the geometry changes)
 
   long parsing_pos_start;
   long parsing_pos_end;
 
   uint _support_vertex=0;
+  uint revision=0;      ///< incremented by the modifying methods -- call changed() after editing V, T or C directly
+
 
   Mesh();
 
+  void changed() { revision++; } ///< invalidates cached derived data (GL buffers, LODs, ray-cast BVHs) after direct edits of V, T or C
+
   /// @name set or create
   void clear();
   void setBox(bool edgesOnly=false);
@@ -68,6 +74,9 @@ struct Mesh : GLDrawer {
   void setSSCvx(const arr& core, double r, uint fineness=2);
   void setImplicitSurface(const ScalarFunction& f, double lo=-10., double hi=+10., uint res=100);
   void setImplicitSurface(const ScalarFunction& f, double xLo, double xHi, double yLo, double yHi, double zLo, double zHi, uint res);
+  //samples via SDF::evalBatch (concurrently from several threads); adaptive skips blocks far from the surface (f must be a distance)
+  void setImplicitSurface(SDF& f, double lo=-10., double hi=+10., uint res=100, bool adaptive=false);
+  void setImplicitSurface(SDF& f, double xLo, double xHi, double yLo, double yHi, double zLo, double zHi, uint res, bool adaptive=false);
   void setImplicitSurface(const arr& gridValues, const arr& lo, const arr& hi);
   void setImplicitSurface(const floatA& gridValues, const arr& lo, const arr& hi);
   void setImplicitSurfaceBySphereProjection(const ScalarFunction& f, double rad, uint fineness=3);
@@ -90,6 +99,7 @@ struct Mesh : GLDrawer {
   void makeConvexHull();
   void makeTriangleFan();
   void makeLines();
+  void decimate(uint targetTris, double maxError=-1.); ///< quadric error edge collapses until #T<=targetTris or the error exceeds maxError (if >=0)
 
   /// @name convex decomposition
   rai::Mesh decompose();
@@ -145,6 +155,9 @@ struct Mesh : GLDrawer {
   void readPts(std::istream&);
 
   void glDraw(struct OpenGL&);
+  void glDrawInstances(struct OpenGL&, const rai::Array<Transformation>& poses, const std::function<void(uint)>& beginInstance= {}, const std::function<void(uint)>& endInstance= {}); ///< draws the mesh at several poses, binding its buffers and material only once (one glDrawElements per pose, not GL instancing)
+  bool glBindBuffers(struct OpenGL&); ///< false if the mesh is not drawn from buffers (then use glDraw)
+  void glUnbindBuffers(struct OpenGL&);
 };
 
 stdOutPipe(Mesh)
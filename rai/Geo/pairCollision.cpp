@@ -12,6 +12,7 @@
 #include "../Optim/newton.h"
 #include "../Algo/ann.h"
 #include "../Core/util.h"
+#include "../Core/profiler.h"
 
 #ifdef RAI_GJK
 extern "C" {
@@ -34,6 +35,7 @@ namespace rai {
 
 PairCollision::PairCollision(rai::Mesh& _mesh1, rai::Mesh& _mesh2, const rai::Transformation& _t1, const rai::Transformation& _t2, double rad1, double rad2)
   : t1(&_t1), t2(&_t2), rad1(rad1), rad2(rad2) {
+  RAI_PROFILE("PairCollision");
 
   mesh1.V.referTo(_mesh1.V); mesh1.T.referTo(_mesh1.T);
   mesh2.V.referTo(_mesh2.V); mesh2.T.referTo(_mesh2.T);
@@ -0,0 +1,376 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "rayCast.h"
+#include "../Core/thread.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+typedef rai::MeshBVH::Node BVHNode;
+
+/// binned SAH build over axis-aligned boxes (n, 6: lo, up); order becomes the permutation of boxes referred to by the leaves
+const uint maxBVHDepth=60; //(deeper subtrees become leaves, which bounds the traversal stacks below)
+
+void buildBVH(std::vector<BVHNode>& nodes, uintA& order, const floatA& boxes, uint leafSize) {
+  const uint nBins=16;
+  uint n = boxes.d0;
+  order.setStraightPerm(n);
+  nodes.clear();
+  if(!n) return;
+  nodes.reserve(2*n);
+
+  floatA cen(n, 3);
+  for(uint i=0; i<n; i++) for(uint d=0; d<3; d++) cen(i, d) = .5f*(boxes(i, d)+boxes(i, 3+d));
+
+  auto area = [](const float* lo, const float* up) {
+    float a=up[0]-lo[0], b=up[1]-lo[1], c=up[2]-lo[2];
+    if(a<0.f) return 0.f;
+    return a*b + b*c + c*a;
+  };
+  auto grow = [](float* lo, float* up, const float* box) {
+    for(uint d=0; d<3; d++) { if(box[d]<lo[d]) lo[d]=box[d]; if(box[3+d]>up[d]) up[d]=box[3+d]; }
+  };
+
+  std::function<uint(uint, uint, uint)> build = [&](uint first, uint count, uint depth) -> uint {
+    uint idx = nodes.size();
+    nodes.emplace_back();
+    BVHNode node;
+    float cLo[3], cUp[3];
+    for(uint d=0; d<3; d++) { node.lo[d]=cLo[d]=+1e30f; node.up[d]=cUp[d]=-1e30f; }
+    for(uint i=first; i<first+count; i++) {
+      grow(node.lo, node.up, &boxes(order(i), 0));
+      for(uint d=0; d<3; d++) { float c=cen(order(i), d); if(c<cLo[d]) cLo[d]=c; if(c>cUp[d]) cUp[d]=c; }
+    }
+    node.first=first; node.count=count; node.axis=0;
+
+    uint axis=0;
+    for(uint d=1; d<3; d++) if(cUp[d]-cLo[d] > cUp[axis]-cLo[axis]) axis=d;
+    float ext = cUp[axis]-cLo[axis];
+    if(count<=leafSize || ext<=0.f || depth>=maxBVHDepth) { nodes[idx]=node; return idx; }
+
+    //-- bin centroids along the longest axis and pick the cheapest split
+    uint binCount[nBins];
+    float binLo[nBins][3], binUp[nBins][3];
+    for(uint b=0; b<nBins; b++) { binCount[b]=0; for(uint d=0; d<3; d++) { binLo[b][d]=+1e30f; binUp[b][d]=-1e30f; } }
+    auto binOf = [&](uint i) { uint b = uint(nBins*(cen(i, axis)-cLo[axis])/ext); return b<nBins?b:nBins-1; };
+    for(uint i=first; i<first+count; i++) {
+      uint b = binOf(order(i));
+      binCount[b]++;
+      grow(binLo[b], binUp[b], &boxes(order(i), 0));
+    }
+    float rightArea[nBins];
+    uint rightCount[nBins];
+    float lo[3]= {+1e30f, +1e30f, +1e30f}, up[3]= {-1e30f, -1e30f, -1e30f};
+    uint c=0;
+    for(uint b=nBins; b-->1;) {
+      c += binCount[b];
+      if(binCount[b]) { float box[6]= {binLo[b][0], binLo[b][1], binLo[b][2], binUp[b][0], binUp[b][1], binUp[b][2]}; grow(lo, up, box); }
+      rightCount[b]=c; rightArea[b]=area(lo, up);
+    }
+    uint split=0;
+    float bestCost=1e30f;
+    for(uint d=0; d<3; d++) { lo[d]=+1e30f; up[d]=-1e30f; }
+    c=0;
+    for(uint b=0; b<nBins-1; b++) {
+      c += binCount[b];
+      if(binCount[b]) { float box[6]= {binLo[b][0], binLo[b][1], binLo[b][2], binUp[b][0], binUp[b][1], binUp[b][2]}; grow(lo, up, box); }
+      if(!c || !rightCount[b+1]) continue;
+      float cost = c*area(lo, up) + rightCount[b+1]*rightArea[b+1];
+      if(cost<bestCost) { bestCost=cost; split=b+1; }
+    }
+
+    uint* mid;
+    if(split) {
+      mid = std::partition(order.p+first, order.p+first+count, [&](uint i) { return binOf(i)<split; });
+    } else { //all centroids in one bin -> median split
+      mid = order.p+first+count/2;
+      std::nth_element(order.p+first, mid, order.p+first+count, [&](uint i, uint j) { return cen(i, axis)<cen(j, axis); });
+    }
+    uint nLeft = mid-(order.p+first);
+
+    node.count=0;
+    node.axis=axis;
+    nodes[idx]=node;
+    build(first, nLeft, depth+1);
+    uint right = build(first+nLeft, count-nLeft, depth+1);
+    nodes[idx].first = right;
+    return idx;
+  };
+  build(0, n, 0);
+}
+
+}//namespace
+
+//===========================================================================
+
+rai::MeshBVH::MeshBVH(const Mesh& mesh) {
+  uint n = mesh.T.d0;
+  floatA boxes(n, 6);
+  for(uint i=0; i<n; i++) {
+    const double *a=&mesh.V(mesh.T(i, 0), 0), *b=&mesh.V(mesh.T(i, 1), 0), *c=&mesh.V(mesh.T(i, 2), 0);
+    for(uint d=0; d<3; d++) {
+      boxes(i, d) = std::min(a[d], std::min(b[d], c[d]));
+      boxes(i, 3+d) = std::max(a[d], std::max(b[d], c[d]));
+    }
+  }
+  buildBVH(nodes, triIds, boxes, 4);
+
+  tris.resize(n, 9);
+  for(uint i=0; i<n; i++) {
+    uint t = triIds(i);
+    const double *a=&mesh.V(mesh.T(t, 0), 0), *b=&mesh.V(mesh.T(t, 1), 0), *c=&mesh.V(mesh.T(t, 2), 0);
+    float* tr = &tris(i, 0);
+    for(uint d=0; d<3; d++) { tr[d]=a[d]; tr[3+d]=b[d]-a[d]; tr[6+d]=c[d]-a[d]; }
+  }
+}
+
+//===========================================================================
+
+/// a 4x4 tile of rays in structure-of-arrays layout, so that the per-ray loops vectorize
+struct rai::RayCaster::Packet {
+  static constexpr uint K=16;
+  float ox[K], oy[K], oz[K];
+  float dx[K], dy[K], dz[K];
+  float ix[K], iy[K], iz[K]; //inverse directions
+  float t[K];                //closest hit so far (initialized to zFar)
+  uint tri[K], inst[K];
+  float tMin;                //zNear
+
+  void setInverse() {
+    for(uint k=0; k<K; k++) {
+      ix[k] = 1.f/(fabsf(dx[k])>1e-20f?dx[k]:1e-20f);
+      iy[k] = 1.f/(fabsf(dy[k])>1e-20f?dy[k]:1e-20f);
+      iz[k] = 1.f/(fabsf(dz[k])>1e-20f?dz[k]:1e-20f);
+    }
+  }
+
+  bool hitsBox(const float* lo, const float* up) const {
+    int any=0;
+    for(uint k=0; k<K; k++) {
+      float x0=(lo[0]-ox[k])*ix[k], x1=(up[0]-ox[k])*ix[k];
+      float y0=(lo[1]-oy[k])*iy[k], y1=(up[1]-oy[k])*iy[k];
+      float z0=(lo[2]-oz[k])*iz[k], z1=(up[2]-oz[k])*iz[k];
+      float tNear = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), tMin));
+      float tFar = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::min(std::max(z0, z1), t[k]));
+      any |= (tNear<=tFar);
+    }
+    return any;
+  }
+
+  void hitsTriangle(const float* tr, uint triIdx) {
+    for(uint k=0; k<K; k++) { //Moeller-Trumbore, both-sided
+      float px = dy[k]*tr[8] - dz[k]*tr[7];
+      float py = dz[k]*tr[6] - dx[k]*tr[8];
+      float pz = dx[k]*tr[7] - dy[k]*tr[6];
+      float det = tr[3]*px + tr[4]*py + tr[5]*pz;
+      float inv = 1.f/det;
+      float sx = ox[k]-tr[0], sy = oy[k]-tr[1], sz = oz[k]-tr[2];
+      float u = (sx*px + sy*py + sz*pz)*inv;
+      float qx = sy*tr[5] - sz*tr[4];
+      float qy = sz*tr[3] - sx*tr[5];
+      float qz = sx*tr[4] - sy*tr[3];
+      float v = (dx[k]*qx + dy[k]*qy + dz[k]*qz)*inv;
+      float tt = (tr[6]*qx + tr[7]*qy + tr[8]*qz)*inv;
+      bool hit = det!=0.f && u>=0.f && v>=0.f && u+v<=1.f && tt>tMin && tt<t[k];
+      t[k] = hit?tt:t[k];
+      tri[k] = hit?triIdx:tri[k];
+    }
+  }
+};
+
+void rai::RayCaster::clear() {
+  instances.clear();
+}
+
+void rai::RayCaster::add(const shared_ptr<Mesh>& mesh, const Transformation& X, uint id) {
+  if(!mesh || !mesh->T.d0) return;
+  CacheEntry& c = cache[mesh.get()];
+  if(!c.bvh || c.revision!=mesh->revision) {
+    c.mesh = mesh;
+    c.bvh = make_shared<MeshBVH>(*mesh);
+    c.revision = mesh->revision;
+  }
+  Instance& inst = instances.emplace_back();
+  inst.mesh = mesh;
+  inst.bvh = c.bvh;
+  double R[9];
+  X.rot.getMatrix(R);
+  for(uint i=0; i<9; i++) inst.R[i]=R[i];
+  inst.p[0]=X.pos.x; inst.p[1]=X.pos.y; inst.p[2]=X.pos.z;
+  inst.id = id;
+}
+
+void rai::RayCaster::shareCache(const RayCaster& other) {
+  for(auto& c:other.cache) cache.insert(c); //(the BVHs are read-only, and keep being checked against the mesh revisions in add)
+}
+
+void rai::RayCaster::castInstance(Packet& P, const Instance& inst, uint instIdx) const {
+  //-- rays in mesh coordinates (rigid transform -> same ray parameter t)
+  Packet L;
+  const float* R=inst.R;
+  for(uint k=0; k<Packet::K; k++) {
+    float x=P.ox[k]-inst.p[0], y=P.oy[k]-inst.p[1], z=P.oz[k]-inst.p[2];
+    L.ox[k] = R[0]*x + R[3]*y + R[6]*z;
+    L.oy[k] = R[1]*x + R[4]*y + R[7]*z;
+    L.oz[k] = R[2]*x + R[5]*y + R[8]*z;
+    L.dx[k] = R[0]*P.dx[k] + R[3]*P.dy[k] + R[6]*P.dz[k];
+    L.dy[k] = R[1]*P.dx[k] + R[4]*P.dy[k] + R[7]*P.dz[k];
+    L.dz[k] = R[2]*P.dx[k] + R[5]*P.dy[k] + R[8]*P.dz[k];
+    L.t[k] = P.t[k];
+    L.tri[k] = UINT_MAX;
+  }
+  L.tMin = P.tMin;
+  L.setInverse();
+
+  const MeshBVH& bvh = *inst.bvh;
+  uint stack[maxBVHDepth+2], n=0;
+  stack[n++]=0;
+  while(n) {
+    uint idx = stack[--n];
+    const BVHNode& node = bvh.nodes[idx];
+    if(!L.hitsBox(node.lo, node.up)) continue;
+    if(node.count) {
+      for(uint i=node.first; i<node.first+node.count; i++) L.hitsTriangle(bvh.tris.p+9*i, i);
+    } else {
+      uint near=idx+1, far=node.first;
+      if(L.dx[0]*(node.axis==0) + L.dy[0]*(node.axis==1) + L.dz[0]*(node.axis==2) < 0.f) std::swap(near, far);
+      stack[n++]=far;
+      stack[n++]=near;
+    }
+  }
+
+  for(uint k=0; k<Packet::K; k++) if(L.tri[k]!=UINT_MAX) {
+    P.t[k] = L.t[k];
+    P.tri[k] = L.tri[k];
+    P.inst[k] = instIdx;
+  }
+}
+
+void rai::RayCaster::cast(Packet& P) const {
+  if(!topNodes.size()) return;
+  uint stack[maxBVHDepth+2], n=0;
+  stack[n++]=0;
+  while(n) {
+    uint idx = stack[--n];
+    const BVHNode& node = topNodes[idx];
+    if(!P.hitsBox(node.lo, node.up)) continue;
+    if(node.count) {
+      for(uint i=node.first; i<node.first+node.count; i++) castInstance(P, instances[topOrder(i)], topOrder(i));
+    } else {
+      uint near=idx+1, far=node.first;
+      if(P.dx[0]*(node.axis==0) + P.dy[0]*(node.axis==1) + P.dz[0]*(node.axis==2) < 0.f) std::swap(near, far);
+      stack[n++]=far;
+      stack[n++]=near;
+    }
+  }
+}
+
+void rai::RayCaster::render(floatA& depth, uintA& ids, byteA& rgb, const Camera& cam, uint width, uint height, bool computeRgb) {
+  //-- drop cached BVHs of meshes that are not rendered anymore
+  for(auto it=cache.begin(); it!=cache.end();) {
+    bool used=false;
+    for(const Instance& inst:instances) if(inst.mesh.get()==it->first) { used=true; break; }
+    if(used) ++it; else it=cache.erase(it);
+  }
+
+  //-- top-level BVH over the world-space boxes of the instances
+  floatA boxes(instances.size(), 6);
+  for(uint i=0; i<instances.size(); i++) {
+    const Instance& inst = instances[i];
+    const BVHNode& root = inst.bvh->nodes[0];
+    float* box = &boxes(i, 0);
+    for(uint d=0; d<3; d++) { //(bounds of the rotated root box)
+      box[d] = box[3+d] = inst.p[d];
+      for(uint e=0; e<3; e++) {
+        float a=inst.R[3*d+e]*root.lo[e], b=inst.R[3*d+e]*root.up[e];
+        box[d] += std::min(a, b);
+        box[3+d] += std::max(a, b);
+      }
+    }
+  }
+  buildBVH(topNodes, topOrder, boxes, 1);
+
+  //-- camera
+  double Rc[9];
+  cam.X.rot.getMatrix(Rc);
+  float W=width, H=height;
+  bool ortho = !(cam.focalLength>0.);
+  CHECK(!ortho || cam.heightAbs>0., "camera has neither focal length nor absolute height");
+  float scale = ortho ? cam.heightAbs/H : 1.f/(cam.focalLength*H);
+
+  depth.resize(height, width);
+  ids.resize(height, width);
+  if(computeRgb) rgb.resize(height, width, 3);
+
+  uint tilesX=(width+3)/4, tilesY=(height+3)/4;
+  auto renderTileRow = [&](uint tileRow) {
+    Packet P;
+    for(uint tileCol=0; tileCol<tilesX; tileCol++) {
+      uint i0=4*tileRow, j0=4*tileCol;
+      for(uint k=0; k<Packet::K; k++) {
+        float x = (j0+(k&3)+.5f-.5f*W)*scale, y = (.5f*H-(i0+(k>>2)+.5f))*scale; //pixel centers, camera looks along -z
+        float ox=0.f, oy=0.f, dx=x, dy=y, dz=-1.f;
+        if(ortho) { ox=x; oy=y; dx=0.f; dy=0.f; }
+        P.ox[k] = cam.X.pos.x + Rc[0]*ox + Rc[1]*oy;
+        P.oy[k] = cam.X.pos.y + Rc[3]*ox + Rc[4]*oy;
+        P.oz[k] = cam.X.pos.z + Rc[6]*ox + Rc[7]*oy;
+        P.dx[k] = Rc[0]*dx + Rc[1]*dy + Rc[2]*dz;
+        P.dy[k] = Rc[3]*dx + Rc[4]*dy + Rc[5]*dz;
+        P.dz[k] = Rc[6]*dx + Rc[7]*dy + Rc[8]*dz;
+        P.t[k] = cam.zFar;
+        P.inst[k] = UINT_MAX;
+      }
+      P.tMin = cam.zNear;
+      P.setInverse();
+
+      cast(P);
+
+      for(uint k=0; k<Packet::K; k++) {
+        uint i=i0+(k>>2), j=j0+(k&3);
+        if(i>=height || j>=width) continue;
+        if(P.inst[k]==UINT_MAX) {
+          depth(i, j) = -1.f;
+          ids(i, j) = noHit;
+          if(computeRgb) for(uint c=0; c<3; c++) rgb(i, j, c) = background[c];
+          continue;
+        }
+        const Instance& inst = instances[P.inst[k]];
+        depth(i, j) = P.t[k];
+        ids(i, j) = inst.id;
+        if(computeRgb) { //flat shading with a head light
+          const float* tr = inst.bvh->tris.p+9*P.tri[k];
+          float n[3] = { tr[4]*tr[8]-tr[5]*tr[7], tr[5]*tr[6]-tr[3]*tr[8], tr[3]*tr[7]-tr[4]*tr[6] };
+          float nw[3];
+          for(uint d=0; d<3; d++) nw[d] = inst.R[3*d]*n[0] + inst.R[3*d+1]*n[1] + inst.R[3*d+2]*n[2];
+          float nd = nw[0]*P.dx[k] + nw[1]*P.dy[k] + nw[2]*P.dz[k];
+          float nn = nw[0]*nw[0] + nw[1]*nw[1] + nw[2]*nw[2];
+          float dd = P.dx[k]*P.dx[k] + P.dy[k]*P.dy[k] + P.dz[k]*P.dz[k];
+          float shade = .3f + .7f*fabsf(nd)/sqrtf(nn*dd+1e-30f);
+          const Mesh& M = *inst.mesh;
+          float col[3] = {.5f, .5f, .5f};
+          if(M.C.N==3 || M.C.N==4) {
+            for(uint c=0; c<3; c++) col[c]=M.C.elem(c);
+          } else if(M.C.nd==2 && M.C.d0==M.V.d0 && M.C.d1>=3) { //vertex colors -> average over the triangle
+            uint t = inst.bvh->triIds(P.tri[k]);
+            for(uint c=0; c<3; c++) col[c] = (M.C(M.T(t, 0), c)+M.C(M.T(t, 1), c)+M.C(M.T(t, 2), c))/3.;
+          }
+          for(uint c=0; c<3; c++) {
+            float v = 255.f*shade*col[c];
+            rgb(i, j, c) = v>255.f ? 255 : (v<0.f ? 0 : (::byte)v);
+          }
+        }
+      }
+    }
+  };
+
+  if(parallel) parallel_for(0, tilesY, renderTileRow);
+  else for(uint tileRow=0; tileRow<tilesY; tileRow++) renderTileRow(tileRow);
+}
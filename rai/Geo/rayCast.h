@@ -0,0 +1,69 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "mesh.h"
+
+#include <map>
+
+namespace rai {
+
+//===========================================================================
+/// bounding volume hierarchy (binned SAH) over the triangles of a mesh, in mesh coordinates
+struct MeshBVH {
+  struct Node {
+    float lo[3], up[3];
+    uint first, count; ///< leaf (count>0): primitives [first, first+count); inner node: children are this+1 and nodes[first]
+    uint axis;         ///< split axis of an inner node (to traverse front-to-back)
+  };
+  std::vector<Node> nodes;
+  floatA tris;  ///< (#tris, 9): vertex 0, edge 1, edge 2 of each triangle, in BVH order
+  uintA triIds; ///< original mesh triangle of each triangle, in BVH order
+
+  MeshBVH(const Mesh& mesh);
+};
+
+//===========================================================================
+/// CPU ray caster rendering depth, segmentation (instance ids) and flat-shaded color images of posed meshes --
+/// packets of 4x4 rays traverse a two-level BVH (instances, then the cached per-mesh MeshBVH); rows of tiles are distributed over the thread pool
+struct RayCaster {
+  static constexpr uint noHit = UINT_MAX; ///< id of pixels that hit nothing (their depth is -1)
+  bool parallel=true;                     ///< distribute rows of tiles over ThreadPool::global() (false: render in the calling thread)
+  byte background[3] = {255, 255, 255};   ///< color of pixels that hit nothing
+
+  void clear(); ///< removes all instances (BVHs of meshes are kept until a render without them)
+  void add(const shared_ptr<Mesh>& mesh, const Transformation& X, uint id);
+  void shareCache(const RayCaster& other); ///< adopts the BVHs cached by other (e.g., rendering a copy of the same scene) instead of rebuilding them
+
+  /// depth is the true depth (as CameraView::computeImageAndDepth), ids are those given in add(); rgb only if computeRgb
+  void render(floatA& depth, uintA& ids, byteA& rgb, const Camera& cam, uint width, uint height, bool computeRgb=true);
+
+ private:
+  struct Instance {
+    shared_ptr<Mesh> mesh;
+    shared_ptr<MeshBVH> bvh;
+    float R[9], p[3]; ///< pose (row-major rotation and translation)
+    uint id;
+  };
+  struct CacheEntry {
+    shared_ptr<Mesh> mesh; //(keeps the mesh alive, so its address can't be reused by another mesh)
+    shared_ptr<MeshBVH> bvh;
+    uint revision; //to detect changed meshes (see Mesh::changed)
+  };
+  std::vector<Instance> instances;
+  std::vector<MeshBVH::Node> topNodes; ///< BVH over the world-space bounding boxes of the instances
+  uintA topOrder;
+  std::map<const Mesh*, CacheEntry> cache;
+
+  struct Packet;
+  void castInstance(Packet& P, const Instance& inst, uint instIdx) const;
+  void cast(Packet& P) const;
+};
+
+}//namespace
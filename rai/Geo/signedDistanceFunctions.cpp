@@ -8,20 +8,57 @@
 
 //===========================================================================
 
+namespace {
+//helpers for the batched kernels: R is the row-major rotation matrix of the pose, or null for a zero pose
+
+inline const double* getRotation(double* R, const rai::Transformation& pose) {
+  if(pose.isZero()) return 0;
+  return pose.rot.getMatrix(R);
+}
+
+inline void toLocal(double* p, const double* R, const rai::Transformation& pose, const double* x) {
+  if(!R) { p[0]=x[0]; p[1]=x[1]; p[2]=x[2]; return; }
+  double d0=x[0]-pose.pos.x, d1=x[1]-pose.pos.y, d2=x[2]-pose.pos.z;
+  for(uint i=0; i<3; i++) p[i] = R[i]*d0 + R[3+i]*d1 + R[6+i]*d2;
+}
+
+inline void toWorld(double* g, const double* R, const double* gl) {
+  if(!R) { g[0]=gl[0]; g[1]=gl[1]; g[2]=gl[2]; return; }
+  for(uint i=0; i<3; i++) g[i] = R[3*i]*gl[0] + R[3*i+1]*gl[1] + R[3*i+2]*gl[2];
+}
+
+inline void checkBatch(arr& y, arr& g, const arr& X) {
+  CHECK_EQ(X.nd, 2, "");
+  CHECK_EQ(X.d1, 3, "");
+  y.resize(X.d0);
+  if(!!g) g.resize(X.d0, 3);
+}
+}
+
+void SDF::evalBatch(arr& y, arr& g, const arr& X){
+  checkBatch(y, g, X);
+  arr gi;
+  for(uint i=0;i<X.d0;i++){
+    if(!!g){
+      y.elem(i) = f(gi, NoArr, X[i]);
+      CHECK_EQ(gi.N, 3, "");
+      for(uint j=0;j<3;j++) g(i, j) = gi.elem(j);
+    }else{
+      y.elem(i) = f(NoArr, NoArr, X[i]);
+    }
+  }
+}
+
 arr SDF::eval(const arr& samples){
-  CHECK_EQ(samples.nd, 2, "");
-  CHECK_EQ(samples.d1, 3, "");
-  arr y(samples.d0);
-  for(uint i=0;i<y.N;i++) y.elem(i) = f(NoArr, NoArr, samples[i]);
+  arr y;
+  evalBatch(y, NoArr, samples);
   return y;
 }
 
 floatA SDF::evalFloat(const arr& samples){
-  CHECK_EQ(samples.nd, 2, "");
-  CHECK_EQ(samples.d1, 3, "");
-  floatA y(samples.d0);
-  for(uint i=0;i<y.N;i++) y.elem(i) = f(NoArr, NoArr, samples[i]);
-  return y;
+  arr y;
+  evalBatch(y, NoArr, samples);
+  return rai::convert<float>(y);
 }
 
 void SDF::viewSlice(OpenGL& gl, double z, const arr& lo, const arr& hi){
@@ -93,6 +130,19 @@ double SDF_Sphere::f(arr& g, arr& H, const arr& x) {
   return len-r;
 }
 
+void SDF_Sphere::evalBatch(arr& y, arr& g, const arr& X) {
+  checkBatch(y, g, X);
+  const double c0=pose.pos.x, c1=pose.pos.y, c2=pose.pos.z, eps=1e-10;
+  const double* x=X.p;
+  double* gp = (!!g)?g.p:0;
+  for(uint i=0; i<X.d0; i++) {
+    double d0=x[3*i]-c0, d1=x[3*i+1]-c1, d2=x[3*i+2]-c2;
+    double len = sqrt(d0*d0+d1*d1+d2*d2);
+    y.p[i] = len-r;
+    if(gp) { double s=1./(len+eps); gp[3*i]=s*d0; gp[3*i+1]=s*d1; gp[3*i+2]=s*d2; }
+  }
+}
+
 //===========================================================================
 
 //double DistanceFunction_InfCylinder::fs(arr& g, arr& H, const arr& x){
@@ -173,6 +223,41 @@ double SDF_Cylinder::f(arr& g, arr& H, const arr& x) {
   HALT("You shouldn't be here!");
 }
 
+void SDF_Cylinder::evalBatch(arr& y, arr& g, const arr& X) {
+  checkBatch(y, g, X);
+  double R[9];
+  pose.rot.getMatrix(R);
+  const double z[3] = {R[2], R[5], R[8]}, h=.5*size_z;
+  for(uint i=0; i<X.d0; i++) {
+    const double* x = X.p+3*i;
+    double xc[3] = {x[0]-pose.pos.x, x[1]-pose.pos.y, x[2]-pose.pos.z};
+    double zcoord = xc[0]*z[0] + xc[1]*z[1] + xc[2]*z[2];
+    double b[3], a[3];
+    for(uint k=0; k<3; k++) { b[k]=zcoord*z[k]; a[k]=xc[k]-b[k]; }
+    double la = sqrt(a[0]*a[0]+a[1]*a[1]+a[2]*a[2]);
+    double lb = fabs(zcoord);
+    double d, gi[3];
+    if(la<1e-10) {
+      if(zcoord>h) { d=zcoord-h; for(uint k=0; k<3; k++) gi[k]=z[k]; }
+      else if(-zcoord>h) { d=-zcoord-h; for(uint k=0; k<3; k++) gi[k]=-z[k]; }
+      else { d=-r; gi[0]=gi[1]=gi[2]=0.; }
+    } else if(lb<h) {
+      if(la<r && (h-lb)<(r-la)) { d=lb-h; for(uint k=0; k<3; k++) gi[k]=b[k]/lb; }
+      else { d=la-r; for(uint k=0; k<3; k++) gi[k]=a[k]/la; }
+    } else {
+      if(la<r) { d=lb-h; for(uint k=0; k<3; k++) gi[k]=b[k]/lb; }
+      else {
+        double v[3];
+        for(uint k=0; k<3; k++) v[k] = b[k]/lb*(lb-h) + a[k]/la*(la-r);
+        d = sqrt(v[0]*v[0]+v[1]*v[1]+v[2]*v[2]);
+        for(uint k=0; k<3; k++) gi[k]=v[k]/d;
+      }
+    }
+    y.p[i] = d;
+    if(!!g) for(uint k=0; k<3; k++) g.p[3*i+k]=gi[k];
+  }
+}
+
 //===========================================================================
 
 double SDF_Capsule::f(arr& g, arr& H, const arr& x) {
@@ -221,6 +306,29 @@ double SDF_Capsule::f(arr& g, arr& H, const arr& x) {
   HALT("You shouldn't be here!");
 }
 
+void SDF_Capsule::evalBatch(arr& y, arr& g, const arr& X) {
+  checkBatch(y, g, X);
+  double R[9];
+  pose.rot.getMatrix(R);
+  const double z0=R[2], z1=R[5], z2=R[8], h=.5*size_z;
+  const double c0=pose.pos.x, c1=pose.pos.y, c2=pose.pos.z;
+  const double* x=X.p;
+  double* gp = (!!g)?g.p:0;
+  for(uint i=0; i<X.d0; i++) {
+    //distance to the closest point on the center segment
+    double d0=x[3*i]-c0, d1=x[3*i+1]-c1, d2=x[3*i+2]-c2;
+    double zcoord = d0*z0 + d1*z1 + d2*z2;
+    double zc = zcoord>h ? h : (zcoord<-h ? -h : zcoord);
+    d0 -= zc*z0;  d1 -= zc*z1;  d2 -= zc*z2;
+    double len = sqrt(d0*d0+d1*d1+d2*d2);
+    y.p[i] = len-r;
+    if(gp) {
+      double s = len<1e-10 ? 0. : 1./len;
+      gp[3*i]=s*d0; gp[3*i+1]=s*d1; gp[3*i+2]=s*d2;
+    }
+  }
+}
+
 //===========================================================================
 
 /// dx, dy, dz are box-wall-coordinates: width=2*dx...; t is box transform; x is query point in world
@@ -257,9 +365,9 @@ double SDF_ssBox::f(arr& g, arr& H, const arr& x) {
   arr closest = x_rel;
   arr del_abs = fabs(x_rel)-box;
   bool inside=true;
+  uint side=argmax(del_abs); //which side are we closest to?
   //-- find closest point on box
   if(max(del_abs)<0.) { //inside
-    uint side=argmax(del_abs); //which side are we closest to?
     if(x_rel(side)>0) closest(side) = box(side);  else  closest(side)=-box(side); //in positive or neg direction?
   } else { //outside
     inside = false;
@@ -271,7 +379,10 @@ double SDF_ssBox::f(arr& g, arr& H, const arr& x) {
   arr del = x_rel-closest;
   double d = length(del);
   if(inside) d *= -1.;
-  if(!!g) g = rot*del/d; //transpose(R) rotates the gradient back to world coordinates
+  if(!!g) { //transpose(R) rotates the gradient back to world coordinates
+    if(fabs(d)<1e-10) { g = zeros(3); g(side) = x_rel(side)>0. ? 1. : -1.; g = rot*g; } //on the inner box: normal of the side
+    else g = rot*del/d;
+  }
   if(!!H) {
     if(inside) { //inside
       H.resize(3, 3).setZero();
@@ -295,6 +406,38 @@ double SDF_ssBox::f(arr& g, arr& H, const arr& x) {
   return d-r;
 }
 
+void SDF_ssBox::evalBatch(arr& y, arr& g, const arr& X) {
+  checkBatch(y, g, X);
+  double R[9];
+  const double* Rp = getRotation(R, pose);
+  double box[3];
+  for(uint k=0; k<3; k++) box[k] = .5*size.elem(k) - r;
+  for(uint i=0; i<X.d0; i++) {
+    double p[3], del[3], delAbsMax=-1e10;
+    uint side=0;
+    toLocal(p, Rp, pose, X.p+3*i);
+    for(uint k=0; k<3; k++) {
+      double da = fabs(p[k])-box[k];
+      if(da>delAbsMax) { delAbsMax=da; side=k; }
+    }
+    double d;
+    if(delAbsMax<0.) { //inside: closest is the nearest side
+      del[0]=del[1]=del[2]=0.;
+      del[side] = p[side] - (p[side]>0. ? box[side] : -box[side]);
+      d = -fabs(del[side]);
+    } else { //outside: clip to the box
+      for(uint k=0; k<3; k++) del[k] = p[k] - (p[k]>box[k] ? box[k] : (p[k]<-box[k] ? -box[k] : p[k]));
+      d = sqrt(del[0]*del[0]+del[1]*del[1]+del[2]*del[2]);
+    }
+    y.p[i] = d-r;
+    if(!!g) {
+      if(fabs(d)<1e-10) { del[0]=del[1]=del[2]=0.;  del[side] = p[side]>0. ? 1. : -1.; } //on the inner box: normal of the side
+      else for(uint k=0; k<3; k++) del[k] /= d;
+      toWorld(g.p+3*i, Rp, del);
+    }
+  }
+}
+
 //===========================================================================
 
 double SDF_ssSomething::f(arr& g, arr& H, const arr& x){
@@ -349,97 +492,73 @@ double SDF_Transformed::f(arr& g, arr& H, const arr& x){
   return f;
 }
 
-double SDF_GridData::f(arr& g, arr& H, const arr& x){
-  arr rot, x_rel;
-  if(pose.isZero()){
-    x_rel=x;
-  }else{
-    rot = pose.rot.getArr();
-    x_rel = (~rot)*(x-conv_vec2arr(pose.pos)); //point in box coordinates
+namespace {
+//allocation-free trilinear lookup shared by SDF_GridData::f and ::evalBatch;
+//R is the pose rotation (or null), g (if non-null) receives the world gradient
+double gridDataPoint(const SDF_GridData& sdf, const double* R, const double* x, double* g) {
+  const floatA& data = sdf.gridData;
+  double x_rel[3];
+  toLocal(x_rel, R, sdf.pose, x);
+
+  //-- clip to the box -- and memorize which are clipped!
+  const double eps=.001;
+  bool clipped[3] = {false, false, false};
+  double del[3] = {0., 0., 0.};
+  for(uint i=0; i<3; i++) {
+    double lo=sdf.lo.elem(i)+eps, up=sdf.up.elem(i)-eps;
+    if(x_rel[i]<lo) { del[i]=x_rel[i]-lo; x_rel[i]=lo; clipped[i]=true; }
+    if(x_rel[i]>up) { del[i]=x_rel[i]-up; x_rel[i]=up; clipped[i]=true; }
   }
-
-  arr gBox, HBox;
-  boolA clipped = {false, false, false};
-  double fBox=0.;
-  double eps=.001;
-  if(!boundCheck(x_rel, lo+eps, up-eps, 0., false)){ //check outside box
-//    boundClip(x_rel, lo+eps, up-eps);
-    //clip -- and memorize which are clipped!
-    for(uint i=0; i<3; i++) {
-      if(x_rel(i)<lo.elem(i)+eps){ x_rel.elem(i) = lo.elem(i)+eps; clipped.elem(i)=true; }
-      if(x_rel(i)>up.elem(i)-eps){ x_rel.elem(i) = up.elem(i)-eps; clipped.elem(i)=true; }
-    }
-    arr size = up - lo - 2.*eps;
-    arr center = .5*(up+lo);
-    rai::Transformation boxPose=pose;
-    boxPose.addRelativeTranslation(center);
-    SDF_ssBox B(boxPose, size);
-    fBox = B.f(gBox, HBox, x);
-    CHECK(fBox>=0., "");
+  double fBox = sqrt(del[0]*del[0]+del[1]*del[1]+del[2]*del[2]);
+
+  //-- float index; res converts index-space to world-space derivatives
+  const uint d[3] = {data.d0, data.d1, data.d2};
+  int idx[3];
+  double frac[3], res[3];
+  for(uint i=0; i<3; i++) {
+    res[i] = double(d[i]-1)/(sdf.up.elem(i)-sdf.lo.elem(i));
+    double fidx = res[i]*(x_rel[i]-sdf.lo.elem(i)), ip;
+    frac[i] = modf(fidx, &ip);
+    idx[i] = ip;
+    if(idx[i]+1==(int)d[i] && frac[i]<1e-10) { idx[i]--; frac[i]=1.; }
   }
+  double dx=frac[0], dy=frac[1], dz=frac[2];
 
-  // float index
-  arr fidx = arr{(double)gridData.d0-1, (double)gridData.d1-1, (double)gridData.d2-1};
-  fidx /= (up-lo);
-  x_rel -= lo;
-  fidx *= x_rel;
-
-  arr frac(3), idx(3);
-  for(uint i=0;i<3;i++) frac(i) = modf(fidx(i), &idx(i));
-
-  int _x = idx(0);
-  int _y = idx(1);
-  int _z = idx(2);
-  double dx = frac(0);
-  double dy = frac(1);
-  double dz = frac(2);
-
-  if(_x+1==(int)gridData.d0 && dx<1e-10){ _x--; dx=1.; }
-  if(_y+1==(int)gridData.d1 && dy<1e-10){ _y--; dy=1.; }
-  if(_z+1==(int)gridData.d2 && dz<1e-10){ _z--; dz=1.; }
-
-  double v000 = gridData(_x+0,_y+0,_z+0);
-  double v100 = gridData(_x+1,_y+0,_z+0);
-  double v010 = gridData(_x+0,_y+1,_z+0);
-  double v110 = gridData(_x+1,_y+1,_z+0);
-  double v001 = gridData(_x+0,_y+0,_z+1);
-  double v101 = gridData(_x+1,_y+0,_z+1);
-  double v011 = gridData(_x+0,_y+1,_z+1);
-  double v111 = gridData(_x+1,_y+1,_z+1);
+  const float* v = data.p + (idx[0]*d[1] + idx[1])*d[2] + idx[2];
+  const uint sx=d[1]*d[2], sy=d[2];
+  double v000 = v[0],     v100 = v[sx],       v010 = v[sy],       v110 = v[sx+sy];
+  double v001 = v[1],     v101 = v[sx+1],     v011 = v[sy+1],     v111 = v[sx+sy+1];
 
-#if 1
   double f = interpolate3D(v000, v100, v010, v110, v001, v101, v011, v111,
                            dx,dy,dz);
-#else
-  arr wx = {1.-dx, dx};
-  arr wy = {1.-dy, dy};
-  arr wz = {1.-dz, dz};
-  arr coeffs = (wx ^ wy) ^ wz;
-  arr values = { v000, v100, v010, v110, v001, v101, v011, v111 };
-  double f = scalarProduct(coeffs, values);
-#endif
 
-  if(!!g){
-    g.resize(3).setZero();
-    if(!clipped(0)) g(0) = interpolate2D(v100,v110,v101,v111, dy,dz) - interpolate2D(v000,v010,v001,v011, dy,dz);
-    if(!clipped(1)) g(1) = interpolate2D(v010,v110,v011,v111, dx,dz) - interpolate2D(v000,v100,v001,v101, dx,dz);
-    if(!clipped(2)) g(2) = interpolate2D(v001,v101,v011,v111, dx,dy) - interpolate2D(v000,v100,v010,v110, dx,dy);
-    g *= fidx;
-    if(rot.N) g = rot*g;
+  if(g) {
+    double gl[3] = {0., 0., 0.};
+    if(!clipped[0]) gl[0] = res[0]*(interpolate2D(v100,v110,v101,v111, dy,dz) - interpolate2D(v000,v010,v001,v011, dy,dz));
+    if(!clipped[1]) gl[1] = res[1]*(interpolate2D(v010,v110,v011,v111, dx,dz) - interpolate2D(v000,v100,v001,v101, dx,dz));
+    if(!clipped[2]) gl[2] = res[2]*(interpolate2D(v001,v101,v011,v111, dx,dy) - interpolate2D(v000,v100,v010,v110, dx,dy));
+    if(fBox) for(uint i=0; i<3; i++) gl[i] += del[i]/fBox;
+    toWorld(g, R, gl);
   }
 
-  if(!!H){
-    H.resize(3,3).setZero();
-  }
+  return f + fBox;
+}
+}
 
-  if(fBox){
-    double boxFactor=1.;
-    f += boxFactor * fBox;
-    if(!!g) g += boxFactor * gBox;
-    if(!!H) H += boxFactor * HBox;
-  }
+double SDF_GridData::f(arr& g, arr& H, const arr& x){
+  CHECK_EQ(x.N, 3, "");
+  double R[9];
+  const double* Rp = getRotation(R, pose);
+  if(!!g) g.resize(3);
+  if(!!H) H.resize(3,3).setZero();
+  return gridDataPoint(*this, Rp, x.p, (!!g)?g.p:0);
+}
 
-  return f;
+void SDF_GridData::evalBatch(arr& y, arr& g, const arr& X){
+  checkBatch(y, g, X);
+  double R[9];
+  const double* Rp = getRotation(R, pose);
+  for(uint i=0; i<X.d0; i++) y.p[i] = gridDataPoint(*this, Rp, X.p+3*i, (!!g)?g.p+3*i:0);
 }
 
 void SDF_GridData::resample(uint d0, int d1, int d2){
@@ -528,6 +647,191 @@ void SDF_GridData::read(std::istream& is){
 
 //===========================================================================
 
+SDF_SparseGrid::SDF_SparseGrid(SDF& f, const arr& _lo, const arr& _up, double _voxelSize, double _band)
+  : lo(_lo), up(_up), voxelSize(_voxelSize), band(_band) {
+  CHECK_EQ(lo.N, 3, "");
+  CHECK_EQ(up.N, 3, "");
+  const uint B=brickSize, S1=B+1;
+  double brickWidth = B*voxelSize;
+
+  //-- coarse brick index; the upper bound is rounded up to full bricks
+  uint nb[3];
+  for(uint i=0; i<3; i++) {
+    nb[i] = (uint)ceil((up(i)-lo(i))/brickWidth - 1e-10);
+    if(!nb[i]) nb[i]=1;
+    up(i) = lo(i) + nb[i]*brickWidth;
+  }
+  brickIndex.resize(nb[0], nb[1], nb[2]);
+
+  //-- classify bricks by the distance at their center (assumes f is a proper, 1-Lipschitz distance)
+  arr centers(brickIndex.N, 3);
+  for(uint i=0; i<nb[0]; i++) for(uint j=0; j<nb[1]; j++) for(uint k=0; k<nb[2]; k++) {
+    double* c = &centers((i*nb[1]+j)*nb[2]+k, 0);
+    c[0] = lo(0) + (i+.5)*brickWidth;
+    c[1] = lo(1) + (j+.5)*brickWidth;
+    c[2] = lo(2) + (k+.5)*brickWidth;
+  }
+  arr dCenter = f.eval(centers);
+  double margin = .5*sqrt(3.)*brickWidth + band;
+  uint n=0;
+  for(uint b=0; b<brickIndex.N; b++) {
+    if(dCenter.elem(b) > margin) brickIndex.elem(b) = _farOutside;
+    else if(dCenter.elem(b) < -margin) brickIndex.elem(b) = _farInside;
+    else brickIndex.elem(b) = n++;
+  }
+
+  //-- fill the allocated bricks (including their boundary layer)
+  brickData.resize(n, brickCorners);
+  arr corners(brickCorners, 3);
+  for(uint i=0; i<nb[0]; i++) for(uint j=0; j<nb[1]; j++) for(uint k=0; k<nb[2]; k++) {
+    int slot = brickIndex(i, j, k);
+    if(slot<0) continue;
+    for(uint a=0; a<S1; a++) for(uint b=0; b<S1; b++) for(uint c=0; c<S1; c++) {
+      double* x = &corners((a*S1+b)*S1+c, 0);
+      x[0] = lo(0) + (i*B+a)*voxelSize;
+      x[1] = lo(1) + (j*B+b)*voxelSize;
+      x[2] = lo(2) + (k*B+c)*voxelSize;
+    }
+    arr d = f.eval(corners);
+    float* data = &brickData(slot, 0);
+    for(uint m=0; m<brickCorners; m++) {
+      double dm = d.elem(m);
+      if(dm>band) dm=band;
+      if(dm<-band) dm=-band;
+      data[m] = dm;
+    }
+  }
+}
+
+namespace {
+/* evaluates a block of at most K points; the scalar pass locates bricks and gathers corner values,
+   the interpolation pass runs branch-free over the K lanes (structure-of-arrays), so that the compiler vectorizes it */
+constexpr uint K=8;
+
+void sparseGridBlock(const SDF_SparseGrid& sdf, const double* R, double* y, double* g, const double* X, uint n) {
+  const uint B=SDF_SparseGrid::brickSize, S1=B+1, S2=S1*S1;
+  const uint nb0=sdf.brickIndex.d0, nb1=sdf.brickIndex.d1, nb2=sdf.brickIndex.d2;
+  const double scale=1./sdf.voxelSize;
+  const double vmax[3] = { nb0*B-1e-6, nb1*B-1e-6, nb2*B-1e-6 };
+
+  alignas(64) double fx[K], fy[K], fz[K], mx[K], my[K], mz[K];
+  alignas(64) double bd[K], bx[K], by[K], bz[K];
+  alignas(64) double c[8][K];
+
+  for(uint l=0; l<K; l++) {
+    if(l>=n) { //padding lanes
+      fx[l]=fy[l]=fz[l]=mx[l]=my[l]=mz[l]=bd[l]=bx[l]=by[l]=bz[l]=0.;
+      for(uint m=0; m<8; m++) c[m][l]=0.;
+      continue;
+    }
+
+    //-- point in local coordinates
+    const double* x = X+3*l;
+    double p[3];
+    toLocal(p, R, sdf.pose, x);
+
+    //-- clip to the bounds; the distance to the bounding box is added (as in SDF_GridData)
+    double v[3], del[3], mask[3], boxSqr=0.;
+    for(uint i=0; i<3; i++) {
+      double vi = (p[i]-sdf.lo.p[i])*scale;
+      double vc = vi<0. ? 0. : (vi>vmax[i] ? vmax[i] : vi);
+      del[i] = (vi-vc)*sdf.voxelSize;
+      mask[i] = (vi==vc) ? scale : 0.; //no interpolation gradient along clipped axes
+      boxSqr += del[i]*del[i];
+      v[i] = vc;
+    }
+    double box = sqrt(boxSqr);
+    bd[l] = box;
+    if(box>0.) { bx[l]=del[0]/box; by[l]=del[1]/box; bz[l]=del[2]/box; }
+    else { bx[l]=by[l]=bz[l]=0.; }
+    mx[l]=mask[0]; my[l]=mask[1]; mz[l]=mask[2];
+
+    //-- brick lookup and gather
+    uint b0=uint(v[0])/B, b1=uint(v[1])/B, b2=uint(v[2])/B;
+    int slot = sdf.brickIndex.p[(b0*nb1+b1)*nb2+b2];
+    if(slot<0) {
+      double cst = (slot==SDF_SparseGrid::_farInside) ? -sdf.band : sdf.band;
+      for(uint m=0; m<8; m++) c[m][l]=cst;
+      fx[l]=fy[l]=fz[l]=0.;
+      continue;
+    }
+    double l0=v[0]-b0*B, l1=v[1]-b1*B, l2=v[2]-b2*B;
+    uint i0=uint(l0), i1=uint(l1), i2=uint(l2);
+    if(i0>=B) i0=B-1;
+    if(i1>=B) i1=B-1;
+    if(i2>=B) i2=B-1;
+    fx[l]=l0-i0; fy[l]=l1-i1; fz[l]=l2-i2;
+    const float* d = sdf.brickData.p + slot*SDF_SparseGrid::brickCorners + (i0*S1+i1)*S1+i2;
+    c[0][l]=d[0];  c[1][l]=d[S2];    c[2][l]=d[S1];    c[3][l]=d[S2+S1];
+    c[4][l]=d[1];  c[5][l]=d[S2+1];  c[6][l]=d[S1+1];  c[7][l]=d[S2+S1+1];
+  }
+
+  //-- trilinear interpolation and its gradient (vectorized over lanes)
+  alignas(64) double val[K], gx[K], gy[K], gz[K];
+  for(uint l=0; l<K; l++) {
+    double e00=c[1][l]-c[0][l], e10=c[3][l]-c[2][l], e01=c[5][l]-c[4][l], e11=c[7][l]-c[6][l];
+    double c00=c[0][l]+fx[l]*e00, c10=c[2][l]+fx[l]*e10, c01=c[4][l]+fx[l]*e01, c11=c[6][l]+fx[l]*e11;
+    double c0=c00+fy[l]*(c10-c00), c1=c01+fy[l]*(c11-c01);
+    double e0=e00+fy[l]*(e10-e00), e1=e01+fy[l]*(e11-e01);
+    double dy0=c10-c00, dy1=c11-c01;
+    val[l] = c0 + fz[l]*(c1-c0) + bd[l];
+    gx[l] = mx[l]*(e0 + fz[l]*(e1-e0)) + bx[l];
+    gy[l] = my[l]*(dy0 + fz[l]*(dy1-dy0)) + by[l];
+    gz[l] = mz[l]*(c1-c0) + bz[l];
+  }
+
+  for(uint l=0; l<n; l++) y[l]=val[l];
+  if(g) {
+    for(uint l=0; l<n; l++) {
+      double gLocal[3] = {gx[l], gy[l], gz[l]};
+      toWorld(g+3*l, R, gLocal);
+    }
+  }
+}
+}
+
+double SDF_SparseGrid::f(arr& g, arr& H, const arr& x) {
+  CHECK_EQ(x.N, 3, "");
+  double R[9], y, grad[3];
+  sparseGridBlock(*this, getRotation(R, pose), &y, grad, x.p, 1);
+  if(!!g) g = arr(grad, 3, false);
+  if(!!H) H.resize(3, 3).setZero();
+  return y;
+}
+
+void SDF_SparseGrid::evalBatch(arr& y, arr& g, const arr& X) {
+  checkBatch(y, g, X);
+  double R[9];
+  const double* Rp = getRotation(R, pose);
+  for(uint i=0; i<X.d0; i+=K) {
+    uint n = (X.d0-i<K) ? X.d0-i : K;
+    sparseGridBlock(*this, Rp, y.p+i, (!!g)?g.p+3*i:0, X.p+3*i, n);
+  }
+}
+
+void SDF_SparseGrid::write(std::ostream& os) const {
+  rai::Graph G;
+  G.add("lo", lo);
+  G.add("up", up);
+  G.add("voxelSize", voxelSize);
+  G.add("band", band);
+  G.add("brickIndex", brickIndex);
+  G.add("bricks", brickData.ref());
+  G.write(os, "\n", 0, -1, false, true);
+}
+
+void SDF_SparseGrid::read(std::istream& is) {
+  lo.readTagged(is, "lo");
+  up.readTagged(is, "up");
+  rai::parse(is, "voxelSize:");  is >>voxelSize;
+  rai::parse(is, "band:");  is >>band;
+  brickIndex.readTagged(is, "brickIndex");
+  brickData.readTagged(is, "bricks");
+  CHECK_EQ(brickData.d1, brickCorners, "brick size mismatch");
+}
+
+//===========================================================================
+
 double SDF_SuperQuadric::f(arr& g, arr& H, const arr& x) {
   double fx=0;
   if(!!g) g.resize(3).setZero();
@@ -545,6 +849,22 @@ double SDF_SuperQuadric::f(arr& g, arr& H, const arr& x) {
   return fx-1.;
 }
 
+void SDF_SuperQuadric::evalBatch(arr& y, arr& g, const arr& X) {
+  checkBatch(y, g, X);
+  const double s[3] = {size.elem(0), size.elem(1), size.elem(2)};
+  for(uint i=0; i<X.d0; i++) {
+    double fx=0.;
+    for(uint k=0; k<3; k++) {
+      double z=X.p[3*i+k]/s[k], sk=s[k];
+      if(z<0.) { z*=-1.; sk*=-1.; }
+      double zd1 = pow(z, degree-1.);
+      fx += zd1*z;
+      if(!!g) g.p[3*i+k] = degree*zd1/sk;
+    }
+    y.p[i] = fx-1.;
+  }
+}
+
 //===========================================================================
 
 ScalarFunction DistanceFunction_SSBox = [](arr& g, arr& H, const arr& x) -> double{
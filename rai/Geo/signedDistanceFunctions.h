@@ -12,6 +12,10 @@ struct SDF : ScalarFunction {
   ~SDF(){}
   virtual double f(arr& g, arr& H, const arr& x) = 0;
 
+  /// batched evaluation: X is (N x 3); y are the N values; g (if !!g) the (N x 3) gradients
+  /// (the default loops over f(); subclasses override this with allocation-free kernels)
+  virtual void evalBatch(arr& y, arr& g, const arr& X);
+
   arr eval(const arr& samples);
   floatA evalFloat(const arr& samples);
   void viewSlice(OpenGL& gl, double z, const arr& lo, const arr& hi);
@@ -26,6 +30,7 @@ struct SDF_Sphere : SDF {
   SDF_Sphere(const rai::Transformation& _pose, double _r)
     : pose(_pose), r(_r) {}
   double f(arr& g, arr& H, const arr& x);
+  void evalBatch(arr& y, arr& g, const arr& X);
 };
 
 struct SDF_ssBox : SDF {
@@ -35,6 +40,7 @@ struct SDF_ssBox : SDF {
   SDF_ssBox(const rai::Transformation& _pose, const arr& _size, double _r=0.)
       : pose(_pose), size(_size), r(_r) { if(size.N==4){ r=size(3); size.resizeCopy(3); } }
   double f(arr& g, arr& H, const arr& x);
+  void evalBatch(arr& y, arr& g, const arr& X);
 };
 
 struct SDF_SuperQuadric : SDF {
@@ -44,6 +50,7 @@ struct SDF_SuperQuadric : SDF {
   SDF_SuperQuadric(const rai::Transformation& _pose, const arr& _size, double _degree=5.)
     : pose(_pose), size(_size), degree(_degree) {}
   double f(arr& g, arr& H, const arr& x);
+  void evalBatch(arr& y, arr& g, const arr& X);
 };
 
 struct SDF_ssSomething : SDF {
@@ -59,6 +66,7 @@ struct SDF_Cylinder : SDF {
   SDF_Cylinder(const rai::Transformation& _pose, double _size_z, double _r)
     : pose(_pose), size_z(_size_z), r(_r) {}
   double f(arr& g, arr& H, const arr& x);
+  void evalBatch(arr& y, arr& g, const arr& X);
 };
 
 struct SDF_Capsule : SDF {
@@ -66,6 +74,7 @@ struct SDF_Capsule : SDF {
   SDF_Capsule(const rai::Transformation& _pose, double _size_z, double _r)
     : pose(_pose), size_z(_size_z), r(_r) {}
   double f(arr& g, arr& H, const arr& x);
+  void evalBatch(arr& y, arr& g, const arr& X);
 };
 
 struct SDF_Blobby : SDF {
@@ -100,6 +109,7 @@ struct SDF_GridData : SDF {
   SDF_GridData(istream& is) { read(is); }
 
   double f(arr& g, arr& H, const arr& x);
+  void evalBatch(arr& y, arr& g, const arr& X);
 
   //manipulations
   void resample(uint d0, int d1=-1, int d2=-1);
@@ -123,6 +133,39 @@ stdPipes(SDF_GridData)
 
 //===========================================================================
 
+/// sparse narrow-band grid: only bricks (of brickSize^3 voxels) that intersect the band around the surface store values;
+/// all other bricks are flagged as far outside (+band) or far inside (-band) in a coarse brick index
+struct SDF_SparseGrid : SDF {
+  static constexpr uint brickSize=8;
+  static constexpr uint brickCorners=(brickSize+1)*(brickSize+1)*(brickSize+1);
+  enum { _farOutside=-1, _farInside=-2 };
+
+  rai::Transformation pose=0;
+  arr lo, up;              ///< bounds of the represented region (in local coordinates)
+  double voxelSize=.01;    ///< resolution of the fine grid
+  double band=.05;         ///< values are clipped to [-band, band]; bricks further away are not allocated
+  intA brickIndex;         ///< coarse 3D table: index into brickData, or _farOutside/_farInside
+  floatA brickData;        ///< (#bricks x brickCorners) values; each brick stores its boundary layer, so interpolation never crosses bricks
+
+  SDF_SparseGrid() {}
+  SDF_SparseGrid(SDF& f, const arr& _lo, const arr& _up, double _voxelSize=.01, double _band=.05);
+  SDF_SparseGrid(istream& is) { read(is); }
+
+  double f(arr& g, arr& H, const arr& x);
+
+  void evalBatch(arr& y, arr& g, const arr& X);
+
+  uint getNumBricks() const { return brickData.d0; }
+  double getDenseSizeRatio() const { return double(brickData.N)/(double(brickIndex.N)*brickSize*brickSize*brickSize); }
+
+  //IO
+  void write(std::ostream& os) const;
+  void read(std::istream& is);
+};
+stdPipes(SDF_SparseGrid)
+
+//===========================================================================
+
 struct PCL2Field {
   SDF_GridData& field;
   floatA source;
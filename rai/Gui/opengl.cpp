@@ -1613,6 +1613,7 @@ OpenGL* OpenGL::newClone() const {
 
 void OpenGL::init() {
   drawFocus=false;
+  releasedBuffers = std::make_shared<OpenGLReleasedBuffers>();
   clearColor={1.,1.,1.};
   pressedkey=0;
   mouseposx=mouseposy=0;
@@ -1748,6 +1749,15 @@ void OpenGL::Draw(int w, int h, rai::Camera* cam, bool callerHasAlreadyLocked) {
     dataLock.lock(RAI_HERE); //now accessing user data
   }
 
+  //delete buffers that drawers released since the last draw (now that this context is current)
+  {
+    auto lock = releasedBuffers->mutex(RAI_HERE);
+    if(releasedBuffers->buffers.size()) {
+      glDeleteBuffers(releasedBuffers->buffers.size(), releasedBuffers->buffers.data());
+      releasedBuffers->buffers.clear();
+    }
+  }
+
   //clear bufferer
   GLint viewport[4] = {0, 0, w, h};
   glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
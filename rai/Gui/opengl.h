@@ -106,6 +106,15 @@ void read_png(byteA& img, const char* file_name, bool swap_rows);
 void write_png(const byteA& img, const char* file_name, bool swap_rows=true);
 
 
+//===========================================================================
+
+/// names of GL buffers released (e.g. by destroyed meshes) while the context they live in was not current --
+/// the OpenGL owning that context deletes them at its next draw
+struct OpenGLReleasedBuffers {
+  Mutex mutex;
+  std::vector<unsigned int> buffers;
+};
+
 //===========================================================================
 //
 // OpenGL class
@@ -168,6 +177,7 @@ struct OpenGL {
   Signaler isUpdating;
   Signaler watching;
   OpenGLDrawOptions drawOptions;
+  std::shared_ptr<OpenGLReleasedBuffers> releasedBuffers; ///< buffers of drawers (e.g. mesh VBOs) to be deleted at the next draw
 
   bool fullscreen; ///<window starts in fullscreenmode on the primary screen
   bool hideCameraControls; ///<camera can be tilted, rotated, zoomed in/out if controls are enabled
@@ -16,6 +16,8 @@
 #include "../Kin/switch.h"
 #include "../Kin/proxy.h"
 #include "../Kin/forceExchange.h"
+#include "../Kin/dof_particles.h"
+#include "../Kin/dof_path.h"
 //#include "../Kin/kin_swift.h"
 #include "../Kin/kin_physx.h"
 #include "../Kin/F_qFeatures.h"
@@ -32,10 +34,13 @@
 #include "../Optim/opt-ceres.h"
 
 #include "../Core/util.ipp"
+#include "../Core/thread.h"
 
 #include "pathTools.h"
 
 #include <iomanip>
+#include <map>
+#include <algorithm>
 
 #ifdef RAI_GL
 #  include <GL/gl.h>
@@ -110,6 +115,8 @@ void KOMO::setModel(const Configuration& C, bool _computeCollisions) {
     world.fcl();
   }
   world.ensure_q();
+  fclShared.reset(); //(the static broadphase and per-slice copies are recreated on the next query)
+  sliceFcl.clear();
 }
 
 void KOMO::setTiming(double _phases, uint _stepsPerPhase, double durationPerPhase, uint _k_order) {
@@ -117,6 +124,7 @@ void KOMO::setTiming(double _phases, uint _stepsPerPhase, double durationPerPhas
   T = ceil(stepsPerPhase*_phases);
   tau = durationPerPhase/double(stepsPerPhase);
   k_order = _k_order;
+  sliceFcl.clear();
 }
 
 void KOMO::clone(const KOMO& komo, bool deepCopyFeatures){
@@ -130,6 +138,7 @@ void KOMO::clone(const KOMO& komo, bool deepCopyFeatures){
   k_order = komo.k_order;
 
   if(komo.fcl) fcl=komo.fcl;
+  fclShared = komo.fclShared;
   //if(komo.swift) swift=komo.swift;
 
   //directly copy pathConfig instead of recreating it (including switches)
@@ -707,11 +716,11 @@ void KOMO::getConfiguration_full(Configuration& C, int t, int verbose){
 }
 
 arr KOMO::getConfiguration_qOrg(int t) {
-  return pathConfig.getDofState(pathConfig.getDofs(pathConfig.getFrames(orgJointIndices + timeSlices(k_order+t,0)->ID), false));
+  return pathConfig.getDofState(pathConfig.getDofs(timeSlices[k_order+t].sub(orgJointIndices), false));
 }
 
 void KOMO::setConfiguration_qOrg(int t, const arr& q) {
-  pathConfig.setDofState(q, pathConfig.getDofs(pathConfig.getFrames(orgJointIndices + timeSlices(k_order+t,0)->ID), false));
+  pathConfig.setDofState(q, pathConfig.getDofs(timeSlices[k_order+t].sub(orgJointIndices), false));
 }
 
 
@@ -822,7 +831,7 @@ void KOMO::initPhaseWithDofsPath(uint t_phase, const uintA& dofIDs, const arr& p
   }
   CHECK_EQ(path.d0, stepsPerPhase, "given path is of wrong length");
   for(uint tt=0;tt<path.d0-1;tt++){
-    pathConfig.setJointState(path[tt], dofIDs + (k_order+stepsPerPhase*t_phase+tt)*timeSlices.d1);
+    pathConfig.setJointState(path[tt], timeSlices[k_order+stepsPerPhase*t_phase+tt].sub(dofIDs));
   }
 }
 
@@ -905,21 +914,21 @@ uintA KOMO::initWithWaypoints(const arrA& waypoints, uint waypointStepsPerPhase,
     }
 #else
     if(t1-1<T) {
-      getDofsAndSignFromFramePairs(dofs, signs, pathConfig.getFrames(F.frames + timeSlices(k_order+t0,0)->ID));
+      getDofsAndSignFromFramePairs(dofs, signs, timeSlices[k_order+t0].sub(F.frames));
       arr q0 = signs%pathConfig.getDofState(dofs);
-      getDofsAndSignFromFramePairs(dofs, signs, pathConfig.getFrames(F.frames + timeSlices(k_order+t1,0)->ID));
+      getDofsAndSignFromFramePairs(dofs, signs, timeSlices[k_order+t1].sub(F.frames));
       arr q1 = signs%pathConfig.getDofState(dofs);
       //TODO: check if all dofs are rotational joints!
       makeMod2Pi(q0, q1);
       pathConfig.setDofState(signs%q1, dofs);
-//      arr q0 = qfeat.eval(pathConfig.getFrames(F.frames + timeSlices(k_order+t0,0)->ID));  q0.J_reset();
-//      arr q1 = qfeat.eval(pathConfig.getFrames(F.frames + timeSlices(k_order+t1,0)->ID));  q1.J_reset();
+//      arr q0 = qfeat.eval(timeSlices[k_order+t0].sub(F.frames));  q0.J_reset();
+//      arr q1 = qfeat.eval(timeSlices[k_order+t1].sub(F.frames));  q1.J_reset();
       for(uint t=t0+1; t<t1; t++) {
         double phase = double(t-t0)/double(t1-t0);
         arr q = q0 + (.5*(1.-cos(RAI_PI*phase))) * (q1-q0); //p = p0 + phase * (p1-p0);
-        getDofsAndSignFromFramePairs(dofs, signs, pathConfig.getFrames(F.frames + timeSlices(k_order+t,0)->ID));
+        getDofsAndSignFromFramePairs(dofs, signs, timeSlices[k_order+t].sub(F.frames));
         pathConfig.setDofState(signs%q, dofs);
-//        setQByPairs(pathConfig, pathConfig.getFrames(F.frames + timeSlices(k_order+t,0)->ID), q);
+//        setQByPairs(pathConfig, timeSlices[k_order+t].sub(F.frames), q);
         //view(true, STRING("interpolating: step:" <<i <<" t: " <<t));
       }
     }
@@ -966,9 +975,9 @@ void KOMO::straightenCtrlFrames_mod2Pi(){
   arr signs;
   DofL dofs;
   for(uint t=0;t<T-1;t++) {
-    getDofsAndSignFromFramePairs(dofs, signs, pathConfig.getFrames(F.frames + timeSlices(k_order+t,0)->ID));
+    getDofsAndSignFromFramePairs(dofs, signs, timeSlices[k_order+t].sub(F.frames));
     arr q0 = signs%pathConfig.getDofState(dofs);
-    getDofsAndSignFromFramePairs(dofs, signs, pathConfig.getFrames(F.frames + timeSlices(k_order+t+1,0)->ID));
+    getDofsAndSignFromFramePairs(dofs, signs, timeSlices[k_order+t+1].sub(F.frames));
     arr q1 = signs%pathConfig.getDofState(dofs);
     //TODO: check if all dofs are rotational joints!
     makeMod2Pi(q0, q1);
@@ -1022,12 +1031,13 @@ void KOMO::updateRootObjects(const Configuration& C){
   arr X0 = C.getFrameState(roots);
   world.setFrameState(X0, roots);
   //set t=0..T to new frame state:
-  for(uint t=0; t<T; t++) pathConfig.setFrameState(X0, roots+timeSlices(k_order+t,0)->ID);
+  for(uint t=0; t<T; t++) pathConfig.setFrameState(X0, timeSlices[k_order+t].sub(roots));
   //shift the frame states within the prefix (t=-1 becomes equal to t=0, which is new state)
   for(int t=-k_order; t<0; t++){
-    arr Xt = pathConfig.getFrameState(roots+timeSlices(k_order+t+1,0)->ID);
-    pathConfig.setFrameState(Xt, roots+timeSlices(k_order+t,0)->ID);
+    arr Xt = pathConfig.getFrameState(timeSlices[k_order+t+1].sub(roots));
+    pathConfig.setFrameState(Xt, timeSlices[k_order+t].sub(roots));
   }
+  fclShared.reset(); //(static frames might have moved)
 }
 
 void KOMO::updateAndShiftPrefix(const Configuration& C){
@@ -1046,6 +1056,7 @@ void KOMO::reset() {
   featureJacobians.clear();
   featureTypes.clear();
   timeTotal=timeCollisions=timeKinematics=timeNewton=timeFeatures=0.;
+  for(shared_ptr<GroundedObjective>& ob:objs) { ob->evalCalls=0; ob->evalTime=0.; }
 }
 
 void KOMO::optimize(double addInitializationNoise, const OptOptions options) {
@@ -1260,7 +1271,7 @@ int KOMO::view(bool pause, const char* txt){
 
 int KOMO::view_play(bool pause, double delay, const char* saveVideoPath){
   view(false, 0);
-  return pathConfig.viewer()->playVideo(timeSlices.d0, timeSlices.d1, pause, delay*tau*T, saveVideoPath);
+  return pathConfig.viewer()->playVideo(framesToIndices(timeSlices), pause, delay*tau*T, saveVideoPath);
 }
 
 void KOMO::view_close(){ pathConfig.view_close(); }
@@ -1361,6 +1372,17 @@ rai::Frame* KOMO::applySwitch(const KinematicSwitch& sw) {
   //    if(sw.timeOfTermination>=0)  sEnd = sw.timeOfTermination+(int)k_order;
   CHECK(s<=sEnd, "s:" <<s <<" sEnd:" <<sEnd);
   if(s==sEnd) return 0;
+  if(opt.shareStaticFrames){ //the switch modifies frames in each slice -> these can't be shared anymore
+    FrameL F;
+    if(sw.symbol==SW_joint || sw.symbol==SW_noJointLink) F.append(timeSlices(s, sw.toId)->getPathToUpwardLink(true).first()); //(the link is re-rooted)
+    else {
+      if(sw.fromId!=-1) F.append(timeSlices(s, sw.fromId));
+      if(sw.toId!=-1) F.append(timeSlices(s, sw.toId));
+    }
+    unshareFrames(F);
+    fclShared.reset();
+    sliceFcl.clear();
+  }
   rai::Frame *f0=0, *f=0;
   for(; s<sEnd; s++) { //apply switch on all configurations!
     f = sw.apply(timeSlices[s].noconst());
@@ -1391,6 +1413,7 @@ void KOMO::retrospectApplySwitches() {
 
 void KOMO::retrospectChangeJointType(int startStep, int endStep, uint frameID, JointType newJointType) {
   uint s = startStep+k_order;
+  if(opt.shareStaticFrames) unshareFrames({timeSlices(s, frameID)});
   //apply the same switch on all following configurations!
   for(; s<endStep+k_order; s++) {
     rai::Frame* f = timeSlices(s, frameID);
@@ -1398,21 +1421,100 @@ void KOMO::retrospectChangeJointType(int startStep, int endStep, uint frameID, J
   }
 }
 
+intA KOMO::getFrameSlices(){
+  intA frameSlices(pathConfig.frames.N);
+  frameSlices = -2;
+  for(uint s=0; s<timeSlices.d0; s++) for(uint i=0; i<timeSlices.d1; i++) {
+    frameSlices(timeSlices(s, i)->ID) = isSharedFrame(i) ? -1 : (int)s;
+  }
+  //frames added by switches are not in timeSlices: they belong to the slice of their parent, or else of their children
+  for(rai::Frame* f:pathConfig.frames) if(frameSlices(f->ID)==-2) {
+    int s = f->parent ? frameSlices(f->parent->ID) : -1;
+    if(s<0) for(rai::Frame* ch:f->children) if(frameSlices(ch->ID)>=0) { s = frameSlices(ch->ID); break; }
+    frameSlices(f->ID) = s<0 ? -1 : s;
+  }
+  return frameSlices;
+}
+
+void KOMO::unshareFrames(const FrameL& F){
+  //world index of each shared frame
+  intA worldIndex(pathConfig.frames.N);
+  worldIndex = -1;
+  for(uint i=0; i<timeSlices.d1; i++) if(isSharedFrame(i)) worldIndex(timeSlices(0, i)->ID) = i;
+
+  //the given shared frames and their (shared) subtrees
+  uintA unshare;
+  for(rai::Frame* f:F) if(worldIndex(f->ID)>=0) {
+    FrameL subtree = {f};
+    f->getSubtree(subtree);
+    for(rai::Frame* g:subtree) if(worldIndex(g->ID)>=0) unshare.setAppend(worldIndex(g->ID));
+  }
+  if(!unshare.N) return;
+
+  intA frameSlices = getFrameSlices();
+
+  //slice 0 keeps the original, all other slices get a copy
+  FrameL orig = timeSlices[0].sub(unshare);
+  for(uint s=1; s<timeSlices.d0; s++) {
+    for(uint i:unshare) {
+      rai::Frame* f = new rai::Frame(pathConfig, timeSlices(0, i));
+      f->prev = timeSlices(s-1, i);
+      timeSlices(s, i) = f;
+    }
+    for(uint i:unshare) {
+      rai::Frame *f = timeSlices(s, i), *p = timeSlices(0, i)->parent;
+      if(p) f->setParent(worldIndex(p->ID)>=0 && unshare.contains(worldIndex(p->ID)) ? timeSlices(s, worldIndex(p->ID)) : p);
+    }
+  }
+
+  //frames of the slices that are attached to an original are moved to the copy of their slice
+  for(uint k=0; k<unshare.N; k++) {
+    for(rai::Frame* ch:FrameL(orig(k)->children)) {
+      int s = frameSlices(ch->ID);
+      if(s>0) { ch->unLink(); ch->setParent(timeSlices(s, unshare(k))); }
+    }
+  }
+
+  //grounded objectives refer to the frames of their slices
+  for(shared_ptr<GroundedObjective>& o:objs) {
+    uint n = o->frames.N/o->frames.d0;
+    for(uint i=0; i<o->frames.d0; i++) {
+      int s = o->timeSlices(i)+k_order;
+      if(s<=0) continue;
+      for(uint j=0; j<n; j++) {
+        rai::Frame*& f = o->frames.elem(i*n+j);
+        int k = orig.findValue(f);
+        if(k>=0) f = timeSlices(s, unshare(k));
+      }
+    }
+  }
+
+  pathConfig.reset_q();
+}
+
 void KOMO::selectJointsBySubtrees(const StringA& roots, const arr& times, bool notThose){
   uintA rootIds = world.getFrameIDs(roots);
 
   world.selectJointsBySubtrees(world.getFrames(rootIds), notThose);
 
-  FrameL allRoots;
-
+  uintA slices;
   if(!times.N) {
-    for(uint s=0;s<timeSlices.d0;s++) allRoots.append( pathConfig.getFrames(rootIds+s*timeSlices.d1) );
+    slices = range(timeSlices.d0);
   } else {
     int tfrom = conv_time2step(times(0), stepsPerPhase);
     int tto   = conv_time2step(times(1), stepsPerPhase);
-    for(int t=tfrom;t<=tto;t++) allRoots.append( pathConfig.getFrames(rootIds+(t+k_order)*timeSlices.d1) );
+    for(int t=tfrom;t<=tto;t++) slices.append(t+k_order);
+  }
+
+  //the subtrees of the roots within the selected slices (a shared root's subtree contains frames of all slices)
+  intA frameSlices = getFrameSlices();
+  FrameL F;
+  for(uint s:slices) for(rai::Frame* root:timeSlices[s].sub(rootIds)) {
+    FrameL subtree = {root};
+    root->getSubtree(subtree);
+    for(rai::Frame* f:subtree) if(frameSlices(f->ID)==(int)s || frameSlices(f->ID)==-1) F.append(f);
   }
-  pathConfig.selectJointsBySubtrees(allRoots, notThose);
+  pathConfig.selectJoints(F, notThose);
   pathConfig.ensure_q();
   pathConfig.checkConsistency();
 }
@@ -1420,6 +1522,35 @@ void KOMO::selectJointsBySubtrees(const StringA& roots, const arr& times, bool n
 
 //===========================================================================
 
+/// adds nSlices slices of C to pathConfig, but frames without dofs upstream (and without forces) only once -- all slices refer to those;
+/// returns the (nSlices, C.frames.N) matrix of slice frames
+static FrameL addSlicesSharingStaticFrames(rai::Configuration& pathConfig, const rai::Configuration& C, uint nSlices) {
+  auto isStatic = [](rai::Frame* f) {
+    for(; f; f=f->parent) {
+      if(f->forces.N) return false;
+      rai::Dof* dofs[3] = {f->joint, f->particleDofs, f->pathDof};
+      for(rai::Dof* d:dofs) if(d && d->dim) return false;
+    }
+    return true;
+  };
+  FrameL sliced, shared, sharedCopies(C.frames.N);
+  for(rai::Frame* f:C.frames) { if(isStatic(f)) shared.append(f); else sliced.append(f); }
+
+  uint n = pathConfig.frames.N;
+  if(shared.N) pathConfig.addCopies(shared, {});
+  for(uint i=0; i<shared.N; i++) sharedCopies(shared(i)->ID) = pathConfig.frames.elem(n+i);
+
+  FrameL timeSlices(nSlices, C.frames.N);
+  for(uint s=0; s<nSlices; s++) {
+    n = pathConfig.frames.N;
+    if(sliced.N) pathConfig.addCopies(sliced, C.otherDofs, sharedCopies);
+    for(uint i=0; i<sliced.N; i++) timeSlices(s, sliced(i)->ID) = pathConfig.frames.elem(n+i);
+    for(rai::Frame* f:shared) timeSlices(s, f->ID) = sharedCopies(f->ID);
+  }
+  pathConfig.frames.reshape(pathConfig.frames.N); //(not a matrix of slices)
+  return timeSlices;
+}
+
 void KOMO::setupPathConfig() {
   //IMPORTANT: The configurations need to include the k prefix configurations!
   //Therefore configurations(0) is for time=-k and configurations(k+t) is for time=t
@@ -1438,23 +1569,29 @@ void KOMO::setupPathConfig() {
     //CHECK(!swift, "");
     //if(!opt.useFCL) swift = C.swift();
     fcl = C.fcl();
+    fclShared.reset();
+    sliceFcl.clear();
   }
 
-  for(uint s=0;s<k_order+T;s++) {
-//    for(KinematicSwitch* sw:switches) { //apply potential switches
-//      if(sw.timeOfApplication+(int)k_order==(int)s)  sw.apply(C.frames);
-//    }
-
-//    uint nBefore = pathConfig.frames.N;
-    pathConfig.addCopies(C.frames, C.otherDofs);
-//    timeSlices[s] = pathConfig.frames({nBefore, -1});
+  if(opt.shareStaticFrames) {
+    timeSlices = addSlicesSharingStaticFrames(pathConfig, C, k_order+T);
+  } else {
+    for(uint s=0;s<k_order+T;s++) {
+//      for(KinematicSwitch* sw:switches) { //apply potential switches
+//        if(sw.timeOfApplication+(int)k_order==(int)s)  sw.apply(C.frames);
+//      }
 
+//      uint nBefore = pathConfig.frames.N;
+      pathConfig.addCopies(C.frames, C.otherDofs);
+//      timeSlices[s] = pathConfig.frames({nBefore, -1});
+    }
+    timeSlices = pathConfig.frames;
   }
-  timeSlices = pathConfig.frames;
 
   //deactivate prefix dofs
   pathConfig.calc_indexedActiveJoints();
-  uint firstID = timeSlices(k_order, 0)->ID;
+  uint firstID = pathConfig.frames.N; //(first frame of slice k_order that is not shared)
+  for(uint i=0; i<timeSlices.d1; i++) if(!isSharedFrame(i) && timeSlices(k_order, i)->ID<firstID) firstID = timeSlices(k_order, i)->ID;
   for(Dof* dof:pathConfig.activeDofs){
     if(dof->frame->ID < firstID){
       if(!dof->mimicers.N) dof->active=false;
@@ -1495,6 +1632,29 @@ void KOMO::checkBounds(const arr& x) {
   boundCheck(x, bound_lo, bound_up);
 }
 
+/// indices (within a slice) of frames that have no active dof upstream and the same pose in all (non-prefix) slices
+static uintA getStaticFrames(rai::Configuration& C, const FrameL& timeSlices, uint k_order) {
+  auto moves = [](rai::Frame* f) {
+    for(; f; f=f->parent) {
+      rai::Dof* dofs[3] = {f->joint, f->particleDofs, f->pathDof};
+      for(rai::Dof* d:dofs) if(d && d->dim && (d->active || (d->mimic && d->mimic->active))) return true;
+    }
+    return false;
+  };
+  boolA isStatic(timeSlices.d1);
+  isStatic = true;
+  arr X0 = C.getFrameState(timeSlices[k_order]);
+  for(uint s=k_order; s<timeSlices.d0; s++) {
+    arr X = C.getFrameState(timeSlices[s]);
+    for(uint i=0; i<timeSlices.d1; i++) if(isStatic(i)) {
+      if(moves(timeSlices(s, i)) || maxDiff(X[i], X0[i])>1e-10) isStatic(i)=false;
+    }
+  }
+  uintA ids;
+  for(uint i=0; i<isStatic.N; i++) if(isStatic(i)) ids.append(i);
+  return ids;
+}
+
 void KOMO::set_x(const arr& x, const uintA& selectedConfigurationsOnly) {
   CHECK_EQ(timeSlices.d0, k_order+T, "configurations are not setup yet");
 
@@ -1509,21 +1669,57 @@ void KOMO::set_x(const arr& x, const uintA& selectedConfigurationsOnly) {
 
   timeKinematics += rai::cpuTime();
 
-  if(computeCollisions) {
+  if(computeCollisions && opt.shareStaticFrames && !fclShared) {
+    //static frames are identified (after switches have been applied) and moved into a single broadphase that all slices share
+    //(fcl itself is shared with world and the model configuration and stays complete, so this is redone when roots move or switches are added)
+    fclShared = make_shared<rai::FclInterface>(*fcl);
+    fclShared->setStaticObjects(getStaticFrames(pathConfig, timeSlices, k_order), pathConfig.getFrameState(timeSlices[k_order]));
+    sliceFcl.clear();
+  }
+
+  //fcl returns frame IDs related to 'world' -> map them into frameIDs within that time slice
+  //(a pair of shared frames is the same in all slices: it is added once, with the first slice)
+  auto addSliceProxies = [this](uint s, const uintA& collisionPairs) {
+    uintA P(collisionPairs.d0, 2);
+    uint n=0;
+    for(uint k=0; k<collisionPairs.d0; k++) {
+      uint a=collisionPairs(k, 0), b=collisionPairs(k, 1);
+      if(s>k_order && isSharedFrame(a) && isSharedFrame(b)) continue;
+      P(n, 0) = timeSlices(s, a)->ID;
+      P(n, 1) = timeSlices(s, b)->ID;
+      n++;
+    }
+    P.resizeCopy(n, 2);
+    pathConfig.addProxies(P);
+  };
+
+  if(computeCollisions && opt.parallelCollisions) {
+    timeCollisions -= rai::realTime(); //wall time, as the queries run on several threads
+    //each slice has its own collision manager, which only re-runs the query if the slice's frames moved
+    if(sliceFcl.N!=timeSlices.d0) {
+      sliceFcl.clear();
+      sliceFcl.resize(timeSlices.d0);
+      for(uint s=k_order;s<timeSlices.d0;s++) sliceFcl(s) = make_shared<rai::FclInterface>(fclShared ? *fclShared : *fcl);
+    }
+    arrA X(timeSlices.d0);
+    for(uint s=k_order;s<timeSlices.d0;s++) X(s) = pathConfig.getFrameState(timeSlices[s]);
+    parallel_for(k_order, timeSlices.d0, [&](uint s) { sliceFcl(s)->step(X(s)); }, 1);
+
+    pathConfig.proxies.clear();
+    for(uint s=k_order;s<timeSlices.d0;s++) addSliceProxies(s, sliceFcl(s)->collisions);
+    pathConfig._state_proxies_isGood=true;
+    timeCollisions += rai::realTime();
+  } else if(computeCollisions) {
     timeCollisions -= rai::cpuTime();
+    rai::FclInterface& F = fclShared ? *fclShared : *fcl;
     pathConfig.proxies.clear();
     arr X;
-    uintA collisionPairs;
     for(uint s=k_order;s<timeSlices.d0;s++){
       X = pathConfig.getFrameState(timeSlices[s]);
       //if(!opt.useFCL){
       //  collisionPairs = swift->step(X);
-      {
-        fcl->step(X);
-        collisionPairs = fcl->collisions;
-      }
-      collisionPairs += timeSlices.d1 * s; //fcl returns frame IDs related to 'world' -> map them into frameIDs within that time slice
-      pathConfig.addProxies(collisionPairs);
+      F.step(X);
+      addSliceProxies(s, F.collisions);
     }
     pathConfig._state_proxies_isGood=true;
     pathConfig.ensure_proxies(); //expensive!!
@@ -1545,10 +1741,11 @@ shared_ptr<NLP> KOMO::nlp(){
 
 shared_ptr<NLP_Factored> KOMO::nlp_FactoredTime(){
   rai::Array<DofL> dofs(T);
+  intA frameSlices = getFrameSlices();
   for(rai::Dof* d: pathConfig.activeDofs){ //go through all active dofs and sort them in time slices
     if(d->mimic) continue; //remove mimics
-    int t = int(d->frame->ID/timeSlices.d1) - int(k_order);
-    if(t>=int(T)) t = int(d->frame->parent->ID/timeSlices.d1) - int(k_order);
+    CHECK_GE(frameSlices(d->frame->ID), 0, "active dof '" <<d->name() <<"' on a shared frame");
+    int t = frameSlices(d->frame->ID) - int(k_order);
     CHECK(t<int(T), "hmm");
     if(t>=0) dofs(t).append(d);
   }
@@ -1571,11 +1768,15 @@ rai::Graph KOMO::getReport(bool gnuplt, int reportFeatures, std::ostream& featur
   arr taskG=zeros(objectives.N);
   arr taskH=zeros(objectives.N);
   arr taskF=zeros(objectives.N);
+  arr evalCalls=zeros(objectives.N);
+  arr evalTime=zeros(objectives.N);
   uint M=0;
   for(shared_ptr<GroundedObjective>& ob:objs) {
     uint d = ob->feat->dim(ob->frames);
     int i = ob->objId;
     CHECK_GE(i, 0, "");
+    evalCalls(i) += ob->evalCalls;
+    evalTime(i) += ob->evalTime;
     uint time = ob->timeSlices.last();
     //          for(uint j=0; j<d; j++) CHECK_EQ(featureTypes(M+j), ob->type, "");
     if(d) {
@@ -1620,6 +1821,10 @@ rai::Graph KOMO::getReport(bool gnuplt, int reportFeatures, std::ostream& featur
     if(taskG(i)) g.add<double>("ineq", taskG(i));
     if(taskH(i)) g.add<double>("eq", taskH(i));
     if(taskF(i)) g.add<double>("f", taskF(i));
+    if(evalCalls(i)) {
+      g.add<double>("evalCalls", evalCalls(i));
+      g.add<double>("evalTime", evalTime(i));
+    }
     totalC += taskC(i);
     totalG += taskG(i);
     totalH += taskH(i);
@@ -1630,6 +1835,32 @@ rai::Graph KOMO::getReport(bool gnuplt, int reportFeatures, std::ostream& featur
   report.add<double>("eq", totalH);
   report.add<double>("f", totalF);
 
+  //-- evaluation cost per feature type (FeatureSymbol, or class name of features without symbol), most expensive first
+  if(sum(evalCalls)) {
+    std::map<String, arr> costs; //calls, time
+    for(uint i=0; i<objectives.N; i++) {
+      shared_ptr<Feature>& f = objectives(i)->feat;
+      String key = (f->fs==FS_none ? niceTypeidName(typeid(*f)) : Enum<FeatureSymbol>(f->fs).name());
+      arr& c = costs[key];
+      if(!c.N) c = zeros(2);
+      c(0) += evalCalls(i);
+      c(1) += evalTime(i);
+    }
+    std::vector<const std::pair<const String, arr>*> sorted; //(sort pointers: arrays must not be moved by the sort)
+    for(const auto& c:costs) sorted.push_back(&c);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) { return a->second(1)>b->second(1); });
+    double total = sum(evalTime);
+    Graph& g = report.addSubgraph("evalCosts");
+    for(const auto* c:sorted) {
+      Graph& gc = g.addSubgraph(c->first);
+      gc.add<double>("calls", c->second(0));
+      gc.add<double>("time", c->second(1));
+      if(c->second(0)) gc.add<double>("timePerCall", c->second(1)/c->second(0));
+      if(total>0.) gc.add<double>("share", c->second(1)/total);
+    }
+    report.add<double>("evalTime", total);
+  }
+
   if(gnuplt) {
     //-- write a nice gnuplot file
     ofstream fil("z.costReport");
@@ -1748,6 +1979,9 @@ StringA KOMO::getCollisionPairs(double belowMargin){
   uint nFrames = world.frames.N;
   CHECK_EQ(nFrames, timeSlices.d1, "");
   intAA collisions(nFrames);
+  intA worldIndex(pathConfig.frames.N);
+  worldIndex = -1;
+  for(uint s=0; s<timeSlices.d0; s++) for(uint i=0; i<nFrames; i++) worldIndex(timeSlices(s, i)->ID) = i;
 
   for(const Proxy& p:pathConfig.proxies) {
     //early check: if proxy is way out of collision, don't bother computing it precise
@@ -1757,8 +1991,9 @@ StringA KOMO::getCollisionPairs(double belowMargin){
     double d = p.collision->getDistance();
     if(d<belowMargin){
 //      cout <<"KOMO collision pair: " <<p.a->name <<"--" <<p.b->name <<" : " <<p.d <<endl;
-      uint i=p.a->ID % nFrames;
-      uint j=p.b->ID % nFrames;
+      int i=worldIndex(p.a->ID);
+      int j=worldIndex(p.b->ID);
+      if(i<0 || j<0) continue; //(frames added by switches)
       if(j<i){ int a=i; i=j; j=a; }
       collisions(i).setAppendInSorted(j);
     }
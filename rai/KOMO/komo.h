@@ -32,6 +32,8 @@ namespace rai {
     RAI_PARAM("KOMO/", int, animateOptimization, 0)
     RAI_PARAM("KOMO/", bool, mimicStable, true)
     RAI_PARAM("KOMO/", bool, useFCL, true)
+    RAI_PARAM("KOMO/", bool, parallelCollisions, false) //per-slice collision managers, stepped concurrently; unchanged slices are skipped
+    RAI_PARAM("KOMO/", bool, shareStaticFrames, false) //frames without dofs upstream exist once in pathConfig, referenced by all slices; frames that never move enter the collision broadphase once
     RAI_PARAM("KOMO/", bool, unscaleEqIneqReport, false)
   };
 }//namespace
@@ -51,9 +53,11 @@ struct KOMO : NonCopyable {
   rai::Configuration world;       ///< original configuration; which is the blueprint for all time-slice worlds (almost const: only makeConvexHulls modifies it)
   rai::Configuration pathConfig;  ///< configuration containing full path (T+k_order copies of world, with switches applied)
   uintA orgJointIndices;          ///< set of joint IDs (IDs of frames with dofs) of the original world
-  FrameL timeSlices;              ///< the original timeSlices of the pathConfig (when switches add frames, pathConfig.frames might differ from timeSlices - otherwise not)
+  FrameL timeSlices;              ///< the original timeSlices of the pathConfig (when switches add frames or with opt.shareStaticFrames, pathConfig.frames differs from timeSlices - otherwise not)
   bool computeCollisions;         ///< whether swift or fcl (collisions/proxies) is evaluated whenever new configurations are set (needed if features read proxy list)
   shared_ptr<rai::FclInterface> fcl;
+  rai::Array<shared_ptr<rai::FclInterface>> sliceFcl; ///< per time slice copies of fcl (only with opt.parallelCollisions; cleared whenever fcl or the time slices are rebuilt)
+  shared_ptr<rai::FclInterface> fclShared; ///< copy of fcl with the static frames in one broadphase shared by all slices (only with opt.shareStaticFrames; recreated when roots moved or switches were added)
   //shared_ptr<SwiftInterface> swift;
 
   //-- optimizer
@@ -190,7 +194,7 @@ public:
   arr getActiveConstraintJacobian();
 
   void reportProblem(ostream& os=std::cout);
-  rai::Graph getReport(bool gnuplt=false, int reportFeatures=0, ostream& featuresOs=std::cout); ///< return a 'dictionary' summarizing the optimization results (optional: gnuplot objective costs; output detailed cost features per time slice)
+  rai::Graph getReport(bool gnuplt=false, int reportFeatures=0, ostream& featuresOs=std::cout); ///< return a 'dictionary' summarizing the optimization results, incl. evaluation calls/time per objective and feature type (optional: gnuplot objective costs; output detailed cost features per time slice)
   rai::Graph getProblemGraph(bool includeValues, bool includeSolution=true);
   double getConstraintViolations();
   double getCosts();
@@ -217,6 +221,9 @@ public:
   rai::Frame* applySwitch(const rai::KinematicSwitch& sw);
   void retrospectApplySwitches();
   void retrospectChangeJointType(int startStep, int endStep, uint frameID, rai::JointType newJointType);
+  bool isSharedFrame(uint i) const { return timeSlices.d0>1 && timeSlices(0, i)==timeSlices(1, i); } ///< whether the i-th frame of world is a single frame referenced by all slices (see opt.shareStaticFrames)
+  void unshareFrames(const FrameL& F);    ///< replaces shared frames (and their shared subtrees) by copies in each slice
+  intA getFrameSlices();                  ///< slice of each frame of pathConfig (frames added by switches: the slice of their parent; shared frames: -1)
   void set_x(const arr& x, const uintA& selectedConfigurationsOnly={});            ///< set the state trajectory of all configurations
   void checkConsistency();
 
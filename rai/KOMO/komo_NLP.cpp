@@ -3,6 +3,7 @@
 #include "../Kin/frame.h"
 #include "../Kin/proxy.h"
 #include "../Kin/forceExchange.h"
+#include "../Core/profiler.h"
 
 namespace rai{
 
@@ -27,6 +28,7 @@ void reportAfterPhiComputation(KOMO& komo) {
 //===========================================================================
 
 void Conv_KOMO_NLP::evaluate(arr& phi, arr& J, const arr& x) {
+  RAI_PROFILE("Conv_KOMO_NLP::evaluate");
   komo.evalCount++;
 
   //-- set the trajectory
@@ -53,7 +55,10 @@ void Conv_KOMO_NLP::evaluate(arr& phi, arr& J, const arr& x) {
   uint M=0;
   for(shared_ptr<GroundedObjective>& ob : komo.objs) {
       //query the task map and check dimensionalities of returns
+      double time = -rai::realTime();
       arr y = ob->feat->eval(ob->frames);
+      ob->evalTime += time + rai::realTime();
+      ob->evalCalls++;
 //      cout <<"EVAL '" <<ob->name() <<"' phi:" <<y <<endl <<y.J() <<endl<<endl;
       if(!y.N) continue;
       checkNan(y);
@@ -169,6 +174,7 @@ Conv_KOMO_FactoredNLP::Conv_KOMO_FactoredNLP(KOMO& _komo, const rai::Array<DofL>
   uint xDim=0;
   DofL activeDofs;
   uintA xIndex2varIndex;
+  intA frameSlices = komo.getFrameSlices();
   __variableIndex.resize(varDofs.N);
   for(uint i=0;i<varDofs.N;i++) {
     DofL& dofs = varDofs(i);
@@ -186,8 +192,8 @@ Conv_KOMO_FactoredNLP::Conv_KOMO_FactoredNLP(KOMO& _komo, const rai::Array<DofL>
 
     //variable name
     String name;
-    String A; A <<dofs(0)->frame->name <<'.' <<(int(dofs(0)->frame->ID/komo.timeSlices.d1) - int(komo.k_order));
-    String B; B <<dofs(-1)->frame->name <<'.' <<(int(dofs(-1)->frame->ID/komo.timeSlices.d1) - int(komo.k_order));
+    String A; A <<dofs(0)->frame->name <<'.' <<(frameSlices(dofs(0)->frame->ID) - int(komo.k_order));
+    String B; B <<dofs(-1)->frame->name <<'.' <<(frameSlices(dofs(-1)->frame->ID) - int(komo.k_order));
     if(dofs.N>1){
       name <<A <<"--" <<B;
     }else if(dofs(0)->fex()){
@@ -358,9 +364,8 @@ arr Conv_KOMO_FactoredNLP::getSingleVariableInitSample(uint var_id){
   arr z;
   for(Dof *d:__variableIndex(var_id).dofs){
     //if joint, find previous dof:
-    if(d->frame->ID >= komo.timeSlices.d1){ //is joint and prev time slice exists
-      Frame *prev = komo.pathConfig.frames.elem(d->frame->ID - komo.timeSlices.d1); //grab frame from prev time slice
-      CHECK(prev, "");
+    if(d->frame->prev){ //is joint and prev time slice exists
+      Frame *prev = d->frame->prev; //grab frame from prev time slice
       //init from relative pose (as in applySwitch)
       d->frame->set_X() = prev->ensure_X(); //copy the relative pose (switch joint initialization) from the first application
       arr q = d->calcDofsFromConfig();
@@ -384,7 +389,10 @@ void Conv_KOMO_FactoredNLP::setSingleVariable(uint var_id, const arr& x) {
 
 void Conv_KOMO_FactoredNLP::evaluateSingleFeature(uint feat_id, arr& phi, arr& J, arr& H) {
   std::shared_ptr<GroundedObjective>& ob = feats(feat_id).ob;
+  double time = -rai::realTime();
   phi = ob->feat->eval(ob->frames);
+  ob->evalTime += time + rai::realTime();
+  ob->evalCalls++;
   J = phi.J();
 }
 
@@ -36,6 +36,8 @@ struct GroundedObjective {
   FrameL frames;
   intA timeSlices;
   int objId=-1;
+  uint evalCalls=0;   ///< number of evaluations by the NLP converters (since KOMO::reset)
+  double evalTime=0.; ///< total wall time [sec] of these evaluations
 
   GroundedObjective(const shared_ptr<Feature>& _feat, const ObjectiveType& _type, const intA& _timeSlices) : feat(_feat), type(_type), timeSlices(_timeSlices) {}
   ~GroundedObjective() {}
@@ -123,12 +123,18 @@ void F_PairCollision::phi2(arr& y, arr& J, const FrameL& F) {
 void F_AccumulatedCollisions::phi2(arr& y, arr& J, const FrameL& F) {
   rai::Configuration& C = F.first()->C;
   C.kinematicsZero(y, J, 1);
+  bool contiguous = F.last()->ID-F.first()->ID+1==F.N;
+  uintA sortedIDs;
+  if(selectAll && !contiguous) { sortedIDs = framesToIndices(F); sortedIDs.sort(); }
   for(rai::Proxy& p: C.proxies) {
     bool isSelected=false;
-    if(selectAll){
+    if(selectAll && contiguous){
         //select based on indices, e.g. being in a single time slice of a path config
         isSelected = (p.a->ID>=F.first()->ID && p.a->ID<=F.last()->ID)
                      || (p.b->ID>=F.first()->ID && p.b->ID<=F.last()->ID);
+    }else if(selectAll){
+        //a slice with frames shared by all slices: proxies are within a slice, so both frames need to be in F
+        isSelected = sortedIDs.containsInSorted(p.a->ID) && sortedIDs.containsInSorted(p.b->ID);
     }else{
         //select by explicitly looking up in F
         isSelected = (!selectXor && (F.contains(p.a) || F.contains(p.b)))
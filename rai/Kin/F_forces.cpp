@@ -9,8 +9,10 @@
 #include "F_forces.h"
 
 #include "F_pose.h"
+#include "F_qFeatures.h"
 #include "frame.h"
 #include "forceExchange.h"
+#include "kin_feather.h"
 #include "F_collisions.h"
 #include "../Geo/pairCollision.h"
 
@@ -454,6 +456,90 @@ void F_Energy::phi2(arr& y, arr& J, const FrameL& F) {
 
 //===========================================================================
 
+DofL getTorqueLimitedJoints(const FrameL& frames, arr& limits){
+  DofL dofs;
+  for(rai::Frame* f:frames) if(f->joint && !f->joint->mimic && f->joint->dim==1) dofs.append(f->joint);
+  arr lim = frames.first()->C.getTorqueLimits(dofs);
+  DofL limited;
+  limits.clear();
+  for(uint i=0; i<dofs.N; i++) if(lim(i)>0.) { limited.append(dofs(i)); limits.append(lim(i)); }
+  return limited;
+}
+
+void F_TorqueLimits::phi2(arr& y, arr& J, const FrameL& F) {
+  CHECK_EQ(order, 2, "");
+  CHECK_EQ(F.d0, 3, "");
+  rai::Configuration& C = F.last()->C;
+  CHECK_EQ(C.frames.nd, 2, "torque limits need a path configuration (with time slices)");
+
+  arr limits;
+  DofL dofs = getTorqueLimitedJoints(F[1], limits);
+  if(!dofs.N) { y.clear(); if(!!J) J.clear(); return; }
+
+  //-- the rigid body tree of the mid time slice (and its buffers) are only built when the slice's frames changed
+  uint nF = C.frames.d1, s = F(1, 0)->ID/nF;
+  CHECK(s>0 && s+1<C.frames.d0, "");
+  if(trees.N<C.frames.d0) trees.resizeCopy(C.frames.d0);
+  std::shared_ptr<FeatherstoneInterface>& tree = trees(s);
+  if(!tree || &tree->C!=&C || !(tree->subset==C.frames[s])) tree = make_shared<FeatherstoneInterface>(C, C.frames[s]);
+  FeatherstoneInterface& fs = *tree;
+  fs.update();
+
+  //-- joint states of the three slices in the order of the tree's dofs, with central differences for qd and qdd
+  uintA jointIDs; //(frame indices within a slice)
+  uint n=0;
+  for(F_Link& link:fs.tree) if(link.dof()) {
+      CHECK_EQ(link.qIndex, (int)n, "");
+      jointIDs.append(link.ID);
+      n += link.dof();
+    }
+  arr q[3];
+  for(uint i=0; i<3; i++) {
+    FrameL Fi(1, jointIDs.N);
+    for(uint j=0; j<jointIDs.N; j++) Fi(0, j) = C.frames(s+i-1, jointIDs(j));
+    q[i] = F_qItself().eval(Fi);
+    CHECK_EQ(q[i].N, n, "the joints differ between the time slices");
+  }
+  double tau; arr Jtau;
+  C.kinematicsTau(tau, Jtau, F.elem(-1));
+  CHECK_GE(tau, 1e-10, "");
+  arr qd = (q[2]-q[0])/(2.*tau);
+  arr qdd = (q[2]-2.*q[1]+q[0])/(tau*tau);
+  if(Jtau.N) {
+    qd.J() += (-1./tau)*qd.noJ()*Jtau;
+    qdd.J() += (-2./tau)*qdd.noJ()*Jtau;
+  }
+
+  //-- torques, and their Jacobian by the chain rule through the analytic inverse dynamics derivatives
+  arr u, u_q, u_qd, u_qdd;
+  if(!!J) {
+    fs.invDynamics(u, qd.noJ(), qdd.noJ(), useGravity, u_q, u_qd, u_qdd);
+    arr du = u_q*q[1] + u_qd*qd + u_qdd*qdd; //(only its Jacobian is used)
+    u.J() = du.J();
+  } else {
+    fs.invDynamics(u, qd.noJ(), qdd.noJ(), useGravity);
+  }
+
+  //-- select the limited joints: y = (-limit-u, u-limit)
+  arr S = zeros(2*dofs.N, u.N);
+  for(uint i=0; i<dofs.N; i++) {
+    int k = fs.tree(dofs(i)->frame->ID - s*nF).qIndex;
+    CHECK_GE(k, 0, "joint '" <<dofs(i)->frame->name <<"' is not part of the dynamics");
+    S(2*i, k) = -1.;
+    S(2*i+1, k) = 1.;
+  }
+  y = S*u;
+  for(uint i=0; i<dofs.N; i++) { y(2*i) -= limits(i);  y(2*i+1) -= limits(i); }
+  grabJ(y, J);
+}
+
+uint F_TorqueLimits::dim_phi2(const FrameL& F) {
+  arr limits;
+  return 2*getTorqueLimitedJoints(F[F.d0/2], limits).N;
+}
+
+//===========================================================================
+
 FrameL getShapesAbove(rai::Frame* a) {
   FrameL aboves;
   if(a->shape) aboves.append(a);
@@ -10,6 +10,8 @@
 
 #include "feature.h"
 
+struct FeatherstoneInterface;
+
 //===========================================================================
 // trivial read out of forces
 
@@ -88,6 +90,17 @@ struct F_Energy : Feature {
   virtual uint dim_phi2(const FrameL& F) {  return 1;  }
 };
 
+/// the torques of the selected (1-dof) joints -- by inverse dynamics of the mid time slice, with qd and qdd as central
+/// differences -- within their torque limits (see getTorqueLimits): y = (-limit-u, u-limit) per limited joint, as inequality
+struct F_TorqueLimits : Feature {
+  bool useGravity=true;
+  F_TorqueLimits(bool _useGravity=true) : useGravity(_useGravity) { order=2; }
+  virtual void phi2(arr& y, arr& J, const FrameL& F);
+  virtual uint dim_phi2(const FrameL& F);
+ private:
+  rai::Array<std::shared_ptr<FeatherstoneInterface>> trees; ///< per time slice: built on first use, then only updated
+};
+
 //===========================================================================
 // force geometry, complementarity, velocities
 
@@ -101,6 +101,19 @@ void rai::CameraView::updateConfiguration(const rai::Configuration& newC) {
 
 void rai::CameraView::computeImageAndDepth(byteA& image, floatA& depth) {
   updateCamera();
+  if(rayCast) {
+    uintA ids;
+    renderRayCast(image, depth, ids, renderMode!=seg);
+    if(renderMode==seg && frameIDmap.N) {
+      image.resize(ids.d0, ids.d1);
+      for(uint i=0; i<ids.N; i++) image.elem(i) = (ids.elem(i)<frameIDmap.N ? frameIDmap(ids.elem(i)) : 0);
+    } else if(renderMode==seg) { //id colors, as drawn by GL
+      image.resize(ids.d0, ids.d1, 3);
+      for(uint i=0; i<ids.N; i++) id2color(image.p+3*i, ids.elem(i)==RayCaster::noHit ? 0xffffff : ids.elem(i));
+    }
+    done(__func__);
+    return;
+  }
   //  renderMode=all;
   // gl.update(nullptr, true);
   gl.renderInBack();
@@ -133,6 +146,15 @@ void rai::CameraView::computeImageAndDepth(byteA& image, floatA& depth) {
 void rai::CameraView::computeSegmentation(byteA& segmentation) {
   updateCamera();
   renderMode=seg;
+  if(rayCast) {
+    uintA ids;
+    floatA depth;
+    renderRayCast(segmentation, depth, ids, false);
+    segmentation.resize(ids.d0, ids.d1, 3);
+    for(uint i=0; i<ids.N; i++) id2color(segmentation.p+3*i, ids.elem(i)==RayCaster::noHit ? 0xffffff : ids.elem(i)); //(no hit -> white, as the GL clear color)
+    done(__func__);
+    return;
+  }
   gl.renderInBack();
 //  gl.update(nullptr, true);
   segmentation = gl.captureImage;
@@ -141,6 +163,16 @@ void rai::CameraView::computeSegmentation(byteA& segmentation) {
 }
 
 void rai::CameraView::computeSegmentation(uintA& segmentation) {
+  if(rayCast) {
+    updateCamera();
+    renderMode=seg;
+    byteA image;
+    floatA depth;
+    renderRayCast(image, depth, segmentation, false);
+    for(uint& id:segmentation) if(id==RayCaster::noHit) id=0xffffff;
+    done(__func__);
+    return;
+  }
   byteA seg;
   computeSegmentation(seg);
   segmentation.resize(seg.d0, seg.d1);
@@ -189,6 +221,20 @@ void rai::CameraView::computePointCloud(arr& pts, const floatA& depth, bool glob
   done(__func__);
 }
 
+void rai::CameraView::computePointCloud(DepthToPointCloud& cloud, const floatA& depth, bool globalCoordinates) {
+  uint H=depth.d0, W=depth.d1;
+
+  if(currentSensor) gl.camera = currentSensor->cam;
+
+  CHECK(gl.camera.focalLength>0, "need a focal length greater zero!(not implemented for ortho yet)");
+  //the pixel convention of the dense version above: pixel (i, j) is at (j-W/2+1, i-H/2+1) from the center
+  cloud.fx = cloud.fy = gl.camera.focalLength*H;
+  cloud.px = int(W>>1)-1;
+  cloud.py = int(H>>1)-1;
+  cloud.compute(depth, globalCoordinates ? gl.camera.X : rai::Transformation(0));
+  done(__func__);
+}
+
 arr rai::CameraView::pixel2world(const arr& pixelCoordinates){
   CHECK(currentSensor, "");
   CHECK_EQ(pixelCoordinates.N, 3, "");
@@ -223,7 +269,30 @@ void rai::CameraView::updateCamera() {
   }
 }
 
+void rai::CameraView::renderRayCast(byteA& image, floatA& depth, uintA& ids, bool computeImage) {
+  rayCaster.clear();
+  for(rai::Frame* f:C.frames) if(f->shape) {
+    rai::Shape* s = f->shape;
+    if(s->type()==ST_marker || s->type()==ST_camera || !s->_mesh) continue;
+    if(meshLod && s->type()==ST_mesh) rayCaster.add(s->lod(meshLod), f->ensure_X(), f->ID);
+    else rayCaster.add(s->_mesh, f->ensure_X(), f->ID);
+  }
+  for(uint c=0; c<3; c++) rayCaster.background[c] = (renderMode==seg ? 255 : ::byte(255.f*gl.clearColor(c)));
+
+  uint W=gl.width, H=gl.height;
+  if(currentSensor) { W=currentSensor->width; H=currentSensor->height; }
+  rayCaster.render(depth, ids, image, gl.camera, W, H, computeImage);
+
+  //-- sensor background image where nothing was hit
+  if(computeImage && currentSensor && currentSensor->backgroundImage.nd==3 && currentSensor->backgroundImage.d0==H && currentSensor->backgroundImage.d1==W) {
+    for(uint i=0; i<ids.N; i++) if(ids.elem(i)==RayCaster::noHit) {
+      for(uint c=0; c<3; c++) image.elem(3*i+c) = currentSensor->backgroundImage.elem(3*i+c);
+    }
+  }
+}
+
 void rai::CameraView::glDraw(OpenGL& gl) {
+  gl.drawOptions.meshLod = meshLod;
   if(renderMode==all || renderMode==visuals) {
     glStandardScene(nullptr, gl);
     gl.drawOptions.drawMode_idColor = false;
@@ -10,6 +10,9 @@
 
 #include "kin.h"
 #include "../Gui/opengl.h"
+#include "../Geo/rayCast.h"
+
+struct DepthToPointCloud;
 
 namespace rai {
 
@@ -38,7 +41,10 @@ struct CameraView : GLDrawer {
   Sensor* currentSensor=0;
   int watchComputations=0;
   RenderMode renderMode=all;
+  uint meshLod=0;              ///< render mesh shapes at this level of detail (see Shape::lod)
+  bool rayCast=false;          ///< render with the CPU RayCaster instead of OpenGL (no GL context needed; only the shapes' meshes are drawn)
   byteA frameIDmap;
+  RayCaster rayCaster;
 
   //-- evaluation outputs
   CameraView(const rai::Configuration& _C, bool _offscreen=true, int _watchComputations=0);
@@ -56,6 +62,7 @@ struct CameraView : GLDrawer {
   void computeImageAndDepth(byteA& image, floatA& depth);
   void computeKinectDepth(uint16A& kinect_depth, const arr& depth);
   void computePointCloud(arr& pts, const floatA& depth, bool globalCoordinates=true); // point cloud (rgb of every point is given in image)
+  void computePointCloud(DepthToPointCloud& cloud, const floatA& depth, bool globalCoordinates=true); // compacted valid points (of cloud.pixels), via the fused pipeline
   void computeSegmentation(byteA& segmentation);     // -> segmentation
   void computeSegmentation(uintA& segmentation);     // -> segmentation
 
@@ -70,6 +77,7 @@ struct CameraView : GLDrawer {
 
  private:
   void updateCamera();
+  void renderRayCast(byteA& image, floatA& depth, uintA& ids, bool computeImage);
   void done(const char* _code_);
 };
 
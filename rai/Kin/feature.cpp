@@ -86,7 +86,7 @@ FrameL Feature::getFrames(const rai::Configuration& C, uint s) {
     F.reshape(1, F.N);
   }else{
     CHECK_EQ(C.frames.nd, 2, "");
-    CHECK_GE(C.frames.d0, order+s+1, "");
+    CHECK(s>=order && s<C.frames.d0, "slices " <<s-order <<".." <<s <<" are not in the configuration");
     F.resize(order+1, frameIDs.N);
     for(uint i=0;i<=order;i++){
       for(uint j=0;j<frameIDs.N;j++){
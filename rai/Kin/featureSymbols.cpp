@@ -70,6 +70,8 @@ template<> const char* rai::Enum<FeatureSymbol>::names []= {
   "transVelocities",
 
   "qQuaternionNorms",
+
+  "torqueLimits",
   nullptr
 };
 
@@ -112,6 +114,7 @@ std::shared_ptr<Feature> Feature::deepCopy(){
   _cpy(F_AccumulatedCollisions);
   _cpy(F_NewtonEuler);
   _cpy(F_NewtonEuler_DampedVelocities);
+  _cpy(F_TorqueLimits);
   _cpy(F_fex_POASurfaceDistance);
   _cpy(F_fex_ForceIsNormal);
   _cpy(F_fex_ForceIsPositive);
@@ -210,6 +213,10 @@ shared_ptr<Feature> symbols2feature(FeatureSymbol feat, const StringA& frames, c
   else if(feat==FS_physics) { f=make_shared<F_NewtonEuler>(); }
   else if(feat==FS_contactConstraints) { f=make_shared<F_fex_ForceIsNormal>(); }
   else if(feat==FS_energy) { f=make_shared<F_Energy>(); }
+  else if(feat==FS_torqueLimits) {
+    f=make_shared<F_TorqueLimits>();
+    if(!frames.N) f->frameIDs = framesToIndices(C.frames);
+  }
 
   else if(feat==FS_transAccelerations) { HALT("obsolete"); /*f=make_shared<TM_Transition>(world);*/ }
   else if(feat==FS_transVelocities) {
@@ -68,6 +68,8 @@ enum FeatureSymbol {
   FS_transVelocities,
 
   FS_qQuaternionNorms,
+
+  FS_torqueLimits,
 };
 
 namespace rai {
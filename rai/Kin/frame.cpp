@@ -499,6 +499,7 @@ rai::Frame& rai::Frame::setConvexMesh(const arr& points, const byteA& colors, do
 rai::Frame& rai::Frame::setMesh(const rai::Mesh& m) {
   getShape().type() = ST_mesh;
   getShape().mesh() = m;
+  getShape().mesh().changed(); //(the copied revision may equal the previous one)
   return *this;
 }
 
@@ -509,6 +510,13 @@ rai::Frame& rai::Frame::setSdf(const SDF_GridData& sdf) {
   return *this;
 }
 
+rai::Frame& rai::Frame::setSdf(const shared_ptr<SDF_SparseGrid>& sdf) {
+  getShape().type() = ST_sdf;
+  getShape()._sparseSdf = sdf;
+  getShape().createMeshes();
+  return *this;
+}
+
 rai::Frame& rai::Frame::setColor(const arr& color) {
   getShape().mesh().C = color;
   return *this;
@@ -1378,6 +1386,7 @@ rai::Shape::Shape(Frame& f, const Shape* copyShape)
     if(s._mesh) _mesh = s._mesh; //shallow shared_ptr copy!
     if(s._sscCore) _sscCore = s._sscCore; //shallow shared_ptr copy!
     if(s._sdf) _sdf = s._sdf; //shallow shared_ptr copy!
+    if(s._sparseSdf) _sparseSdf = s._sparseSdf; //shallow shared_ptr copy!
     _type = s._type;
     size = s.size;
     cont = s.cont;
@@ -1574,6 +1583,8 @@ void rai::Shape::glDraw(OpenGL& gl) {
     } else {
       if(!mesh().V.N) {
         LOG(1) <<"trying to draw empty mesh (shape type:" <<_type <<")";
+      } else if(gl.drawOptions.meshLod && _type==rai::ST_mesh) {
+        lod(gl.drawOptions.meshLod)->glDraw(gl);
       } else {
         mesh().glDraw(gl);
       }
@@ -1597,6 +1608,24 @@ void rai::Shape::glDraw(OpenGL& gl) {
 #endif
 }
 
+shared_ptr<rai::Mesh> rai::Shape::lod(uint level) {
+  if(!level || !_mesh) return _mesh;
+  if(!_lods.N || _lods(0)!=_mesh || _lodsRevision!=_mesh->revision) { //(re)start the chain if the mesh was replaced or modified
+    _lods = {_mesh};
+    _lodsRevision = _mesh->revision;
+  }
+  while(_lods.N<=level) {
+    shared_ptr<Mesh>& prev = _lods(-1);
+    if(prev->T.d0<256) { _lods.append(prev); continue; } //small enough -- reuse the previous level
+    auto M = make_shared<Mesh>(*prev);
+    M->decimate(prev->T.d0/4);
+    _lods.append(M);
+  }
+  Mesh& L = *_lods(level);
+  if(_mesh->C.nd<=1 && !(L.C==_mesh->C)) L.C = _mesh->C; //(a global color change, e.g. by setColor, does not change the revision)
+  return _lods(level);
+}
+
 void rai::Shape::createMeshes() {
   //create mesh for basic shapes
   switch(_type) {
@@ -1630,7 +1659,16 @@ void rai::Shape::createMeshes() {
       break;
     case rai::ST_sdf: {
       if(!mesh().V.N){
-        mesh().setImplicitSurface(sdf().gridData, sdf().lo, sdf().up);
+        if(_sparseSdf){
+          SDF_SparseGrid& S = *_sparseSdf;
+          rai::Transformation pose = S.pose;
+          S.pose.setZero(); //the mesh is in shape coordinates
+          uint res = rai::MIN(256., absMax(S.up-S.lo)/S.voxelSize);
+          mesh().setImplicitSurface(S, S.lo(0), S.up(0), S.lo(1), S.up(1), S.lo(2), S.up(2), res);
+          S.pose = pose;
+        }else{
+          mesh().setImplicitSurface(sdf().gridData, sdf().lo, sdf().up);
+        }
       }
     } break;
     case rai::ST_quad: {
@@ -1719,6 +1757,10 @@ shared_ptr<ScalarFunction> rai::Shape::functional(bool worldCoordinates){
       return make_shared<SDF_ssBox>(pose, size);
     case rai::ST_mesh:
     case rai::ST_sdf:
+      if(_sparseSdf){
+        _sparseSdf->pose = pose;
+        return _sparseSdf;
+      }
       if(_sdf){
         _sdf->pose = pose;
         return _sdf;
@@ -159,6 +159,7 @@ struct Frame : NonCopyable {
   Frame& setConvexMesh(const arr& points, const byteA& colors= {}, double radius=0.);
   Frame& setMesh(const rai::Mesh& m);
   Frame& setSdf(const SDF_GridData& sdf);
+  Frame& setSdf(const shared_ptr<SDF_SparseGrid>& sdf); ///< sparse sdfs are shared (not copied)
   Frame& setColor(const arr& color);
   Frame& setJoint(rai::JointType jointType);
   Frame& setContact(int cont);
@@ -310,6 +311,9 @@ struct Shape : NonCopyable, GLDrawer {
   shared_ptr<Mesh> _mesh;
   shared_ptr<Mesh> _sscCore;
   shared_ptr<SDF_GridData> _sdf;
+  shared_ptr<SDF_SparseGrid> _sparseSdf;
+  rai::Array<shared_ptr<Mesh>> _lods; ///< levels of detail of _mesh (created lazily by lod(); entry 0 is _mesh itself)
+  uint _lodsRevision=0; ///< _mesh->revision when _lods was built
   char cont=0;           ///< are contacts registered (or filtered in the callback)
 
   double radius() { if(size.N) return size(-1); return 0.; }
@@ -320,6 +324,7 @@ struct Shape : NonCopyable, GLDrawer {
   double alpha() { arr& C=mesh().C; if(C.N==4 || C.N==2) return C(-1); return 1.; }
 
   void createMeshes();
+  shared_ptr<Mesh> lod(uint level); ///< the mesh decimated to ~1/4^level of its triangles (level 0 is the mesh itself)
   shared_ptr<ScalarFunction> functional(bool worldCoordinates=true);
 
   Shape(Frame& f, const Shape* copyShape=nullptr); //new Shape, being added to graph and frame's shape lists
@@ -20,6 +20,7 @@
 #include "viewer.h"
 #include "../Core/graph.h"
 #include "../Core/util.h"
+#include "../Core/profiler.h"
 #include "../Geo/fclInterface.h"
 #include "../Geo/qhull.h"
 #include "../Geo/mesh_readAssimp.h"
@@ -29,6 +30,7 @@
 #include <algorithm>
 #include <sstream>
 #include <climits>
+#include <map>
 
 #ifdef RAI_ASSIMP
 #  include <assimp/Exporter.hpp>
@@ -125,6 +127,7 @@ struct sConfiguration {
   shared_ptr<ConfigurationViewer> viewer;
   //shared_ptr<SwiftInterface> swift;
   shared_ptr<FclInterface> fcl;
+  uint fclMeshLod=0;
   unique_ptr<PhysXInterface> physx;
   unique_ptr<OdeInterface> ode;
   unique_ptr<FeatherstoneInterface> fs;
@@ -174,6 +177,7 @@ void Configuration::copy(const Configuration& C, bool referenceFclOnCopy) {
   if(referenceFclOnCopy) {
     //self->swift = C.self->swift;
     self->fcl = C.self->fcl;
+    self->fclMeshLod = C.self->fclMeshLod;
   }
 
   //copy vector state
@@ -308,8 +312,9 @@ Frame* Configuration::addObject(const char* name, const char* parent, ShapeType
 }
 #endif
 
-/// add copies of all given frames and forces, which can be from another Configuration -> \ref frames array becomes sliced! (a matrix)
-Frame* Configuration::addCopies(const FrameL& F, const DofL& _dofs) {
+/// add copies of all given frames and forces, which can be from another Configuration -> \ref frames array becomes sliced! (a matrix);
+/// frames whose parent is not in F are linked to outerParents(parent->ID), if given (frames of this Configuration, indexed like F's Configuration)
+Frame* Configuration::addCopies(const FrameL& F, const DofL& _dofs, const FrameL& outerParents) {
   //prepare an index FId -> thisId
   uint maxId=0;
   for(Frame* f:F) if(f->ID>maxId) maxId=f->ID;
@@ -339,11 +344,13 @@ Frame* Configuration::addCopies(const FrameL& F, const DofL& _dofs) {
 
   //relink frames - special attention to mimic'ing
   for(Frame* f:F) if(f->parent){
+    Frame* f_new = frames.elem(FId2thisId(f->ID));
     if(f->parent->ID>maxId || FId2thisId(f->parent->ID)==-1) {
-      LOG(-1) <<"can't relink frame '" <<*f <<"'";
+      if(f->parent->ID<outerParents.N) f_new->setParent(outerParents(f->parent->ID));
+      else LOG(-1) <<"can't relink frame '" <<*f <<"'";
+    } else {
+      f_new->setParent(frames.elem(FId2thisId(f->parent->ID)));
     }
-    Frame* f_new = frames.elem(FId2thisId(f->ID));
-    f_new->setParent(frames.elem(FId2thisId(f->parent->ID)));
     //take care of within-F mimic joints:
     if(f->joint && f->joint->mimic){
       if(f->joint->mimic->frame->ID<maxId && FId2thisId(f->joint->mimic->frame->ID)!=-1){
@@ -602,6 +609,7 @@ arr Configuration::getDofState(const DofL& dofs) const {
 
 /// get the (F.N,7)-matrix of all poses for all given frames
 arr Configuration::getFrameState(const FrameL& F) const {
+  RAI_PROFILE("Configuration::getFrameState");
   arr X(F.N, 7);
   for(uint i=0; i<X.d0; i++) {
     const rai::Transformation& Xi = F.elem(i)->ensure_X();
@@ -614,6 +622,7 @@ arr Configuration::getFrameState(const FrameL& F) const {
 
 /// set the q-vector (all joint and force DOFs)
 void Configuration::setJointState(const arr& _q) {
+  RAI_PROFILE("Configuration::setJointState");
   setJointStateCount++; //global counter
 
 #ifndef RAI_NOCHECK
@@ -1610,6 +1619,7 @@ void Configuration::kinematicsZero(arr& y, arr& J, uint n) const {
 
 /// what is the linear velocity of a world point (pos_world) attached to frame a for a given joint velocity?
 void Configuration::jacobian_pos(arr& J, Frame* a, const Vector& pos_world) const {
+  RAI_PROFILE("Configuration::jacobian_pos");
   CHECK_EQ(&a->C, this, "");
   CHECK(_state_indexedJoints_areGood, "");
 
@@ -1741,6 +1751,7 @@ void Configuration::jacobian_pos(arr& J, Frame* a, const Vector& pos_world) cons
 
 /// what is the angular velocity of frame a for a given joint velocity?
 void Configuration::jacobian_angular(arr& J, Frame* a) const {
+  RAI_PROFILE("Configuration::jacobian_angular");
   a->ensure_X();
 
   uint N = getJointStateDimension();
@@ -2038,27 +2049,23 @@ void Configuration::hessianPos(arr& H, Frame* a, Vector* rel) const {
 
 void Configuration::equationOfMotion(arr& M, arr& F, const arr& qdot, bool gravity) {
   fs().update();
-  fs().setGravity();
-  fs().equationOfMotion(M, F, qdot);
+  fs().equationOfMotion(M, F, qdot, gravity);
 }
 
 /** @brief return the joint accelerations \f$\ddot q\f$ given the
-  joint torques \f$\tau\f$ (computed via Featherstone's Articulated Body Algorithm in O(n)) */
-void Configuration::fwdDynamics(arr& qdd, const arr& qd, const arr& tau, bool gravity) {
+  joint torques \f$\tau\f$ (computed via Featherstone's Articulated Body Algorithm in O(n)), optionally with their
+  Jacobians w.r.t. q, qd and tau */
+void Configuration::fwdDynamics(arr& qdd, const arr& qd, const arr& tau, bool gravity, arr& qdd_q, arr& qdd_qd, arr& qdd_tau) {
   fs().update();
-  fs().setGravity();
-  //  cout <<tree <<endl;
-  fs().fwdDynamics_MF(qdd, qd, tau);
-  //  fs().fwdDynamics_aba_1D(qdd, qd, tau); //works
-  //  fwdDynamics_aba_nD(qdd, tree, qd, tau); //does not work
+  fs().fwdDynamics_aba_nD(qdd, qd, tau, gravity, qdd_q, qdd_qd, qdd_tau);
 }
 
 /** @brief return the necessary joint torques \f$\tau\f$ to achieve joint accelerations
-  \f$\ddot q\f$ (computed via the Recursive Newton-Euler Algorithm in O(n)) */
-void Configuration::inverseDynamics(arr& tau, const arr& qd, const arr& qdd, bool gravity) {
+  \f$\ddot q\f$ (computed via the Recursive Newton-Euler Algorithm in O(n)), optionally with their Jacobians w.r.t. q,
+  qd and qdd (the latter is the mass matrix) */
+void Configuration::inverseDynamics(arr& tau, const arr& qd, const arr& qdd, bool gravity, arr& tau_q, arr& tau_qd, arr& tau_qdd) {
   fs().update();
-  fs().setGravity();
-  fs().invDynamics(tau, qd, qdd);
+  fs().invDynamics(tau, qd, qdd, gravity, tau_q, tau_qd, tau_qdd);
 }
 
 /*void Configuration::impulsePropagation(arr& qd1, const arr& qd0){
@@ -2097,15 +2104,17 @@ std::shared_ptr<SwiftInterface> Configuration::swift() {
 }
 */
 
-std::shared_ptr<FclInterface> Configuration::fcl() {
+std::shared_ptr<FclInterface> Configuration::fcl(int meshLod) {
+  if(self->fcl && meshLod>=0 && (uint)meshLod!=self->fclMeshLod) self->fcl.reset(); //rebuild at the requested level of detail
   if(!self->fcl) {
+    if(meshLod>=0) self->fclMeshLod = meshLod;
     Array<shared_ptr<Mesh>> geometries(frames.N);
     for(Frame* f:frames) {
       if(f->shape && f->shape->cont) {
         CHECK(f->shape->type()!=rai::ST_marker, "collision object can't be a marker");
         if(!f->shape->mesh().V.N) f->shape->createMeshes();
         CHECK(f->shape->mesh().V.N, "collision object with no vertices");
-        geometries(f->ID) = f->shape->_mesh;
+        geometries(f->ID) = f->shape->lod(self->fclMeshLod);
       }
     }
     self->fcl = make_shared<FclInterface>(geometries, .0); //-1.=broadphase only -> many proxies, 0.=binary, .1=exact margin (slow)
@@ -2113,6 +2122,12 @@ std::shared_ptr<FclInterface> Configuration::fcl() {
   return self->fcl;
 }
 
+void Configuration::shareFclModels(Configuration& base) {
+  CHECK_EQ(frames.N, base.frames.N, "can only share the collision models of a copy");
+  self->fcl = make_shared<FclInterface>(*base.fcl());
+  self->fclMeshLod = base.self->fclMeshLod;
+}
+
 /// return a PhysX extension
 PhysXInterface& Configuration::physx() {
   if(!self->physx) {
@@ -2268,11 +2283,8 @@ void Configuration::stepDynamics(arr& qdot, const arr& Bu_control, double tau, d
 
   auto eqn = [&](const arr& x) -> arr {
     setJointState(x[0]);
-    arr M, Minv, F;
-    equationOfMotion(M, F, x[1], gravity);
-    inverse_SymPosDef(Minv, M);
-    //Minv = inverse(M); //TODO why does symPosDef fail?
-    arr y = Minv * (Bu_control - F);
+    arr y;
+    fwdDynamics(y, x[1], Bu_control, gravity);
     return y;
   };
 
@@ -3162,12 +3174,34 @@ void Configuration::glDraw_sub(OpenGL& gl, const FrameL& F, int drawOpaqueOrTran
 
   //shapes
   if(drawOpaqueOrTransparanet==0 || drawOpaqueOrTransparanet==1) {
-    //first non-transparent
+    //first non-transparent; plain mesh shapes are grouped by mesh (e.g. the same link in all time slices) and drawn in one batch
+    //(bind-once batching: the fixed-function pipeline has no per-instance attributes, so each pose is still one glDrawElements)
+    bool batching = gl.drawOptions.meshBuffers && gl.drawOptions.drawShapes && !gl.drawOptions.drawZlines && !gl.drawOptions.drawFrameNames;
+    std::map<Mesh*, FrameL> instances;
+    rai::Array<Mesh*> meshOrder;
     for(Frame* f: F) if(f->shape && f->shape->alpha()==1.) {
       if(F.nd==2 && f->ID>F.d1 && f->shape->_mesh==F.elem(f->ID-F.d1)->shape->_mesh && f->X==F.elem(f->ID-F.d1)->X){//has the same shape and pose as previous time slice frame
         continue;
       }
-      f->shape->glDraw(gl);
+      Shape* s = f->shape;
+      if(batching && s->_type!=ST_marker && s->_type!=ST_camera && s->_mesh && s->_mesh->V.N && s->_mesh->T.d1==3) {
+        Mesh* m = (gl.drawOptions.meshLod && s->_type==ST_mesh) ? s->lod(gl.drawOptions.meshLod).get() : s->_mesh.get();
+        FrameL& I = instances[m];
+        if(!I.N) meshOrder.append(m);
+        I.append(f);
+        continue;
+      }
+      s->glDraw(gl);
+    }
+    for(Mesh* m: meshOrder) {
+      const FrameL& I = instances[m];
+      rai::Array<Transformation> poses(I.N);
+      for(uint i=0; i<I.N; i++) poses(i) = I(i)->ensure_X();
+      m->glDrawInstances(gl, poses, [&](uint i) {
+        glPushName((I(i)->ID <<2) | 1); //(as in Shape::glDraw)
+        if(gl.drawOptions.drawMode_idColor) glColorId(I(i)->ID);
+        else if(gl.drawOptions.drawColors) { if(m->C.N) glColor(m->C); else glColor(.5, .5, .5); }
+      }, [](uint) { glPopName(); });
     }
   }
   if(drawOpaqueOrTransparanet==0 || drawOpaqueOrTransparanet==2) {
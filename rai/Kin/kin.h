@@ -96,7 +96,7 @@ struct Configuration : GLDrawer {
   Frame* addFrame(const char* name, const char* parent=nullptr, const char* args=nullptr);
   Frame* addFile(const char* filename);
   Frame* addAssimp(const char* filename);
-  Frame* addCopies(const FrameL& F, const DofL& _dofs);
+  Frame* addCopies(const FrameL& F, const DofL& _dofs, const FrameL& outerParents={});
   void addConfiguration(const Configuration& C, double tau=1.);
 
   /// @name get frames
@@ -230,8 +230,8 @@ struct Configuration : GLDrawer {
 
   /// @name dynamics based on the fs() interface
   void equationOfMotion(arr& M, arr& F, const arr& qdot, bool gravity=true);
-  void fwdDynamics(arr& qdd, const arr& qd, const arr& tau, bool gravity=true);
-  void inverseDynamics(arr& tau, const arr& qd, const arr& qdd, bool gravity=true);
+  void fwdDynamics(arr& qdd, const arr& qd, const arr& tau, bool gravity=true, arr& qdd_q=NoArr, arr& qdd_qd=NoArr, arr& qdd_tau=NoArr);
+  void inverseDynamics(arr& tau, const arr& qd, const arr& qdd, bool gravity=true, arr& tau_q=NoArr, arr& tau_qd=NoArr, arr& tau_qdd=NoArr);
 
   /// @name collisions & proxies
   void copyProxies(const ProxyA& _proxies);
@@ -241,7 +241,8 @@ struct Configuration : GLDrawer {
   std::shared_ptr<ConfigurationViewer>& viewer(const char* window_title=nullptr, bool offscreen=false);
   OpenGL& gl();
   //std::shared_ptr<SwiftInterface> swift();
-  std::shared_ptr<FclInterface> fcl();
+  std::shared_ptr<FclInterface> fcl(int meshLod=-1); //meshLod: level of detail of the collision meshes (see Shape::lod); -1 keeps the current one (0 initially), another level rebuilds the interface
+  void shareFclModels(Configuration& base); ///< own fcl collision manager on the geometry models of base.fcl() (no rebuild) -- both can be queried concurrently
   void swiftDelete();
   PhysXInterface& physx();
   OdeInterface& ode();
@@ -228,20 +228,35 @@ void Featherstone::skew(arr& X, const double* v) {
 
 arr Featherstone::skew(const double* v) { arr X; skew(X, v); return X; }
 
+/// the Plücker transform [E, 0; -E r^, E] (for motion vectors) of the transformation f, where E is the transposed
+/// rotation matrix and r the translation; row-major 6x6
+void FrameToMatrix(double* X, const rai::Transformation& f) {
+  double R[9];
+  f.rot.getMatrix(R);
+  const double* r = &f.pos.x;
+  for(uint i=0; i<3; i++) {
+    const double E[3] = {R[i], R[3+i], R[6+i]}; //row i of E = column i of R
+    double* X0 = X+6*i;
+    double* X1 = X+6*(i+3);
+    for(uint j=0; j<3; j++) { X0[j]=X1[j+3]=E[j];  X0[j+3]=0.; }
+    //row i of -E r^ = r x (row i of E)
+    X1[0] = r[1]*E[2] - r[2]*E[1];
+    X1[1] = r[2]*E[0] - r[0]*E[2];
+    X1[2] = r[0]*E[1] - r[1]*E[0];
+  }
+}
+
 void FrameToMatrix(arr& X, const rai::Transformation& f) {
-  arr z(3, 3);  z.setZero();
-  arr r(3, 3);  Featherstone::skew(r, &f.pos.x);
-  arr R(3, 3);  f.rot.getMatrix(R.p);
-  transpose(R);
   X.resize(6, 6);
-  X.setMatrixBlock(R, 0, 0);
-  X.setMatrixBlock(z, 0, 3);
-  X.setMatrixBlock(R*~r, 3, 0);
-  X.setMatrixBlock(R, 3, 3); //[[unklar!!]]
-  //cout <<"\nz=" <<z <<"\nr=" <<r <<"\nR=" <<R <<"\nX=" <<X <<endl;
+  FrameToMatrix(X.p, f);
 }
 
-uint F_Link::dof() { if(type>=rai::JT_hingeX && type<=rai::JT_transZ) return 1; else return 0; }
+uint F_Link::dof() {
+  if(type>=rai::JT_hingeX && type<=rai::JT_transZ) return 1;
+  if(type==rai::JT_transXY) return 2;
+  if(type==rai::JT_trans3) return 3;
+  return 0;
+}
 
 void F_Link::setFeatherstones() {
   switch(type) {
@@ -249,7 +264,7 @@ void F_Link::setFeatherstones() {
     case rai::JT_rigid:
     case rai::JT_transXYPhi:
       qIndex=-1;
-      _h=zeros(6);
+      _h.resize(6).setZero();
       break;
     case rai::JT_hingeX: _h.resize(6).setZero(); _h(0)=1.; break;
     case rai::JT_hingeY: _h.resize(6).setZero(); _h(1)=1.; break;
@@ -257,6 +272,8 @@ void F_Link::setFeatherstones() {
     case rai::JT_transX: _h.resize(6).setZero(); _h(3)=1.; break;
     case rai::JT_transY: _h.resize(6).setZero(); _h(4)=1.; break;
     case rai::JT_transZ: _h.resize(6).setZero(); _h(5)=1.; break;
+    case rai::JT_transXY: _h.resize(6, 2).setZero(); _h(3, 0)=_h(4, 1)=1.; break;
+    case rai::JT_trans3:  _h.resize(6, 3).setZero(); _h(3, 0)=_h(4, 1)=_h(5, 2)=1.; break;
     default: NIY;
   }
   Featherstone::RBmci(_I, mass, com.p(), inertia);
@@ -270,8 +287,9 @@ void F_Link::updateFeatherstones() {
 //  rai::Transformation XQ;
 //  XQ=X;
 //  XQ.appendTransformation(Q);
-  rai::Vector fo = -X.rot * force;
-  rai::Vector to = -X.rot * (torque + ((X.rot*com)^force));
+  //external force (at the center of mass) and torque, both given in world coordinates, as spatial force in link coordinates
+  rai::Vector fo = force / X.rot;
+  rai::Vector to = torque / X.rot + (com ^ fo);
   _f.resize(6);
   _f(0)=to.x;  _f(1)=to.y;  _f(2)=to.z;
   _f(3)=fo.x;  _f(4)=fo.y;  _f(5)=fo.z;
@@ -279,32 +297,42 @@ void F_Link::updateFeatherstones() {
 
 void FeatherstoneInterface::setGravity(double g) {
   rai::Vector grav(0, 0, g);
-  for(rai::Frame* f: C.frames) {
-    F_Link& link=tree(f->ID);
-    link.force = link.mass * grav;
-  }
+  for(F_Link& link:tree) { link.force = link.mass * grav;  link.updateFeatherstones(); }
+  gravityForces = g;
 }
 
 void FeatherstoneInterface::update() {
-  if(tree.N != C.frames.N) { //new instance -> create the tree
-    CHECK_EQ(C.frames, sortedFrames, "Featherstone requires a sorted optimized frame tree (call optimizeTree and fwdIndexIDs)");
+  const FrameL& frames = subset.N ? subset : C.frames;
+  if(tree.N != frames.N) { //new instance -> create the tree
+    intA index;
+    if(!subset.N) {
+      CHECK_EQ(C.frames, sortedFrames, "Featherstone requires a sorted optimized frame tree (call optimizeTree and fwdIndexIDs)");
+    } else {
+      index.resize(C.frames.N) = -1;
+      for(uint i=0; i<subset.N; i++) index(subset.elem(i)->ID) = i;
+    }
     tree.clear();
-    tree.resize(C.frames.N);
+    tree.resize(frames.N);
+    gravityForces = 0.;
 
     for(F_Link& link:tree) { link.parent=-1; link.qIndex=-1; link.com.setZero(); } //TODO: remove
 
     uint n=0;
-    for(rai::Frame* f : C.frames) {
-      F_Link& link=tree(f->ID);
-      link.ID = f->ID;
+    for(uint i=0; i<frames.N; i++) {
+      rai::Frame* f = frames.elem(i);
+      F_Link& link=tree(i);
+      link.ID = i;
       link.X = f->ensure_X();
-      if(f->parent) { //is not a root
-        link.parent = f->parent->ID;
+      int parent = -1;
+      if(f->parent) parent = subset.N ? index(f->parent->ID) : f->parent->ID;
+      if(parent!=-1) { //is not a root
+        CHECK(parent<(int)i, "the frames are not sorted topologically");
+        link.parent = parent;
         link.Q = f->get_Q();
         rai::Joint* j=f->joint;
         if(j && !j->mimic) {
           link.type   = j->type;
-          link.qIndex = j->qIndex;
+          link.qIndex = subset.N ? n : j->qIndex;
         } else {
           if(j && j->mimic) LOG(0) <<"Featherstone cannot handle mimic joint ('" <<f->name <<"') properly - assuming rigid";
           link.type   = rai::JT_rigid;
@@ -323,10 +351,11 @@ void FeatherstoneInterface::update() {
     }
 //    CHECK_EQ(n, C.getJointStateDimension(), "");
   } else { //just update an existing structure
-    for(rai::Frame* f: C.frames) {
-      F_Link& link=tree(f->ID);
+    for(uint i=0; i<frames.N; i++) {
+      rai::Frame* f = frames.elem(i);
+      F_Link& link=tree(i);
       link.X = f->ensure_X();
-      if(f->parent) link.Q = f->get_Q();
+      if(link.parent!=-1) link.Q = f->get_Q();
     }
   }
 
@@ -442,18 +471,17 @@ void Featherstone::RBmci(arr& rbi, double m, double* c, const rai::Matrix& I) {
   % RBmci(m, c, I) calculate MF6 rigid-body inertia tensor for a body with
   % mass m, centre of mass at c, and (3x3) rotational inertia about CoM of I.
   */
-  arr C(3, 3);
-  skew(C, c);
-  //C = [ 0, -c(3), c(2); c(3), 0, -c(1); -c(2), c(1), 0 ];
-  arr II;
-  II.referTo(&I.m00, 9);
-  II.reshape(3, 3);
-
-  rbi.resize(6,6);
-  rbi.setMatrixBlock(II + m*C*~C, 0,0);
-  rbi.setMatrixBlock(m*C, 0,3);
-  rbi.setMatrixBlock(m*~C, 3,0);
-  rbi.setMatrixBlock(m*eye(3), 3,3);
+  rbi.resize(6, 6);
+  double C[9] = {0., -c[2], c[1],  c[2], 0., -c[0],  -c[1], c[0], 0.};
+  const double* II = &I.m00;
+  for(uint i=0; i<3; i++) for(uint j=0; j<3; j++) {
+      double CC=0.;
+      for(uint k=0; k<3; k++) CC += C[3*i+k]*C[3*j+k];
+      rbi(i, j) = II[3*i+j] + m*CC;
+      rbi(i, j+3) = m*C[3*i+j];
+      rbi(i+3, j) = m*C[3*j+i];
+      rbi(i+3, j+3) = (i==j ? m : 0.);
+    }
   //rbi = [ I + m*C*C', m*C; m*C', m*eye(3) ];
 }
 
@@ -687,324 +715,448 @@ void Featherstone::fwdDynamics_old(arr& qdd,
 #endif
 
 //===========================================================================
+//
+// recursive algorithms on flat buffers: spatial vectors are [angular; linear], transforms and inertias are row-major
+// 6x6, the motion subspace of a link with d dofs is row-major (6,d)
+//
 
-/* Articulated Body Dynamics - exactly as in my `simulationSoftware notes',
-   following the notation of Featherstone's recent short survey paper */
-void FeatherstoneInterface::fwdDynamics_aba_nD(arr& qdd,
-    const arr& qd,
-    const arr& tau) {
-  int par;
-  uint i, N=tree.N, d_i, n;
-  rai::Array<arr> h(N), qd_i(N), qdd_i(N), tau_i(N), I_h(N), h_I_h(N), u(N);
-  arr Xup(N, 6, 6), v(N, 6), dh_dq(N, 6), IA(N, 6, 6), fA(N, 6), a(N, 6);
-  qdd.resizeAs(tau);
+namespace {
 
-  for(i=0, n=0; i<N; i++) {
-    d_i=tree(i).dof();
-    if(d_i) {
-      qd_i(i) .referToRange(qd, n, n+d_i-1);
-      qdd_i(i).referToRange(qdd, n, n+d_i-1);
-      tau_i(i).referToRange(tau, n, n+d_i-1);
-    } else {
-      qd_i(i) .clear(); qd_i(i). resize(0);
-      qdd_i(i).clear(); qdd_i(i).resize(0);
-      tau_i(i).clear(); tau_i(i).resize(0);
-    }
-    n += d_i;
-    h(i) = tree(i)._h;
-    h(i).reshape(6, d_i);
-    Xup[i] = tree(i)._Q; //the transformation from the i-th to the j-th
-  }
-  CHECK(n==qd.N && n==qdd.N && n==tau.N, "")
+/// y = X x
+inline void mul6(double* y, const double* X, const double* x) {
+  for(uint i=0; i<6; i++, X+=6) y[i] = X[0]*x[0] + X[1]*x[1] + X[2]*x[2] + X[3]*x[3] + X[4]*x[4] + X[5]*x[5];
+}
 
-  for(i=0; i<N; i++) {
-    par = tree(i).parent;
-    if(par == -1) {
-      v[i] = h(i) * qd_i(i);
-      dh_dq[i] = 0.;
-    } else {
-      v[i] = Xup[i] * v[par] + h(i) * qd_i(i);
-      dh_dq[i] = Featherstone::crossM(v[i]) * h(i) * qd_i(i);
-    }
-    IA[i] = tree(i)._I;
-    fA[i] = Featherstone::crossF(v[i]) * tree(i)._I * v[i] - tree(i)._f;
-  }
+/// y += X^T x
+inline void mul6t_add(double* y, const double* X, const double* x) {
+  for(uint j=0; j<6; j++, X+=6) for(uint i=0; i<6; i++) y[i] += X[i]*x[j];
+}
 
-  for(i=N; i--;) {
-    par = tree(i).parent;
-    I_h(i) = IA[i] * h(i);
-    if(tree(i).dof()) {
-      h_I_h(i) = ~h(i)*I_h(i);
-      u(i) = tau_i(i) - ~I_h(i)*dh_dq[i] - ~h(i)*fA[i];
-    } else {
-      h_I_h(i).clear(); h_I_h(i).resize(0);
-      u(i).clear(); u(i).resize(0);
-    }
-    if(par != -1) {
-      IA[par] += ~Xup[i] * (IA[i] - I_h(i)*inverse(h_I_h(i))*~I_h(i)) * Xup[i];
-      fA[par] += ~Xup[i] * (fA[i] + IA[i]*dh_dq[i] + I_h(i)*inverse(h_I_h(i))*u(i));
-    }
-  }
+/// y = v x m (motion cross product)
+inline void crossM(double* y, const double* v, const double* m) {
+  y[0] = v[1]*m[2] - v[2]*m[1];
+  y[1] = v[2]*m[0] - v[0]*m[2];
+  y[2] = v[0]*m[1] - v[1]*m[0];
+  y[3] = v[1]*m[5] - v[2]*m[4] + v[4]*m[2] - v[5]*m[1];
+  y[4] = v[2]*m[3] - v[0]*m[5] + v[5]*m[0] - v[3]*m[2];
+  y[5] = v[0]*m[4] - v[1]*m[3] + v[3]*m[1] - v[4]*m[0];
+}
 
-  for(i=0; i<N; i++) {
-    par=tree(i).parent;
-    if(par == -1) {
-      a[i] = 0; //Xup[i] * grav_accn;
-    } else {
-      a[i] = Xup[i] * a[par];
+/// y += v x* f (force cross product)
+inline void crossF_add(double* y, const double* v, const double* f) {
+  y[0] += v[1]*f[2] - v[2]*f[1] + v[4]*f[5] - v[5]*f[4];
+  y[1] += v[2]*f[0] - v[0]*f[2] + v[5]*f[3] - v[3]*f[5];
+  y[2] += v[0]*f[1] - v[1]*f[0] + v[3]*f[4] - v[4]*f[3];
+  y[3] += v[1]*f[5] - v[2]*f[4];
+  y[4] += v[2]*f[3] - v[0]*f[5];
+  y[5] += v[0]*f[4] - v[1]*f[3];
+}
+
+/// Y += X^T A X
+inline void congruence6_add(double* Y, const double* X, const double* A) {
+  double AX[36];
+  for(uint i=0; i<6; i++) for(uint j=0; j<6; j++) {
+      double s=0.;
+      for(uint k=0; k<6; k++) s += A[6*i+k]*X[6*k+j];
+      AX[6*i+j]=s;
     }
-    if(tree(i).dof()) {
-      qdd_i(i) = inverse(h_I_h(i))*(u(i) - ~I_h(i)*a[i]);
+  for(uint i=0; i<6; i++) for(uint j=0; j<6; j++) {
+      double s=0.;
+      for(uint k=0; k<6; k++) s += X[6*k+i]*AX[6*k+j];
+      Y[6*i+j] += s;
     }
-    a[i] = a[i] + dh_dq[i] + h(i)*qdd_i(i);
-  }
 }
 
-//===========================================================================
+/// inverse of a small (d,d) positive definite matrix by Gauss-Jordan elimination
+inline void inverseSmall(double* Ainv, const double* A, uint d) {
+  if(d==1) { Ainv[0] = 1./A[0]; return; }
+  double B[36];
+  memcpy(B, A, d*d*sizeof(double));
+  for(uint i=0; i<d*d; i++) Ainv[i]=0.;
+  for(uint i=0; i<d; i++) Ainv[i*d+i]=1.;
+  for(uint k=0; k<d; k++) {
+    double p = 1./B[k*d+k];
+    for(uint j=0; j<d; j++) { B[k*d+j]*=p; Ainv[k*d+j]*=p; }
+    for(uint i=0; i<d; i++) if(i!=k) {
+        double e = B[i*d+k];
+        for(uint j=0; j<d; j++) { B[i*d+j] -= e*B[k*d+j]; Ainv[i*d+j] -= e*Ainv[k*d+j]; }
+      }
+  }
+}
 
-void FeatherstoneInterface::fwdDynamics_aba_1D(arr& qdd,
-    const arr& qd,
-    const arr& tau) {
-  int par;
-  int iq;
-  uint i, N=tree.N;
-  arr h(N, 6), I_h(N, 6), h_I_h(N), inv_h_I_h(N), taui(N), tau__h_fA(N);
-  arr Xup(N, 6, 6), v(N, 6), dh_dq(N, 6), IA(N, 6, 6), fA(N, 6), a(N, 6);
-  arr vJ, Ia, fa;
-  qdd.resizeAs(tau);
+}
 
-  h.setZero();
-  v.setZero();
-  dh_dq.setZero();
-  taui.setZero();
+void FeatherstoneInterface::resizeBuffers(uint n) {
+  uint N=tree.N;
+  if(buf.v.d0!=N) {
+    for(arr* x: {&buf.v, &buf.c, &buf.a, &buf.f, &buf.pA, &buf.u, &buf.dv, &buf.da, &buf.df, &buf.ds}) x->resize(N, 6);
+    for(arr* x: {&buf.IA, &buf.U, &buf.Dinv}) x->resize(N, 6, 6);
+  }
+  if(buf.filled.N!=n) {
+    buf.b.resize(n);
+    buf.x.resize(n);
+    buf.filled.resize(n) = false;
+    for(F_Link& link:tree) for(uint k=0; k<link.dof(); k++) buf.filled(link.qIndex+k) = true;
+  }
+}
 
-  //fwd: compute the velocities v[i] and external + Coriolis forces fA[i] of all bodies
-  // v[i] = total velocity, but in joint coordinates
-  for(i=0; i<N; i++) {
-    F_Link& link = tree(i);
-    iq  = link.qIndex;
-    par = link.parent;
-    Xup[i] = link._Q; //the transformation from the i-th to the j-th
-    if(par!=-1) {
-      h[i] = link._h;
-      if(iq!=-1) {//is not a fixed joint
-        vJ = h[i] * qd(iq); //equation (2), vJ = relative vel across joint i
-        v[i] = Xup[i] * v[par] + vJ; //eq (27)
-        dh_dq[i] = Featherstone::crossM(v[i]) * vJ;  //WHY??
-        taui(i) = tau(iq);
+void FeatherstoneInterface::setRootAccelerations(bool gravity) {
+  //roots accelerate upwards instead of all links being pulled down: a = X_root * (0, 0, 0, 0, 0, 9.81)
+  CHECK(!gravity || !gravityForces, "gravity is already given as external forces (setGravity) -- use gravity=false or setGravity(0.)");
+  double X[36];
+  for(uint i=0; i<tree.N; i++) if(tree(i).parent==-1) {
+      double* a = buf.a.p+6*i;
+      if(gravity) {
+        FrameToMatrix(X, tree(i).X);
+        for(uint r=0; r<6; r++) a[r] = 9.81*X[6*r+5];
       } else {
-        v[i] = Xup[i] * v[par]; //eq (27)
+        for(uint r=0; r<6; r++) a[r] = 0.;
       }
     }
-    IA[i] = tree(i)._I;
-    fA[i] = Featherstone::crossF(v[i]) * (tree(i)._I * v[i]) - tree(i)._f;  //first part of eq (29)
+}
+
+void FeatherstoneInterface::fwdDynamics_aba_nD(arr& qdd, const arr& qd, const arr& tau, bool gravity, arr& qdd_q, arr& qdd_qd, arr& qdd_tau) {
+  uint N=tree.N, n=qd.N;
+  CHECK_EQ(tau.N, n, "");
+  resizeBuffers(n);
+  qdd = tau; //(dofs that are not part of the tree)
+
+  //-- fwd: velocities, velocity-product accelerations c, bias forces pA
+  for(uint i=0; i<N; i++) {
+    F_Link& link = tree(i);
+    uint d = link.dof();
+    double *v=buf.v.p+6*i, *c=buf.c.p+6*i, *pA=buf.pA.p+6*i;
+    if(link.parent==-1) {
+      for(uint r=0; r<6; r++) v[r]=c[r]=0.;
+    } else {
+      double vJ[6] = {0., 0., 0., 0., 0., 0.};
+      for(uint r=0; r<6; r++) for(uint k=0; k<d; k++) vJ[r] += link._h.p[r*d+k]*qd.p[link.qIndex+k];
+      mul6(v, link._Q.p, buf.v.p+6*link.parent);
+      for(uint r=0; r<6; r++) v[r] += vJ[r];
+      crossM(c, v, vJ);
+    }
+    memmove(buf.IA.p+36*i, link._I.p, 36*sizeof(double));
+    double Iv[6];
+    mul6(Iv, link._I.p, v);
+    for(uint r=0; r<6; r++) pA[r] = -link._f.p[r]; //(external forces)
+    crossF_add(pA, v, Iv);
   }
 
-  //bwd: propagate tree inertia
-  for(i=N; i--;) {
+  //-- bwd: articulated inertias IA and bias forces pA
+  for(uint i=N; i--;) {
     F_Link& link = tree(i);
-    par = link.parent;
-    //eq (28)
-    if(par!=-1) {
-      if(link.qIndex!=-1) {
-        I_h[i]     = IA[i] * h[i];
-        h_I_h(i)     = scalarProduct(h[i], I_h[i]);
-        inv_h_I_h(i) = 1./h_I_h(i);
-        tau__h_fA(i) = taui(i) - scalarProduct(h[i], fA[i]); //[change from above] last term in (13), 2nd equation below (13)
-        Ia = IA[i] - I_h[i]*(inv_h_I_h(i)*~I_h[i]);
-        fa = fA[i] + Ia*dh_dq[i] + I_h[i]*(inv_h_I_h(i)*tau__h_fA(i));
-        IA[par] = IA[par] + ~Xup[i] * Ia * Xup[i];         //equation (12)
-        fA[par] = fA[par] + ~Xup[i] * fa;                  //equation (13)
-      } else {
-        IA[par] = IA[par] + ~Xup[i] * IA[i] * Xup[i];         //equation (12)
-        fA[par] = fA[par] + ~Xup[i] * fA[i];                  //equation (13)
+    uint d = link.dof();
+    const double *S=link._h.p, *c=buf.c.p+6*i;
+    double *IA=buf.IA.p+36*i, *pA=buf.pA.p+6*i, *U=buf.U.p+36*i, *Dinv=buf.Dinv.p+36*i, *u=buf.u.p+6*i;
+    double Ia[36], pa[6];
+    memmove(Ia, IA, 36*sizeof(double));
+    memmove(pa, pA, 6*sizeof(double));
+    if(d) {
+      double D[36];
+      for(uint r=0; r<6; r++) for(uint k=0; k<d; k++) { //U = IA S
+          double s=0.;
+          for(uint l=0; l<6; l++) s += IA[6*r+l]*S[l*d+k];
+          U[6*r+k]=s;
+        }
+      for(uint k=0; k<d; k++) {
+        for(uint l=0; l<d; l++) { //D = S^T U
+          double s=0.;
+          for(uint r=0; r<6; r++) s += S[r*d+k]*U[6*r+l];
+          D[k*d+l]=s;
+        }
+        double s=tau.p[link.qIndex+k]; //u = tau - S^T pA
+        for(uint r=0; r<6; r++) s -= S[r*d+k]*pA[r];
+        u[k]=s;
+      }
+      inverseSmall(Dinv, D, d);
+      double UDinv[36], Du[6];
+      for(uint r=0; r<6; r++) for(uint k=0; k<d; k++) {
+          double s=0.;
+          for(uint l=0; l<d; l++) s += U[6*r+l]*Dinv[l*d+k];
+          UDinv[6*r+k]=s;
+        }
+      for(uint k=0; k<d; k++) { double s=0.; for(uint l=0; l<d; l++) s += Dinv[k*d+l]*u[l]; Du[k]=s; }
+      for(uint r=0; r<6; r++) {
+        for(uint l=0; l<6; l++) for(uint k=0; k<d; k++) Ia[6*r+l] -= UDinv[6*r+k]*U[6*l+k]; //Ia = IA - U D^-1 U^T
+        for(uint k=0; k<d; k++) pa[r] += U[6*r+k]*Du[k]; //pa = pA + Ia c + U D^-1 u
       }
     }
+    if(link.parent!=-1) {
+      for(uint r=0; r<6; r++) for(uint l=0; l<6; l++) pa[r] += Ia[6*r+l]*c[l];
+      congruence6_add(buf.IA.p+36*link.parent, link._Q.p, Ia);
+      mul6t_add(buf.pA.p+6*link.parent, link._Q.p, pa);
+    }
   }
 
-  for(i=0; i<N; i++) {
+  //-- fwd: accelerations
+  setRootAccelerations(gravity);
+  for(uint i=0; i<N; i++) {
     F_Link& link = tree(i);
-    iq = link.qIndex;
-    par= link.parent;
-    if(par != -1) {
-      a[i] = Xup[i] * a[par] + dh_dq[i]; //[change from above]
-      if(iq!=-1) {
-        qdd(iq) = inv_h_I_h(i)*(tau__h_fA(i) - scalarProduct(I_h[i], a[i])); //equation (14)
-        a[i] = a[i] + h[i]*qdd(iq); //equation above (14)
+    uint d = link.dof();
+    double* a=buf.a.p+6*i;
+    if(link.parent!=-1) {
+      mul6(a, link._Q.p, buf.a.p+6*link.parent);
+      for(uint r=0; r<6; r++) a[r] += buf.c.p[6*i+r];
+    }
+    if(d) {
+      const double *S=link._h.p, *U=buf.U.p+36*i, *Dinv=buf.Dinv.p+36*i, *u=buf.u.p+6*i;
+      double w[6];
+      for(uint k=0; k<d; k++) { double s=u[k]; for(uint r=0; r<6; r++) s -= U[6*r+k]*a[r]; w[k]=s; }
+      double* qdd_i = qdd.p+link.qIndex;
+      for(uint k=0; k<d; k++) { double s=0.; for(uint l=0; l<d; l++) s += Dinv[k*d+l]*w[l]; qdd_i[k]=s; }
+      for(uint r=0; r<6; r++) for(uint k=0; k<d; k++) a[r] += S[r*d+k]*qdd_i[k];
+    }
+  }
+
+  //-- Jacobians: qdd = M^{-1} (tau - F(q, qd)) -> -M^{-1} dtau/d(q, qd) at the current qdd, with M^{-1} via abaSolve
+  if(!!qdd_q || !!qdd_qd || !!qdd_tau) {
+    arr tau_q, tau_qd;
+    invDynamics(buf.tauBuf, qd, qdd, gravity, !!qdd_q ? tau_q : NoArr, !!qdd_qd ? tau_qd : NoArr);
+    auto solveColumns = [this, n](arr& J, const arr& B, double sign) {
+      J.resize(n, n);
+      for(uint k=0; k<n; k++) {
+        for(uint i=0; i<n; i++) buf.b.p[i] = B.N ? sign*B.p[i*n+k] : double(i==k);
+        abaSolve(buf.x.p, buf.b.p);
+        for(uint i=0; i<n; i++) J.p[i*n+k] = buf.x.p[i];
       }
-    } else {
-      a[i] = dh_dq[i]; //[change from above]
+    };
+    if(!!qdd_q) solveColumns(qdd_q, tau_q, -1.);
+    if(!!qdd_qd) solveColumns(qdd_qd, tau_qd, -1.);
+    if(!!qdd_tau) solveColumns(qdd_tau, NoArr, 1.);
+  }
+}
+
+void FeatherstoneInterface::abaSolve(double* x, const double* b) {
+  //x = M^{-1} b with the articulated inertias of the last fwdDynamics_aba_nD, without velocities and gravity
+  uint N=tree.N;
+  for(uint i=0; i<N; i++) for(uint r=0; r<6; r++) buf.pA.p[6*i+r]=0.;
+  for(uint i=N; i--;) {
+    F_Link& link = tree(i);
+    uint d = link.dof();
+    const double *S=link._h.p, *U=buf.U.p+36*i, *Dinv=buf.Dinv.p+36*i;
+    double *pA=buf.pA.p+6*i, *u=buf.u.p+6*i;
+    double pa[6];
+    memmove(pa, pA, 6*sizeof(double));
+    if(d) {
+      double Du[6];
+      for(uint k=0; k<d; k++) { double s=b[link.qIndex+k]; for(uint r=0; r<6; r++) s -= S[r*d+k]*pA[r]; u[k]=s; }
+      for(uint k=0; k<d; k++) { double s=0.; for(uint l=0; l<d; l++) s += Dinv[k*d+l]*u[l]; Du[k]=s; }
+      for(uint r=0; r<6; r++) for(uint k=0; k<d; k++) pa[r] += U[6*r+k]*Du[k];
+    }
+    if(link.parent!=-1) mul6t_add(buf.pA.p+6*link.parent, link._Q.p, pa);
+  }
+  for(uint i=0; i<buf.filled.N; i++) if(!buf.filled.p[i]) x[i]=b[i];
+  for(uint i=0; i<N; i++) {
+    F_Link& link = tree(i);
+    uint d = link.dof();
+    double* a=buf.a.p+6*i;
+    if(link.parent==-1) for(uint r=0; r<6; r++) a[r]=0.;
+    else mul6(a, link._Q.p, buf.a.p+6*link.parent);
+    if(d) {
+      const double *S=link._h.p, *U=buf.U.p+36*i, *Dinv=buf.Dinv.p+36*i, *u=buf.u.p+6*i;
+      double w[6];
+      for(uint k=0; k<d; k++) { double s=u[k]; for(uint r=0; r<6; r++) s -= U[6*r+k]*a[r]; w[k]=s; }
+      double* x_i = x+link.qIndex;
+      for(uint k=0; k<d; k++) { double s=0.; for(uint l=0; l<d; l++) s += Dinv[k*d+l]*w[l]; x_i[k]=s; }
+      for(uint r=0; r<6; r++) for(uint k=0; k<d; k++) a[r] += S[r*d+k]*x_i[k];
     }
   }
 }
 
 //===========================================================================
 
-void FeatherstoneInterface::invDynamics(arr& tau,
-                                        const arr& qd,
-                                        const arr& qdd) {
-  int par;
-  uint i, N=tree.N, d_i, qidx;
-  rai::Array<arr> h(N), qd_i(N), qdd_i(N), tau_i(N);
-  arr Xup(N, 6, 6), v(N, 6), fJ(N, 6), a(N, 6);
-  tau.resizeAs(qdd);
+void FeatherstoneInterface::invDynamics(arr& tau, const arr& qd, const arr& qdd, bool gravity, arr& tau_q, arr& tau_qd, arr& tau_qdd) {
+  uint N=tree.N, n=qd.N;
+  CHECK_EQ(qdd.N, n, "");
+  resizeBuffers(n);
+  tau = qdd; //(dofs that are not part of the tree)
 
-  for(i=0; i<N; i++) {
-    d_i = tree(i).dof();
-    qidx = tree(i).qIndex;
-    if(d_i) {
-      qd_i(i) .referToRange(qd, qidx, qidx+d_i-1);
-      qdd_i(i).referToRange(qdd, qidx, qidx+d_i-1);
-      tau_i(i).referToRange(tau, qidx, qidx+d_i-1);
-    } else {
-      qd_i(i) .clear(); qd_i(i). resize(0);
-      qdd_i(i).clear(); qdd_i(i).resize(0);
-      tau_i(i).clear(); tau_i(i).resize(0);
-    }
-    if(d_i!=0) {
-      h(i) = tree(i)._h;
-      h(i).reshape(6, d_i);
+  //-- fwd: velocities, accelerations, and the forces f = I a + v x* I v - f_ext each link needs (the joint velocities vJ
+  //   are kept in the c buffer for the Jacobians)
+  setRootAccelerations(gravity);
+  for(uint i=0; i<N; i++) {
+    F_Link& link = tree(i);
+    uint d = link.dof();
+    double *v=buf.v.p+6*i, *a=buf.a.p+6*i, *f=buf.f.p+6*i, *vJ=buf.c.p+6*i;
+    for(uint r=0; r<6; r++) vJ[r]=0.;
+    if(link.parent==-1) {
+      for(uint r=0; r<6; r++) v[r]=0.;
     } else {
-      h(i).resize(6, 0u);
+      double aJ[6] = {0., 0., 0., 0., 0., 0.}, c[6];
+      for(uint r=0; r<6; r++) for(uint k=0; k<d; k++) {
+          vJ[r] += link._h.p[r*d+k]*qd.p[link.qIndex+k];
+          aJ[r] += link._h.p[r*d+k]*qdd.p[link.qIndex+k];
+        }
+      mul6(v, link._Q.p, buf.v.p+6*link.parent);
+      for(uint r=0; r<6; r++) v[r] += vJ[r];
+      crossM(c, v, vJ);
+      mul6(a, link._Q.p, buf.a.p+6*link.parent);
+      for(uint r=0; r<6; r++) a[r] += aJ[r] + c[r];
     }
-    Xup[i] = tree(i)._Q; //the transformation from the i-th to the j-th
+    double Iv[6];
+    mul6(f, link._I.p, a);
+    mul6(Iv, link._I.p, v);
+    crossF_add(f, v, Iv);
+    for(uint r=0; r<6; r++) f[r] -= link._f.p[r];
   }
-  //CHECK(n==qd.N && n==qdd.N && n==tau.N, "")
 
-  for(i=0; i<N; i++) {
-    par = tree(i).parent;
-    if(par == -1) {
-      v[i] = h(i) * qd_i(i);
-      a[i] = h(i) * qdd_i(i);
-    } else {
-      v[i] = Xup[i] * v[par] + h(i) * qd_i(i);
-      a[i] = Xup[i] * a[par] + h(i) * qdd_i(i) + Featherstone::crossM(v[i]) * h(i) * qd_i(i);
+  //-- bwd: accumulate forces towards the roots; the joints take their projection
+  for(uint i=N; i--;) {
+    F_Link& link = tree(i);
+    uint d = link.dof();
+    const double* f = buf.f.p+6*i;
+    for(uint k=0; k<d; k++) {
+      double s=0.;
+      for(uint r=0; r<6; r++) s += link._h.p[r*d+k]*f[r];
+      tau.p[link.qIndex+k] = s;
     }
-    //see featherstone-orin paper for definition of fJ (different to fA; it's about force equilibrium at a joint)
-    fJ[i] = tree(i)._I*a[i] + Featherstone::crossF(v[i]) * tree(i)._I * v[i] - tree(i)._f;
+    if(link.parent!=-1) mul6t_add(buf.f.p+6*link.parent, link._Q.p, f);
   }
 
-  for(i=N; i--;) {
-    par = tree(i).parent;
-    d_i = tree(i).dof();
-    if(d_i!=0){
-      qidx = tree(i).qIndex;
-      tau_i(qidx) = ~h(i) * fJ[i];
-    }
-    if(par != -1)     fJ[par] += ~Xup[i] * fJ[i];
+  //-- Jacobians, one dof at a time
+  for(int wrt=0; wrt<3; wrt++) {
+    arr& J = (wrt==0 ? tau_q : (wrt==1 ? tau_qd : tau_qdd));
+    if(!J) continue;
+    J.resize(n, n).setZero();
+    for(uint i=0; i<n; i++) if(wrt==2 && !buf.filled.p[i]) J.p[i*n+i] = 1.;
+    for(uint j=0; j<N; j++) for(uint k=0; k<tree(j).dof(); k++) invDynamics_tangent(J, j, k, wrt);
   }
 }
 
-//===========================================================================
-
-void FeatherstoneInterface::equationOfMotion(arr& H, arr& C,
-    const arr& qd) {
-
-  /*function  [H, C] = HandC( model, q, qd, f_ext, grav_accn )
-
-  % HandC  Calculate coefficients of equation of motion.
-  % [H, C]=HandC(model, q, qd, f_ext, grav_accn) calculates the coefficients of
-  % the joint-space equation of motion, tau=H(q)qdd+C(d, qd, f_ext), where q,
-  % qd and qdd are the joint position, velocity and acceleration vectors, H
-  % is the joint-space inertia matrix, C is the vector of gravity,
-  % external-force and velocity-product terms, and tau is the joint force
-  % vector.  Algorithm: recursive Newton-Euler for C, and
-  % Composite-Rigid-Body for H.  f_ext is a cell array specifying external
-  % forces acting on the bodies.  If f_ext == {} then there are no external
-  % forces; otherwise, f_ext{i} is a spatial force vector giving the force
-  % acting on body i, expressed in body i coordinates.  Empty cells in f_ext
-  % are interpreted as zero forces.  grav_accn is a 3D vector expressing the
-  % linear acceleration due to gravity.  The arguments f_ext and grav_accn
-  % are optional, and default to the values {} and [0, 0, -9.81], respectively,
-  % if omitted.
-  */
-
-  int par;
-  int iq, jq;
-  uint i, j, N=tree.N;
-  //CHECK_EQ(N-1,qd.N,"vels don't have right dimension")
-  arr h(N, 6);
-  arr Xup(N, 6, 6), v(N, 6), dh_dq(N, 6), IC(N, 6, 6), fvp(N, 6), avp(N, 6);
-  arr vJ, fh;
-
-  h.setZero();
-  v.setZero();
-  dh_dq.setZero();
-  avp.setZero();
-
-  for(i=0; i<N; i++) {
-    iq  = tree(i).qIndex;
-    par = tree(i).parent;
-    Xup[i] = tree(i)._Q; //the transformation from the i-th to the j-th
-    if(par!=-1) {
-      h[i] = tree(i)._h;
-      if(iq!=-1) {//is not a fixed joint
-        vJ = h[i] * qd(iq); //equation (2), vJ = relative vel across joint i
-        v[i] = Xup[i]*v[par] + vJ;
-        dh_dq[i] = Featherstone::crossM(v[i]) * vJ;  //WHY??
-        avp[i] = Xup[i]*avp[par] + Featherstone::crossM(v[i])*vJ;
+void FeatherstoneInterface::invDynamics_tangent(arr& J, uint j, uint k, int wrt) {
+  //forward mode derivative of invDynamics w.r.t. the k-th dof of link j: q (wrt=0), qd (1) or qdd (2) -- as the joint
+  //transform X_j depends on q, dX_j y = -s x (X_j y) for motion and dX_j^T f = X_j^T (s x* f) for force vectors; the
+  //links below j rotate with ds (s in their coordinates), which turns their (world-fixed) external forces
+  uint N=tree.N, n=J.d1, col=tree(j).qIndex+k;
+  F_Link& link_j = tree(j);
+  double s[6];
+  for(uint r=0; r<6; r++) s[r] = link_j._h.p[r*link_j.dof()+k];
+
+  for(uint i=0; i<j; i++) for(uint r=0; r<6; r++) buf.dv.p[6*i+r] = buf.da.p[6*i+r] = buf.df.p[6*i+r] = buf.ds.p[6*i+r] = 0.;
+  for(uint i=j; i<N; i++) {
+    F_Link& link = tree(i);
+    double *dv=buf.dv.p+6*i, *da=buf.da.p+6*i, *df=buf.df.p+6*i, *ds=buf.ds.p+6*i;
+    if(link.parent==-1) {
+      for(uint r=0; r<6; r++) dv[r]=da[r]=df[r]=ds[r]=0.;
+      continue;
+    }
+    const double *v=buf.v.p+6*i, *X=link._Q.p;
+    mul6(dv, X, buf.dv.p+6*link.parent);
+    mul6(da, X, buf.da.p+6*link.parent);
+    const double* vJ = buf.c.p+6*i;
+    double tmp[6], y[6];
+    if(i==j) {
+      if(wrt==0) {
+        mul6(y, X, buf.v.p+6*link.parent); crossM(tmp, s, y);
+        for(uint r=0; r<6; r++) dv[r] -= tmp[r];
+        mul6(y, X, buf.a.p+6*link.parent); crossM(tmp, s, y);
+        for(uint r=0; r<6; r++) da[r] -= tmp[r];
+      } else if(wrt==1) {
+        for(uint r=0; r<6; r++) dv[r] += s[r];
+        crossM(tmp, v, s);
+        for(uint r=0; r<6; r++) da[r] += tmp[r];
       } else {
-        v[i] = Xup[i] * v[par];
-        avp[i] = Xup[i] * avp[par];
+        for(uint r=0; r<6; r++) da[r] += s[r];
       }
     }
-    IC[i] = tree(i)._I;
-    fvp[i] = tree(i)._I*avp[i] + Featherstone::crossF(v[i])*(tree(i)._I*v[i]) - tree(i)._f;
-  }
-
-  C.resize(qd.N).setZero();
-
-  for(i=N; i--;) {
-    iq  = tree(i).qIndex;
-    par = tree(i).parent;
-    if(iq!=-1) {
-      C(iq) += scalarProduct(h[i], fvp[i]);
+    if(wrt!=2) { //d(v x vJ) = dv x vJ (+ v x dvJ, added above)
+      crossM(tmp, dv, vJ);
+      for(uint r=0; r<6; r++) da[r] += tmp[r];
     }
-    if(par!=-1) {
-      fvp[par] += ~Xup[i] * fvp[i];
-      IC[par] += ~Xup[i] * IC[i] * Xup[i];
+    //df = I da + dv x* I v + v x* I dv
+    const double* I = link._I.p;
+    mul6(df, I, da);
+    if(wrt!=2) {
+      mul6(tmp, I, v);
+      crossF_add(df, dv, tmp);
+      mul6(tmp, I, dv);
+      crossF_add(df, v, tmp);
+    }
+    if(wrt==0) { //d(-f_ext): the force fo and torque to are fixed in the world, the center of mass in the link
+      if(i==j) for(uint r=0; r<6; r++) ds[r]=s[r];
+      else mul6(ds, X, buf.ds.p+6*link.parent);
+      const double *fe=link._f.p, *w=ds, *c=link.com.p();
+      double wf[3] = {w[1]*fe[5]-w[2]*fe[4], w[2]*fe[3]-w[0]*fe[5], w[0]*fe[4]-w[1]*fe[3]}; //w x fo
+      double to[3] = {fe[0]-(c[1]*fe[5]-c[2]*fe[4]), fe[1]-(c[2]*fe[3]-c[0]*fe[5]), fe[2]-(c[0]*fe[4]-c[1]*fe[3])};
+      df[0] += w[1]*to[2]-w[2]*to[1] + c[1]*wf[2]-c[2]*wf[1];
+      df[1] += w[2]*to[0]-w[0]*to[2] + c[2]*wf[0]-c[0]*wf[2];
+      df[2] += w[0]*to[1]-w[1]*to[0] + c[0]*wf[1]-c[1]*wf[0];
+      for(uint r=0; r<3; r++) df[3+r] += wf[r];
     }
   }
 
-  H.resize(qd.N, qd.N).setZero();
-
-  for(i=0; i<N; i++) {
-    iq = tree(i).qIndex;
-    fh = IC[i] * h[i];
-    if((int)iq!=-1) {
-      H(iq, iq) += scalarProduct(h[i], fh);
+  for(uint i=N; i--;) {
+    F_Link& link = tree(i);
+    uint d = link.dof();
+    const double* df = buf.df.p+6*i;
+    for(uint l=0; l<d; l++) {
+      double t=0.;
+      for(uint r=0; r<6; r++) t += link._h.p[r*d+l]*df[r];
+      J.p[(link.qIndex+l)*n+col] = t;
     }
-    j = i;
-    while(tree(j).parent!=-1) {
-      fh = ~Xup[j] * fh;
-      j  = tree(j).parent;
-      jq = tree(j).qIndex;
-      if(jq!=-1 && iq!=-1) {
-        double Hij = scalarProduct(h[j], fh);
-        H(iq, jq) += Hij;
-        H(jq, iq) += Hij;
+    if(link.parent!=-1) {
+      mul6t_add(buf.df.p+6*link.parent, link._Q.p, df);
+      if(i==j && wrt==0) {
+        double y[6] = {0., 0., 0., 0., 0., 0.};
+        crossF_add(y, s, buf.f.p+6*i);
+        mul6t_add(buf.df.p+6*link.parent, link._Q.p, y);
       }
     }
   }
+}
+
+//===========================================================================
 
-  //add friction for non-filled joints
-  boolA filled(qd.N);
-  filled=false;
-  for(i=0; i<N; i++) { iq = tree(i).qIndex; if(iq!=-1) filled(iq)=true; }
-  for(i=0; i<qd.N; i++) if(!filled(i)) {
-      H(i, i) = 1.;
-      //C(i) = -100.*qd(i);
+void FeatherstoneInterface::equationOfMotion(arr& M, arr& F, const arr& qd, bool gravity) {
+  uint N=tree.N, n=qd.N;
+  invDynamics(F, qd, zeros(n), gravity);
+
+  //-- composite rigid body inertias (in the IA buffer)
+  for(uint i=0; i<N; i++) memmove(buf.IA.p+36*i, tree(i)._I.p, 36*sizeof(double));
+  for(uint i=N; i--;) if(tree(i).parent!=-1) congruence6_add(buf.IA.p+36*tree(i).parent, tree(i)._Q.p, buf.IA.p+36*i);
+
+  M.resize(n, n).setZero();
+  for(uint i=0; i<n; i++) if(!buf.filled(i)) M(i, i) = 1.;
+  double Fh[36], Fh2[36];
+  for(uint i=0; i<N; i++) {
+    uint d = tree(i).dof();
+    if(!d) continue;
+    const double *S=tree(i)._h.p, *IC=buf.IA.p+36*i;
+    for(uint r=0; r<6; r++) for(uint k=0; k<d; k++) { //Fh = IC S
+        double s=0.;
+        for(uint l=0; l<6; l++) s += IC[6*r+l]*S[l*d+k];
+        Fh[6*r+k]=s;
+      }
+    for(uint j=i;;) {
+      uint dj = tree(j).dof();
+      const double* Sj=tree(j)._h.p;
+      for(uint l=0; l<dj; l++) for(uint k=0; k<d; k++) {
+          double s=0.;
+          for(uint r=0; r<6; r++) s += Sj[r*dj+l]*Fh[6*r+k];
+          M(tree(j).qIndex+l, tree(i).qIndex+k) = M(tree(i).qIndex+k, tree(j).qIndex+l) = s;
+        }
+      if(tree(j).parent==-1) break;
+      const double* X = tree(j)._Q.p;
+      for(uint r=0; r<6; r++) for(uint k=0; k<d; k++) { //Fh = X^T Fh
+          double s=0.;
+          for(uint l=0; l<6; l++) s += X[6*l+r]*Fh[6*l+k];
+          Fh2[6*r+k]=s;
+        }
+      memmove(Fh, Fh2, 36*sizeof(double));
+      j = tree(j).parent;
     }
+  }
 }
 
 //===========================================================================
 
 void FeatherstoneInterface::fwdDynamics_MF(arr& qdd,
     const arr& qd,
-    const arr& u) {
+    const arr& u,
+    bool gravity) {
 
   arr M, Minv, F;
-  equationOfMotion(M, F, qd);
+  equationOfMotion(M, F, qd, gravity);
 //  inverse(Minv, M);
   inverse_SymPosDef(Minv, M);
 
@@ -17,12 +17,13 @@ struct F_Link {
   int qIndex=-1;
   int parent=-1;
   rai::Transformation X=0, Q=0;
-  rai::Vector com=0, force=0, torque=0;
+  rai::Vector com=0;
+  rai::Vector force=0, torque=0; ///< external force (at the center of mass) and torque, in world coordinates
   double mass=0.;
   rai::Matrix inertia=0;
   uint dof();
 
-  arr _h, _Q, _I, _f; //featherstone types
+  arr _h, _Q, _I, _f; //featherstone types (_f: the external force and torque as spatial force in link coordinates)
 
   F_Link() {}
   void setFeatherstones();
@@ -45,14 +46,41 @@ struct FeatherstoneInterface {
 
   rai::Array<F_Link> tree;
 
+  FrameL subset; ///< if set, the tree contains only these frames (e.g. one time slice of a path configuration)
+
   FeatherstoneInterface(rai::Configuration& C):C(C) { sortedFrames = C.calc_topSort(); }
+  /// the dynamics of a subset of (topologically sorted) frames only: frames whose parent is not in the subset are roots,
+  /// tree(i) is the i-th frame, and the dofs are numbered in the order of the frames (not by the joints' qIndex)
+  FeatherstoneInterface(rai::Configuration& C, const FrameL& _subset):C(C), subset(_subset) {}
 
+  /// gravity as external forces of all links (overwriting their forces) -- only with gravity=false in the algorithms
+  /// below, which otherwise accelerate the roots instead; setGravity(0.) clears them again
   void setGravity(double g=-9.81);
+  double gravityForces=0.; ///< the g of the last setGravity, which the algorithms check against gravity=true
   void update();
 
-  void equationOfMotion(arr& M, arr& F,  const arr& qd);
-  void fwdDynamics_MF(arr& qdd, const arr& qd, const arr& u);
-  void fwdDynamics_aba_nD(arr& qdd, const arr& qd, const arr& tau);
-  void fwdDynamics_aba_1D(arr& qdd, const arr& qd, const arr& tau);
-  void invDynamics(arr& tau, const arr& qd, const arr& qdd);
+  //-- the recursive algorithms work on the per-link buffers below, which are only allocated on the first call. Gravity
+  //   enters as acceleration of the roots; links may have several dofs, but their motion subspace _h (6,dof) is constant
+  //   (hinges and translations). Dofs that are not part of the tree (e.g. mimic joints) get unit inertia and no bias.
+
+  /// M via composite rigid bodies, F = invDynamics(qd, qdd=0)
+  void equationOfMotion(arr& M, arr& F,  const arr& qd, bool gravity=true);
+  /// qdd = M^{-1} (u - F), O(n^3) -- only as reference
+  void fwdDynamics_MF(arr& qdd, const arr& qd, const arr& u, bool gravity=true);
+  /// articulated body algorithm, O(n); the Jacobians w.r.t. q, qd and tau are -M^{-1} dinvDynamics/d(q, qd) and M^{-1}
+  void fwdDynamics_aba_nD(arr& qdd, const arr& qd, const arr& tau, bool gravity=true, arr& qdd_q=NoArr, arr& qdd_qd=NoArr, arr& qdd_tau=NoArr);
+  /// recursive Newton-Euler, O(n); its Jacobians are propagated analytically through the recursion (tau_qdd = M)
+  void invDynamics(arr& tau, const arr& qd, const arr& qdd, bool gravity=true, arr& tau_q=NoArr, arr& tau_qd=NoArr, arr& tau_qdd=NoArr);
+
+ private:
+  struct Buffers {
+    arr v, c, a, f, IA, pA, U, Dinv, u; //per link: spatial velocities, accelerations, forces, articulated inertias, ...
+    arr dv, da, df, ds;                //per link tangents (derivatives w.r.t. one dof)
+    arr b, x, tauBuf;                  //per dof
+    boolA filled;                      //whether a dof is part of the tree
+  } buf;
+  void resizeBuffers(uint n);
+  void setRootAccelerations(bool gravity);
+  void invDynamics_tangent(arr& J, uint j, uint k, int wrt);
+  void abaSolve(double* x, const double* b);
 };
@@ -16,6 +16,8 @@
 #include "F_collisions.h"
 #include "../Gui/opengl.h"
 #include "../Algo/SplineCtrlFeed.h"
+#include "../Core/profiler.h"
+#include "../Core/thread.h"
 
 #include <iomanip>
 //#define BACK_BRIDGE
@@ -150,6 +152,7 @@ Simulation::~Simulation() {
 }
 
 void Simulation::step(const arr& u_control, double tau, ControlMode u_mode) {
+  RAI_PROFILE("Simulation::step");
   //-- kill done imps
   for(uint i=imps.N; i--;) {
     if(imps.elem(i)->killMe) imps.remove(i);
@@ -225,6 +228,8 @@ void Simulation::step(const arr& u_control, double tau, ControlMode u_mode) {
     self->bridgeC.view(false, "bullet bridge");
 #endif
   } else if(engine==_kinematic) {
+    if(q_ref.N) C.setJointState(q_ref); //the reference is the next state
+    if(qDot_ref.N) qDot = qDot_ref;
   } else NIY;
 
   //-- imps after physics
@@ -501,6 +506,121 @@ void Simulation::getImageAndDepth(byteA& image, floatA& depth) {
 
 //===========================================================================
 
+SimulationBatch::SimulationBatch(Configuration& C, uint N, Simulation::SimulatorEngine _engine)
+  : engine(_engine) {
+  CHECK(N, "need at least one env");
+  C.ensure_q();
+  //-- the collision models are built once on C; each copy gets its own manager on them (see FclInterface)
+  bool hasCollisions=false;
+  for(Frame* f:C.frames) if(f->shape && f->shape->cont) { hasCollisions=true; break; }
+  configs.resize(N);
+  sims.resize(N);
+  for(uint i=0; i<N; i++) {
+    configs(i) = make_shared<Configuration>(C); //(shallow copies of the meshes)
+    if(hasCollisions) configs(i)->shareFclModels(C);
+    sims(i) = make_shared<Simulation>(*configs(i), engine, 0);
+  }
+}
+
+arr SimulationBatch::getJointStates() {
+  arr Q;
+  for(shared_ptr<Configuration>& C:configs) Q.append(C->getJointState());
+  return Q.reshape(N(), -1);
+}
+
+arr SimulationBatch::getFrameStates() {
+  arr X;
+  for(shared_ptr<Configuration>& C:configs) X.append(C->getFrameState());
+  return X.reshape(N(), -1, 7);
+}
+
+void SimulationBatch::setJointStates(const arr& Q) {
+  CHECK_EQ(Q.d0, N(), "need one joint state per env");
+  for(uint i=0; i<N(); i++) {
+    Simulation& S = *sims(i);
+    S.C.setJointState(Q[i]);
+    S.qDot.clear();
+    S.self->ref.initialize(S.C.getJointState(), NoArr, S.time);
+    if(engine!=Simulation::_kinematic) S.pushConfigurationToSimulator();
+  }
+}
+
+void SimulationBatch::setFrameStates(const arr& X, const arr& frameVelocities) {
+  CHECK_EQ(X.d0, N(), "need one frame state per env");
+  for(uint i=0; i<N(); i++) {
+    Simulation& S = *sims(i);
+    S.C.setFrameState(X[i]);
+    S.C.ensure_q();
+    S.qDot.clear();
+    S.self->ref.initialize(S.C.getJointState(), NoArr, S.time);
+    if(engine!=Simulation::_kinematic) S.pushConfigurationToSimulator(!!frameVelocities ? frameVelocities[i] : NoArr);
+  }
+}
+
+void SimulationBatch::step(const arr& U, double tau, Simulation::ControlMode u_mode) {
+  RAI_PROFILE("SimulationBatch::step");
+  CHECK(!U.N || U.d0==N(), "need one control per env");
+  //(imps that draw random numbers share the global rnd -- run them on a single thread via grain=N if that matters)
+  parallel_for(0, N(), [&](uint i) {
+    sims(i)->step(U.N ? U[i] : arr(), tau, u_mode);
+  }, grain);
+}
+
+void SimulationBatch::addSensor(const char* frameAttached, uint width, uint height, double focalLength, const arr& zRange) {
+  CHECK(configs.N && configs(0)->getFrame(frameAttached), "frame '" <<frameAttached <<"' is not defined");
+  sensorFrame = frameAttached;
+  sensorWidth = width;
+  sensorHeight = height;
+  sensorCam.setZero();
+  if(zRange.N) sensorCam.setZRange(zRange(0), zRange(1));
+  if(focalLength>0.) sensorCam.setFocalLength(focalLength);
+  sensorCam.setWHRatio((double)width/height);
+}
+
+void SimulationBatch::getImagesAndDepths(byteA& images, floatA& depths) {
+  RAI_PROFILE("SimulationBatch::getImagesAndDepths");
+  CHECK(sensorWidth, "add a sensor first");
+
+  auto addInstances = [this](uint i) {
+    RayCaster& R = *rayCasters(i);
+    R.clear();
+    for(Frame* f:configs(i)->frames) if(f->shape) {
+      Shape* s = f->shape;
+      if(s->type()==ST_marker || s->type()==ST_camera || !s->_mesh) continue;
+      R.add(s->_mesh, f->ensure_X(), f->ID);
+    }
+  };
+
+  if(rayCasters.N!=N()) { //the first env builds the BVHs of all meshes, the others adopt them
+    rayCasters.resize(N());
+    imageBuf.resize(N());
+    depthBuf.resize(N());
+    for(shared_ptr<RayCaster>& R:rayCasters) { R = make_shared<RayCaster>(); R->parallel=false; } //(the envs are the parallel tasks)
+    addInstances(0);
+    for(uint i=1; i<N(); i++) rayCasters(i)->shareCache(*rayCasters(0));
+  }
+
+  parallel_for(0, N(), [&](uint i) {
+    addInstances(i);
+    Camera cam = sensorCam;
+    cam.X = configs(i)->getFrame(sensorFrame)->ensure_X();
+    uintA ids;
+    rayCasters(i)->render(depthBuf(i), ids, imageBuf(i), cam, sensorWidth, sensorHeight);
+  }, grain);
+
+  images.resize(uintA{N(), sensorHeight, sensorWidth, 3});
+  depths.resize(uintA{N(), sensorHeight, sensorWidth});
+  for(uint i=0; i<N(); i++) {
+    for(shared_ptr<SimulationImp>& imp : sims(i)->imps) if(imp->when==SimulationImp::_afterImages) {
+        imp->modImages(*sims(i), imageBuf(i), depthBuf(i));
+      }
+    memmove(images.p+i*imageBuf(i).N, imageBuf(i).p, imageBuf(i).sizeT*imageBuf(i).N);
+    memmove(depths.p+i*depthBuf(i).N, depthBuf(i).p, depthBuf(i).sizeT*depthBuf(i).N);
+  }
+}
+
+//===========================================================================
+
 struct Simulation_DisplayThread : Thread, GLDrawer {
   Configuration Ccopy;
   OpenGL gl;
@@ -107,6 +107,44 @@ struct Simulation {
 
 //===========================================================================
 
+//N copies of the same scene (e.g. for policy evaluation or data generation from different initial states), stepped in
+//parallel on the ThreadPool; all states, controls and images are stacked with the env as first dimension. The copies share
+//the shapes' meshes, the fcl collision models and the ray casting BVHs; each has its own Configuration and engine instance
+struct SimulationBatch {
+  Simulation::SimulatorEngine engine;
+  Array<shared_ptr<Configuration>> configs;
+  Array<shared_ptr<Simulation>> sims;
+  uint grain=1; ///< envs per parallel task
+
+  SimulationBatch(Configuration& C, uint N, Simulation::SimulatorEngine _engine);
+
+  uint N() const { return sims.N; }
+  Simulation& operator()(uint i) { return *sims(i); } ///< access to a single env (gripper commands, imps, etc)
+
+  //-- stacked states
+  arr getJointStates();                                            ///< (N,d)
+  arr getFrameStates();                                            ///< (N,frames,7)
+  void setJointStates(const arr& Q);                               ///< (N,d), resets the spline references and velocities
+  void setFrameStates(const arr& X, const arr& frameVelocities=NoArr); ///< (N,frames,7)
+
+  //-- steps all envs; U is (N,d) (or (N,2,d) for _posVel), or empty for the _spline mode
+  void step(const arr& U, double tau=.01, Simulation::ControlMode u_mode=Simulation::_velocity);
+
+  //-- stacked images (N,h,w,3) and depths (N,h,w) of a camera attached to the same frame in each env, ray cast on the CPU
+  void addSensor(const char* frameAttached, uint width=640, uint height=360, double focalLength=-1., const arr& zRange= {});
+  void getImagesAndDepths(byteA& images, floatA& depths);
+
+ private:
+  rai::String sensorFrame;
+  rai::Camera sensorCam;
+  uint sensorWidth=0, sensorHeight=0;
+  Array<shared_ptr<RayCaster>> rayCasters;
+  Array<byteA> imageBuf;
+  Array<floatA> depthBuf;
+};
+
+//===========================================================================
+
 struct TeleopCallbacks : OpenGL::GLClickCall, OpenGL::GLKeyCall, OpenGL::GLHoverCall{
   arr q_ref;
   bool stop=false;
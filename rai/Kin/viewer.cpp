@@ -157,6 +157,13 @@ int rai::ConfigurationViewer::setPath(const arr& _framePath, const char* text, b
 }
 
 bool rai::ConfigurationViewer::playVideo(uint T, uint nFrames, bool watch, double delay, const char* saveVideoPath){
+  CHECK_GE(C.frames.N, T*nFrames, "");
+  uintA sliceFrameIDs = range(T*nFrames);
+  sliceFrameIDs.reshape(T, nFrames);
+  return playVideo(sliceFrameIDs, watch, delay, saveVideoPath);
+}
+
+bool rai::ConfigurationViewer::playVideo(const uintA& sliceFrameIDs, bool watch, double delay, const char* saveVideoPath){
   if(rai::getDisableGui()) return false;
 
   const rai::String tag = drawText;
@@ -166,12 +173,9 @@ bool rai::ConfigurationViewer::playVideo(uint T, uint nFrames, bool watch, doubl
     rai::system(STRING("rm -f " <<saveVideoPath <<"*.png"));
   }
 
-  CHECK_GE(C.frames.N, T*nFrames, "");
-
-  FrameL F;
-  if(C.frames.nd==1) F = C.frames({0,T*nFrames-1});
-  else F = C.frames;
-  F.reshape(T, nFrames);
+  CHECK_EQ(sliceFrameIDs.nd, 2, "");
+  FrameL F = C.getFrames(sliceFrameIDs);
+  F.reshape(sliceFrameIDs.d0, sliceFrameIDs.d1);
 
   for(uint t=0; t<F.d0; t++) {
     {
@@ -21,6 +21,7 @@ struct ConfigurationViewer : GLDrawer {
   int setPath(rai::Configuration& _C, const arr& jointPath, const char* text=0, bool watch=false, bool full=true);
   int setPath(const arr& _framePath, const char* text=0, bool watch=false, bool full=true);
   bool playVideo(uint T, uint nFrames, bool watch=true, double delay=1., const char* saveVideoPath=nullptr); ///< display the trajectory; use "z.vid/" as vid prefix
+  bool playVideo(const uintA& sliceFrameIDs, bool watch=true, double delay=1., const char* saveVideoPath=nullptr); ///< same, with the (T, nFrames) frame indices of each slice given explicitly
   bool playVideo(bool watch=true, double delay=1., const char* saveVideoPath=nullptr); ///< display the trajectory; use "z.vid/" as vid prefix
   rai::Camera& displayCamera();   ///< access to the display camera to change the view
   byteA getScreenshot();
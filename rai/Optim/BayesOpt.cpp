@@ -8,6 +8,8 @@
 
 #include "BayesOpt.h"
 #include "RidgeRegression.h"
+
+#include <math.h>
 //#include "../Gui/plot.h"
 //#include "../Algo/MLcourse.h"
 
@@ -16,7 +18,8 @@ BayesOpt::BayesOpt(const ScalarFunction& _f, const arr& bounds_lo, const arr& bo
     bounds_lo(bounds_lo), bounds_hi(bounds_hi),
     f_now(nullptr), f_smaller(nullptr),
     alphaMinima_now(ScalarFunction(), bounds_lo, bounds_hi),
-    alphaMinima_smaller(ScalarFunction(), bounds_lo, bounds_hi) {
+    alphaMinima_smaller(ScalarFunction(), bounds_lo, bounds_hi),
+    priorVar(prior_var) {
 
   init_lengthScale *= sum(bounds_hi - bounds_lo)/bounds_lo.N;
 
@@ -26,10 +29,13 @@ BayesOpt::BayesOpt(const ScalarFunction& _f, const arr& bounds_lo, const arr& bo
   kernel_now->type = kernel_smaller->type = DefaultKernelFunction::Gauss; //TODO: ugly!!
 
   kernel_now->hyperParam1 = arr{init_lengthScale};
-  kernel_now->hyperParam2 = arr{prior_var};
+  kernel_now->hyperParam2 = arr{1.};
   kernel_smaller->hyperParam1 = kernel_now->hyperParam1;
   kernel_smaller->hyperParam1 /= 2.;
   kernel_smaller->hyperParam2 = kernel_now->hyperParam2;
+
+  //the acquisition functions are thread-safe: their multi-start descents may run concurrently
+  alphaMinima_now.parallelBatch = alphaMinima_smaller.parallelBatch = rai::getParameter<uint>("BayesOpt/parallelBatch", 0);
 }
 
 BayesOpt::~BayesOpt() {
@@ -62,21 +68,21 @@ void BayesOpt::run(uint maxIt) {
 
 void BayesOpt::report(bool display, const ScalarFunction& f) {
   if(!f_now) return;
-  cout <<"mean=" <<f_now->mu <<" var=" <<kernel_now->hyperParam2.scalar() <<endl;
+  cout <<"mean=" <<f_now->mu <<" var=" <<priorVar <<endl;
 
   arr X_grid, s_grid;
   X_grid.setGrid(data_X.d1, 0., 1., (data_X.d1==1?500:30));
   X_grid = X_grid % (bounds_hi-bounds_lo);
   X_grid += repmat(bounds_lo, X_grid.d0, 1);
   arr y_grid = f_now->evaluate(X_grid, s_grid);
-  s_grid = sqrt(s_grid);
+  s_grid = sqrt(priorVar*s_grid);
 
   arr f_grid(X_grid.d0);
   if(f) for(uint i=0; i<X_grid.d0; i++) f_grid(i) = f(NoArr, NoArr, X_grid[i]);
 
   arr s2_grid;
   arr y2_grid = f_smaller->evaluate(X_grid, s2_grid);
-  s2_grid = sqrt(s2_grid);
+  s2_grid = sqrt(priorVar*s2_grid);
 
   arr locmin_X(0u, data_X.d1), locmin_y;
   for(auto& l:alphaMinima_now.localMinima) {
@@ -107,25 +113,23 @@ void BayesOpt::report(bool display, const ScalarFunction& f) {
 }
 
 void BayesOpt::addDataPoint(const arr& x, double y) {
-  if(f_now) delete f_now;
-  if(f_smaller) delete f_smaller;
-
   data_X.append(x);  data_X.reshape(data_X.N/x.N, x.N);
   data_y.append(y);
 
   double fmean = sum(data_y)/data_y.N;
-  if(data_y.N>2) {
-    kernel_now->hyperParam2 = 2.*var(data_y);
-    kernel_smaller->hyperParam2 = kernel_now->hyperParam2;
-  }
-
-  f_now = new KernelRidgeRegression(data_X, data_y, *kernel_now, -1., fmean);
-  f_smaller = new KernelRidgeRegression(data_X, data_y, *kernel_smaller, -1., fmean);
+  if(data_y.N>2) priorVar = 2.*var(data_y);
+
+  //-- grow the regressions by one datum (O(n^2)) instead of refactoring the kernel matrix (O(n^3))
+  if(!f_now) f_now = new KernelRidgeRegression(arr(0u, x.N), {}, *kernel_now, -1., fmean);
+  if(!f_smaller) f_smaller = new KernelRidgeRegression(arr(0u, x.N), {}, *kernel_smaller, -1., fmean);
+  f_now->mu = f_smaller->mu = fmean;
+  f_now->append(x, y);
+  f_smaller->append(x, y);
 }
 
 void BayesOpt::reOptimizeAlphaMinima() {
-  alphaMinima_now.newton.f = f_now->getF(-2.);
-  alphaMinima_smaller.newton.f = f_smaller->getF(-2.);
+  alphaMinima_now.newton.f = f_now->getF(-2.*::sqrt(priorVar));
+  alphaMinima_smaller.newton.f = f_smaller->getF(-2.*::sqrt(priorVar));
 
   alphaMinima_now.reOptimizeAllPoints();
   alphaMinima_now.run(20);
@@ -137,8 +141,8 @@ arr BayesOpt::pickNextPoint() {
   arr x_now = alphaMinima_now.best->x;
   arr x_sma = alphaMinima_smaller.best->x;
 
-  double fx_0 = f_now->evaluate(x_now, NoArr, NoArr, -2., false);
-  double fx_1 = f_smaller->evaluate(x_sma, NoArr, NoArr, -1., false);
+  double fx_0 = f_now->evaluate(x_now, NoArr, NoArr, -2.*::sqrt(priorVar), false);
+  double fx_1 = f_smaller->evaluate(x_sma, NoArr, NoArr, -1.*::sqrt(priorVar), false);
 
   if(fx_1 < fx_0) {
     reduceLengthScale();
@@ -150,6 +154,12 @@ arr BayesOpt::pickNextPoint() {
 
 void BayesOpt::reduceLengthScale() {
   cout <<"REDUCING LENGTH SCALE!!" <<endl;
-  kernel_now->hyperParam1 = kernel_smaller->hyperParam1;
+  //the smaller regression becomes the current one; only the new smaller one is factored from scratch
+  std::swap(kernel_now, kernel_smaller);
+  std::swap(f_now, f_smaller);
+  kernel_smaller->hyperParam1 = kernel_now->hyperParam1;
   kernel_smaller->hyperParam1 /= 2.;
+  double mu = f_smaller->mu;
+  delete f_smaller;
+  f_smaller = new KernelRidgeRegression(data_X, data_y, *kernel_smaller, -1., mu);
 }
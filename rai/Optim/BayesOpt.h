@@ -27,6 +27,7 @@ struct BayesOpt {
   struct DefaultKernelFunction* kernel_now;
   struct DefaultKernelFunction* kernel_smaller;
   double lengthScale;
+  double priorVar; ///< the kernels have unit variance, so that their Cholesky factors can be grown incrementally; sigmas are scaled by sqrt(priorVar)
 
   //lengthScale is always relative to hi-lo
   BayesOpt(const ScalarFunction& f, const arr& bounds_lo, const arr& bounds_hi, double init_lengthScale=1., double prior_var=1., rai::OptOptions o=NOOPT);
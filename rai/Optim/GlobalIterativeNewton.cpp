@@ -7,6 +7,7 @@
     --------------------------------------------------------------  */
 
 #include "GlobalIterativeNewton.h"
+#include "../Core/thread.h"
 
 bool useNewton=true;
 
@@ -67,6 +68,22 @@ void addRunFrom(GlobalIterativeNewton& gin, const arr& x) {
   }
 }
 
+void addRunsFrom_parallel(GlobalIterativeNewton& gin, const arr& X) {
+  //-- the descents only depend on their start (no state is carried over from a previous run, unlike gin.newton)
+  arr Y = X, fY(X.d0);
+  parallel_for(0, X.d0, [&gin, &Y, &fY](uint i) {
+    arr y;
+    OptNewton newton(y, gin.newton.f, gin.newton.options);
+    newton.setBounds(gin.bounds_lo, gin.bounds_hi);
+    newton.reinit(Y[i]);
+    newton.run();
+    Y[i] = y;
+    fY(i) = newton.fx;
+  }, 1);
+  //-- merged sequentially in start order, so hit counts and the best minimum don't depend on scheduling
+  for(uint i=0; i<X.d0; i++) addRun(gin, Y[i], fY(i), 3.*gin.newton.options.stopTolerance);
+}
+
 void GlobalIterativeNewton::step() {
   arr x = bounds_lo + (bounds_hi-bounds_lo) % rand(bounds_lo.N);
   if(newton.options.verbose>1) cout <<"***** optGlobalIterativeNewton: new iteration from x=" <<x <<endl;
@@ -74,6 +91,14 @@ void GlobalIterativeNewton::step() {
 }
 
 void GlobalIterativeNewton::run(uint maxIt) {
+  if(parallelBatch>1) {
+    for(uint i=0; i<maxIt; i+=parallelBatch) {
+      uint n = rai::MIN(parallelBatch, maxIt-i);
+      arr X = repmat(~bounds_lo, n, 1) + repmat(~(bounds_hi-bounds_lo), n, 1) % rand(n, bounds_lo.N);
+      addRunsFrom_parallel(*this, X);
+    }
+    return;
+  }
   for(uint i=0; i<maxIt; i++) {
     step();
   }
@@ -94,5 +119,9 @@ void GlobalIterativeNewton::reOptimizeAllPoints() {
   X.reshape(localMinima.N, X.N/localMinima.N);
   rndGauss(X, .01, true);
   localMinima.clear();
+  if(parallelBatch>1) {
+    for(uint i=0; i<X.d0; i+=parallelBatch) addRunsFrom_parallel(*this, X.sub(i, rai::MIN(i+parallelBatch, X.d0)-1, 0, -1));
+    return;
+  }
   for(uint i=0; i<X.d0; i++) addRunFrom(*this, X[i]);
 }
@@ -21,6 +21,10 @@ struct GlobalIterativeNewton {
   rai::Array<LocalMinimum> localMinima;
   LocalMinimum* best;
 
+  /// >1: run() and reOptimizeAllPoints() do batches of this many descents concurrently (ThreadPool::global), each on
+  /// its own OptNewton from a fresh state, merged in start order -- deterministic for a fixed seed, but f must be thread-safe
+  uint parallelBatch=0;
+
   GlobalIterativeNewton(const ScalarFunction& f, const arr& bounds_lo, const arr& bounds_up, rai::OptOptions o=NOOPT);
   ~GlobalIterativeNewton();
 
@@ -8,6 +8,7 @@
 #include "NLP.h"
 #include "constrained.h"
 #include "utils.h"
+#include "../Core/thread.h"
 
 template<> const char* rai::Enum<NLP_SolverID>::names []= {
   "gradientDescent", "rprop", "LBFGS", "newton",
@@ -63,6 +64,13 @@ shared_ptr<SolverReturn> NLP_Solver::solve(int resampleInitialization){
     Conv_NLP_ScalarProblem P1(P);
     Rprop().loop(x, P1, opt.stopTolerance, opt.initStep, opt.stopEvals, opt.verbose);
   }
+  else if(solverID==NLPS_LBFGS){
+    //augmented Lagrangian with L-BFGS inner steps (just L-BFGS for unconstrained problems)
+    if(opt.lbfgsMemory<=0) opt.set_lbfgsMemory(10);
+    opt.set_constrainedMethod(rai::augmentedLag);
+    optCon = make_shared<OptConstrained>(x, dual, P, opt);
+    optCon->run();
+  }
   else if(solverID==NLPS_augmentedLag){
     opt.set_constrainedMethod(rai::augmentedLag);
     optCon = make_shared<OptConstrained>(x, dual, P, opt);
@@ -120,7 +128,8 @@ shared_ptr<SolverReturn> NLP_Solver::solveStepping(int resampleInitialization){
 bool NLP_Solver::step(){
   CHECK(solverID==NLPS_augmentedLag
         || solverID==NLPS_squaredPenalty
-        || solverID==NLPS_logBarrier, "stepping only implemented for these");
+        || solverID==NLPS_logBarrier
+        || solverID==NLPS_LBFGS, "stepping only implemented for these");
 
   if(!optCon){ //first step -> initialize
     CHECK(!ret, "");
@@ -139,6 +148,9 @@ bool NLP_Solver::step(){
       opt.set_constrainedMethod(rai::squaredPenalty);
     }else if(solverID==NLPS_logBarrier){
       opt.set_constrainedMethod(rai::logBarrier);
+    }else if(solverID==NLPS_LBFGS){
+      if(opt.lbfgsMemory<=0) opt.set_lbfgsMemory(10);
+      opt.set_constrainedMethod(rai::augmentedLag);
     }
     optCon = make_shared<OptConstrained>(x, dual, P, opt);
 
@@ -170,3 +182,24 @@ void NLP_Solver::reportLangrangeGradients(std::ostream& os, const StringA& featu
   CHECK(optCon, "");
   return optCon->L.reportGradients(os, featureNames);
 }
+
+//===========================================================================
+
+rai::Array<shared_ptr<SolverReturn>> NLP_solveInParallel(const rai::Array<shared_ptr<NLP>>& Ps, NLP_SolverID solverID, const rai::OptOptions& opt, uint numThreads){
+  rai::Array<shared_ptr<SolverReturn>> R(Ps.N);
+  if(!Ps.N) return R;
+  auto solve = [&](uint i){
+    NLP_Solver S;
+    S.setSolver(solverID).setProblem(Ps(i)).setOptions(opt);
+    R(i) = S.solve();
+  };
+
+  //one problem per task (grain 1), as solve times vary a lot; an exception of a solver is rethrown here
+  if(!numThreads) {
+    parallel_for(0, Ps.N, solve, 1);
+  } else {
+    ThreadPool pool(std::min(numThreads, Ps.N)-1);
+    parallel_for(0, Ps.N, solve, 1, pool);
+  }
+  return R;
+}
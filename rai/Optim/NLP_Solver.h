@@ -58,3 +58,8 @@ struct NLP_Solver : NonCopyable {
     gnuplot("plot 'z.opt.trace' us 0:1 t 'sos', '' us 0:2 t 'ineq', '' us 0:3 t 'eq'");
   }
 };
+
+//===========================================================================
+
+/// solve several independent problems concurrently, each with its own NLP_Solver (numThreads=0: on the global ThreadPool); rethrows the first exception of a solver
+rai::Array<shared_ptr<SolverReturn>> NLP_solveInParallel(const rai::Array<shared_ptr<NLP>>& Ps, NLP_SolverID solverID=NLPS_augmentedLag, const rai::OptOptions& opt=rai::OptOptions(), uint numThreads=0);
@@ -124,54 +124,88 @@ double DefaultKernelFunction::k(const arr& x1, const arr& x2, arr& gx1, arr& Hx1
   if(!!Hx1) Hx1 = (-2.*a/hyperParam1.scalar())*((x1-x2)^(x1-x2)) + a*eye(x1.N);
   return k;
 }
+
+arr DefaultKernelFunction::kernelMatrix(const arr& X1, const arr& X2, arr& J, arr& H) {
+  if(type!=Gauss) return KernelFunction::kernelMatrix(X1, X2, J, H);
+  double w=hyperParam1.scalar(), s=hyperParam2.scalar();
+  uint n=X1.d0, m=X2.d0, d=X1.d1;
+
+  //-- all squared distances with one matrix product, then the exp over contiguous memory
+  arr K = sqrDistances(X1, X2);
+  for(double *k=K.p, *kstop=K.p+K.N; k!=kstop; k++) *k = s*::exp(-*k/w);
+
+  if(!!J || !!H) {
+    if(!!J) J.resize(n, m, d);
+    if(!!H) H.resize(uintA{n, m, d, d});
+    for(uint i=0; i<n; i++) for(uint j=0; j<m; j++) {
+        const double *x1=X1.p+i*d, *x2=X2.p+j*d;
+        double a = -2.*K.p[i*m+j]/w;
+        if(!!J) { double *Jij=J.p+(i*m+j)*d; for(uint c=0; c<d; c++) Jij[c] = a*(x1[c]-x2[c]); }
+        if(!!H) {
+          double *Hij=H.p+(i*m+j)*d*d, b=-2.*a/w;
+          for(uint c=0; c<d; c++) for(uint e=0; e<d; e++) Hij[c*d+e] = b*(x1[c]-x2[c])*(x1[e]-x2[e]);
+          for(uint c=0; c<d; c++) Hij[c*d+c] += a;
+        }
+      }
+  }
+  return K;
+}
+
 DefaultKernelFunction defaultKernelFunction;
 
 //===========================================================================
 
-KernelRidgeRegression::KernelRidgeRegression(const arr& X, const arr& y, KernelFunction& kernel, double lambda, double mu)
-  :X(X), mu(mu), kernel(kernel) {
+KernelRidgeRegression::KernelRidgeRegression(const arr& _X, const arr& _y, KernelFunction& kernel, double _lambda, double mu)
+  : lambda(_lambda), sigmaSqr(0.), mu(mu), kernel(kernel) {
   if(lambda<0.) lambda = rai::getParameter<double>("lambda", 1e-10);
-  uint n=X.d0;
+  CHECK_EQ(_X.d0, _y.N, "");
 
-  //-- compute kernel matrix
-  arr kernelMatrix(n, n);
-  for(uint i=0; i<n; i++) for(uint j=0; j<i; j++) {
-      kernelMatrix(i, j) = kernelMatrix(j, i) = kernel.k(X[i], X[j]);
-    }
-  for(uint i=0; i<n; i++) kernelMatrix(i, i) = kernel.k(X[i], X[i]);
+  //-- build the Cholesky factor of the kernel matrix row by row
+  X.resize(0, _X.d1);
+  for(uint i=0; i<_X.d0; i++) append(_X[i], _y(i));
+}
 
-  kernelMatrix_lambda=kernelMatrix;
-  for(uint i=0; i<n; i++) kernelMatrix_lambda(i, i) += lambda;
+void KernelRidgeRegression::append(const arr& x, double _y) {
+  uint n=X.d0;
+  CHECK(!n || x.N==X.d1, "");
+  arr kappa = kernel.kernelMatrix(~x, X).reshape(n);
+  cholesky_appendPacked(cholK, kappa, kernel.k(x, x)+lambda);
+  X.append(x);  X.reshape(n+1, x.N);
+  y.append(_y);
 
-  //-- compute alpha
-  alpha = lapack_Ainv_b_sym(kernelMatrix_lambda, y-mu);
+  //-- alpha = L^-T L^-1 (y-mu), two triangular solves
+  alpha = cholesky_solvePacked(cholK, cholesky_solvePacked(cholK, y-mu), true);
 
-  sigmaSqr = sumOfSqr(kernelMatrix*alpha-y)/double(y.N/*-beta.N*/); //beta.N are the degrees of freedom that we substract (=1 for const model)
+  //training residuals: mu + K alpha - y = -lambda alpha
+  sigmaSqr = rai::sqr(lambda)*sumOfSqr(alpha)/double(y.N);
 }
 
 arr KernelRidgeRegression::evaluate(const arr& Z, arr& bayesSigma2) {
-  arr kappa(Z.d0, X.d0);
-  for(uint i=0; i<Z.d0; i++) for(uint j=0; j<X.d0; j++) kappa(i, j) = kernel.k(Z[i], X[j]);
   if(!!bayesSigma2) {
-    if(!invKernelMatrix_lambda.N) invKernelMatrix_lambda = inverse_SymPosDef(kernelMatrix_lambda);
     bayesSigma2.resize(Z.d0);
-    for(uint i=0; i<Z.d0; i++) {
-      bayesSigma2(i) = kernel.k(Z[i], Z[i]);
-      bayesSigma2(i) -= scalarProduct(kappa[i], invKernelMatrix_lambda*kappa[i]);
-    }
+    for(uint i=0; i<Z.d0; i++) bayesSigma2(i) = kernel.k(Z[i], Z[i]);
+  }
+  if(!X.d0) return consts(mu, Z.d0);
+
+  arr kappa = kernel.kernelMatrix(Z, X);
+  if(!!bayesSigma2) {
+    arr V = cholesky_solvePacked(cholK, ~kappa); //L^-1 kappa^T, all queries at once
+    for(uint j=0; j<X.d0; j++) for(uint i=0; i<Z.d0; i++) bayesSigma2.p[i] -= rai::sqr(V.p[j*Z.d0+i]);
   }
   return mu + kappa * alpha;
 }
 
 double KernelRidgeRegression::evaluate(const arr& x, arr& g, arr& H, double plusSigma, bool onlySigma) {
-  arr kappa(X.d0);
-  arr Jkappa(X.d0, x.N);
-  arr Hkappa(X.d0, x.N, x.N);
-  for(uint i=0; i<X.d0; i++) kappa(i) = kernel.k(x, X[i], Jkappa[i].noconst(), Hkappa[i].noconst());
+  uint n=X.d0, d=x.N;
+  arr Jkappa, Hkappa;
+  arr kappa = kernel.kernelMatrix(~x, X, (!!g || !!H ? Jkappa : NoArr), (!!H ? Hkappa : NoArr));
+  kappa.reshape(n);
+  if(Jkappa.N) Jkappa.reshape(n, d);
+  if(Hkappa.N) Hkappa.reshape(n, d, d);
 
   double fx = 0.;
-  if(!!g) g = zeros(x.N);
-  if(!!H) H = zeros(x.N, x.N);
+  if(!!g) g = zeros(d);
+  if(!!H) H = zeros(d, d);
 
   if(!onlySigma) {
     fx += mu + scalarProduct(alpha, kappa);
@@ -180,19 +214,18 @@ double KernelRidgeRegression::evaluate(const arr& x, arr& g, arr& H, double plus
   }
 
   if(plusSigma) {
-//    arr gx, Hx;
-//    fx += plusSigma * ;
-////    if(!!g) g += plusSigma*(gx + g2);
-////    if(!!H) H += plusSigma*(gx + g2);
-
-    if(!invKernelMatrix_lambda.N) invKernelMatrix_lambda = inverse_SymPosDef(kernelMatrix_lambda);
-
-    arr Kinv_k = invKernelMatrix_lambda*kappa;
-    arr J_Kinv_k = ~Jkappa*Kinv_k;
-    double k_Kinv_k = kernel.k(x, x) - scalarProduct(kappa, Kinv_k);
+    arr v = cholesky_solvePacked(cholK, kappa); //L^-1 kappa
+    double k_Kinv_k = kernel.k(x, x) - sumOfSqr(v);
     fx += plusSigma * ::sqrt(k_Kinv_k);
-    if(!!g) g -= (plusSigma/sqrt(k_Kinv_k)) * J_Kinv_k;
-    if(!!H) H -= (plusSigma/(k_Kinv_k*sqrt(k_Kinv_k))) * (J_Kinv_k^J_Kinv_k) + (plusSigma/sqrt(k_Kinv_k)) * (~Jkappa*invKernelMatrix_lambda*Jkappa + ~Kinv_k*Hkappa);
+    if(!!g || !!H) {
+      arr Kinv_k = cholesky_solvePacked(cholK, v, true);
+      arr J_Kinv_k = ~Jkappa*Kinv_k;
+      if(!!g) g -= (plusSigma/sqrt(k_Kinv_k)) * J_Kinv_k;
+      if(!!H) {
+        arr W = cholesky_solvePacked(cholK, Jkappa); //J^T K^-1 J = W^T W
+        H -= (plusSigma/(k_Kinv_k*sqrt(k_Kinv_k))) * (J_Kinv_k^J_Kinv_k) + (plusSigma/sqrt(k_Kinv_k)) * (~W*W + ~Kinv_k*Hkappa);
+      }
+    }
   }
 
   return fx;
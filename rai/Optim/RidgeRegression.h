@@ -40,18 +40,21 @@ struct DefaultKernelFunction : KernelFunction {
   arr hyperParam1, hyperParam2;
   DefaultKernelFunction(KernelType _type=readFromCfg):type(_type) {}
   virtual double k(const arr& x1, const arr& x2, arr& gx1, arr& Hx1);
+  virtual arr kernelMatrix(const arr& X1, const arr& X2, arr& J=NoArr, arr& H=NoArr);
 };
 extern DefaultKernelFunction defaultKernelFunction;
 
 struct KernelRidgeRegression {
   arr X; ///< stored data (to compute kappa for queries)
-  arr kernelMatrix_lambda; ///< X X^T + lambda I
-  arr invKernelMatrix_lambda; ///< (X X^T + lambda I)^-1
-  arr alpha; ///< (X X^T + lambda I)^-1 y
+  arr y; ///< stored targets
+  arr cholK; ///< Cholesky factor L of K + lambda I (packed, see cholesky_appendPacked) -- no explicit inverse is formed
+  arr alpha; ///< (K + lambda I)^-1 (y-mu)
+  double lambda;
   double sigmaSqr; ///< mean squared error on training data; estimate of noise
-  double mu; ///< fixed global bias (default=0)
+  double mu; ///< fixed global bias (default=0); a change takes effect with the next append
   KernelFunction& kernel;
   KernelRidgeRegression(const arr& X, const arr& y, KernelFunction& kernel=defaultKernelFunction, double lambda=-1, double mu=0.);
+  void append(const arr& x, double y); ///< adds a datum in O(n^2): grows the Cholesky factor by one row and recomputes alpha
   arr evaluate(const arr& X, arr& bayesSigma2=NoArr); ///< returns f(x) and \s^2(x) for a set of points X
 
   double evaluate(const arr& x, arr& df_x, arr& H, double plusSigma, bool onlySigma); ///< returns f(x) + coeff*\sigma(x) and its gradient and Hessian
@@ -202,7 +202,8 @@ bool OptConstrained::ministep(){
 
   //upate Lagrange parameters
   double L_x_before = newton.fx;
-  L.autoUpdate(opt, &newton.fx, newton.gx, newton.Hx);
+  L.autoUpdate(opt, &newton.fx, newton.gx, (newton.lbfgs.m ? NoArr : newton.Hx));
+  if(newton.lbfgs.m) newton.lbfgs.clear(newton.lbfgs.m); //(the curvature pairs were of the previous lambda and mu)
   clip(L.lambda, -10., 10.);
   if(!!dual) dual=L.lambda;
   if(logFile) {
@@ -7,6 +7,7 @@
     --------------------------------------------------------------  */
 
 #include "newton.h"
+#include "../Core/profiler.h"
 
 #include <iomanip>
 
@@ -28,10 +29,76 @@ int optNewton(arr& x, const ScalarFunction& f, rai::OptOptions o) {
 
 //===========================================================================
 
+void LBFGS::clear(uint _m) {
+  m=_m;
+  S.clear(); Y.clear(); rho.clear();
+  k=n=0;
+}
+
+bool LBFGS::add(const arr& s, const arr& y) {
+  CHECK(m, "");
+  double sy = scalarProduct(s, y);
+  if(!(sy>1e-10*sumOfSqr(y))) return false;
+  if(!S.N) { S.resize(m, s.N); Y.resize(m, s.N); rho.resize(m); }
+  CHECK_EQ(S.d1, s.N, "dimension changed");
+  uint i = k%m;
+  S[i] = s;
+  Y[i] = y;
+  rho(i) = 1./sy;
+  k++;
+  if(n<m) n++;
+  return true;
+}
+
+arr LBFGS::getDirection(const arr& g, const boolA& fixed) const {
+  uint N=g.N;
+  bool hasFixed = fixed.N;
+  arr q = g;
+  if(hasFixed) for(uint j=0; j<N; j++) if(fixed.p[j]) q.p[j]=0.;
+  auto dot = [&](const double* a, const double* b) {
+    double d=0.;
+    for(uint j=0; j<N; j++) if(!hasFixed || !fixed.p[j]) d += a[j]*b[j];
+    return d;
+  };
+
+  //-- first loop: newest to oldest pair
+  arr a(n);
+  for(uint l=0; l<n; l++) {
+    uint i = (k-1-l)%m;
+    const double* s=S.p+i*N, *y=Y.p+i*N;
+    a(l) = rho(i) * dot(s, q.p);
+    for(uint j=0; j<N; j++) if(!hasFixed || !fixed.p[j]) q.p[j] -= a(l)*y[j];
+  }
+
+  //-- initial inverse Hessian gamma*I: scaled by the newest pair, or a unit-bounded gradient step without pairs
+  double gamma;
+  if(n) {
+    uint i = (k-1)%m;
+    gamma = 1./(rho(i)*sumOfSqr(Y[i]));
+  } else {
+    gamma = 1./rai::MAX(1., absMax(q));
+  }
+  q *= gamma;
+
+  //-- second loop: oldest to newest pair
+  for(uint l=n; l--;) {
+    uint i = (k-1-l)%m;
+    const double* s=S.p+i*N, *y=Y.p+i*N;
+    double b = rho(i) * dot(y, q.p);
+    for(uint j=0; j<N; j++) if(!hasFixed || !fixed.p[j]) q.p[j] += (a(l)-b)*s[j];
+  }
+
+  q *= -1.;
+  return q;
+}
+
+//===========================================================================
+
 OptNewton::OptNewton(arr& _x, const ScalarFunction& _f, rai::OptOptions _o, ostream* _logFile):
   x(_x), f(_f), options(_o), logFile(_logFile) {
   alpha = options.initStep;
   beta = options.damping;
+  if(options.lbfgsMemory>0) lbfgs.clear(options.lbfgsMemory);
 //  if(f) reinit(_x);
 }
 
@@ -40,8 +107,9 @@ void OptNewton::reinit(const arr& _x) {
 
 //  boundClip(x, bounds_lo, bounds_up);
   boundCheck(x, bounds_lo, bounds_up);
+  if(lbfgs.m) lbfgs.clear(lbfgs.m); //(f may have changed, e.g. the augmented Lagrangian's lambda and mu: the pairs are stale)
   timeEval -= rai::cpuTime();
-  fx = f(gx, Hx, x);  evals++;
+  fx = f(gx, (lbfgs.m ? NoArr : Hx), x);  evals++;
   timeEval += rai::cpuTime();
 
   //startup verbose
@@ -61,18 +129,27 @@ void OptNewton::reinit(const arr& _x) {
 
 //===========================================================================
 
-OptNewton::StopCriterion OptNewton::step() {
-  if(!evals) reinit(x);
-
-  double fy;
-  arr y, gy, Hy, Delta;
-
-  its++;
-  if(options.verbose>1) cout <<"--newton-- it:" <<std::setw(4) <<its <<std::flush;
-
-  if(!(fx==fx)) HALT("you're calling a newton step with initial function value = NAN");
+arr OptNewton::getLbfgsDirection() {
+  //-- variables at a bound with the gradient pointing outwards are fixed
+  boolA fixed;
+  if(bounds_lo.N && bounds_up.N) {
+    fixed.resize(x.N) = false;
+    for(uint i=0; i<x.N; i++) if(bounds_up(i)>bounds_lo(i)) {
+      if(x(i)>=bounds_up(i)-1e-10 && gx(i)<0.) fixed(i)=true;
+      if(x(i)<=bounds_lo(i)+1e-10 && gx(i)>0.) fixed(i)=true;
+    }
+  }
+  arr Delta = lbfgs.getDirection(gx, fixed);
+  if(scalarProduct(Delta, gx)>0.) { //(only with inconsistent pairs) restart the memory
+    if(options.verbose>0) cout <<"** L-BFGS direction is not descending ... clearing memory" <<endl;
+    lbfgs.clear(lbfgs.m);
+    Delta = lbfgs.getDirection(gx, fixed);
+  }
+  return Delta;
+}
 
-  timeNewton -= rai::cpuTime();
+arr OptNewton::getNewtonDirection() {
+  arr Delta;
 
   //-- check active bounds, and decorrelate Hessian
   arr R=Hx;
@@ -129,14 +206,22 @@ OptNewton::StopCriterion OptNewton::step() {
   }
   {
     bool inversionFailed=false;
-    try {
-      if(!rootFinding) {
-        Delta = lapack_Ainv_b_sym(R, -gx);
-      } else {
-        lapack_mldivide(Delta, R, -gx);
+    if(!rootFinding && !isSpecial(R)) {
+      //a single in-place modified Cholesky of the (copied, damped) Hessian: indefiniteness is handled by a diagonal shift
+      arr d;
+      double shift = choleskyModified(R, d);
+      if(shift && options.verbose>1) cout <<"  (hessian shift:" <<shift <<')';
+      Delta = choleskyModified_solve(R, d, -gx);
+    } else {
+      try {
+        if(!rootFinding) {
+          Delta = lapack_Ainv_b_sym(R, -gx);
+        } else {
+          lapack_mldivide(Delta, R, -gx);
+        }
+      } catch(...) {
+        inversionFailed=true;
       }
-    } catch(...) {
-      inversionFailed=true;
     }
     if(!inversionFailed && scalarProduct(Delta,gx)>0.){
       inversionFailed = true;
@@ -159,6 +244,29 @@ OptNewton::StopCriterion OptNewton::step() {
       Delta = gx * (-options.maxStep/length(gx));
     }
   }
+  return Delta;
+}
+
+OptNewton::StopCriterion OptNewton::step() {
+  RAI_PROFILE("OptNewton::step");
+  if(!evals) reinit(x);
+
+  double fy;
+  arr y, gy, Hy, Delta;
+
+  its++;
+  if(options.verbose>1) cout <<"--newton-- it:" <<std::setw(4) <<its <<std::flush;
+
+  if(!(fx==fx)) HALT("you're calling a newton step with initial function value = NAN");
+
+  timeNewton -= rai::cpuTime();
+
+  if(lbfgs.m) {
+    Delta = getLbfgsDirection();
+    alpha = 1.; //quasi-Newton steps are scaled: always try the full step first
+  } else {
+    Delta = getNewtonDirection();
+  }
 
   //restrict stepsize
   double maxDelta = absMax(Delta);
@@ -189,7 +297,7 @@ OptNewton::StopCriterion OptNewton::step() {
     if(options.verbose>5) cout <<"  y:" <<y;
     boundClip(y, bounds_lo, bounds_up);
     timeEval -= rai::cpuTime();
-    fy = f(gy, Hy, y);  evals++;
+    fy = f(gy, (lbfgs.m ? NoArr : Hy), y);  evals++;
     timeEval += rai::cpuTime();
     if(options.verbose>1) cout <<"  evals:" <<std::setw(4) <<evals <<"  f(y):" <<std::setw(11) <<fy <<std::flush;
     if(simpleLog) {
@@ -208,6 +316,7 @@ OptNewton::StopCriterion OptNewton::step() {
       }
       if(options.stopFTolerance<0. && fx-fy<options.stopFTolerance) numTinyFSteps++; else numTinyFSteps=0;
       if(absMax(y-x)<1e-1*options.stopTolerance) numTinyXSteps++; else numTinyXSteps=0;
+      if(lbfgs.m) lbfgs.add(y-x, gy-gx);
       x = y;
       fx = fy;
       gx = gy;
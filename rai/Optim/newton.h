@@ -13,6 +13,18 @@
 
 int optNewton(arr& x, const ScalarFunction& f, rai::OptOptions opt=NOOPT);
 
+/// limited-memory BFGS approximation of the inverse Hessian from the most recent step/gradient-change pairs
+struct LBFGS {
+  uint m=0;         ///< memory size
+  arr S, Y, rho;    ///< (m,n) ring buffers of steps s and gradient changes y, and 1/(s^T y)
+  uint k=0, n=0;    ///< total number of pairs added, number of stored pairs
+
+  void clear(uint _m=0);
+  bool add(const arr& s, const arr& y); ///< false (pair skipped) if the curvature condition s^T y>0 fails
+  /// two-loop recursion: -H^{-1} g restricted to the variables not fixed (fixed variables get zero step)
+  arr getDirection(const arr& g, const boolA& fixed={}) const;
+};
+
 struct OptNewton {
   arr& x;
   ScalarFunction f;
@@ -38,4 +50,9 @@ public:
   bool rootFinding=false;
   ostream* logFile=nullptr, *simpleLog=nullptr;
   double timeNewton=0., timeEval=0.;
+  LBFGS lbfgs; ///< only used if options.lbfgsMemory>0: then f's Hessian is never queried
+
+private:
+  arr getLbfgsDirection();
+  arr getNewtonDirection();
 };
@@ -32,6 +32,7 @@ struct OptOptions {
   RAI_PARAM("opt/", double, stepDec, .5)
   RAI_PARAM("opt/", double, wolfe, .01)
   RAI_PARAM("opt/", bool,   boundedNewton, true)
+  RAI_PARAM("opt/", int,    lbfgsMemory, 0) //>0: OptNewton uses an L-BFGS approximation with this many pairs instead of the Hessian
   RAI_PARAM("opt/", double, muInit, 1.)
   RAI_PARAM("opt/", double, muInc, 5.)
   RAI_PARAM("opt/", double, muMax, 1e4)
@@ -32,6 +32,86 @@ void pack_kindepth2rgb(const uint16A& depth, byteA& buffer) {
   }
   buffer.reshape(depth.d0, depth.d1, 3);
 }
+
+/* codes (per row, predicting each pixel from its left neighbor, the first from 0):
+   0x00 n     : n+1 pixels equal to the prediction
+   0xff lo hi : an absolute value
+   b          : the prediction plus b-128 (b in 1..254) */
+void pack_depth16(const uint16A& depth, byteA& buffer) {
+  uint H=(depth.nd==2 ? depth.d0 : 1), W=(depth.nd==2 ? depth.d1 : depth.N);
+  buffer.resize(3*depth.N+H); //(worst case)
+  byte* b=buffer.p;
+  for(uint i=0; i<H; i++) {
+    const uint16_t* d=depth.p+i*W;
+    int last=0;
+    for(uint j=0; j<W;) {
+      int delta = int(d[j])-last;
+      if(!delta) {
+        uint n=1;
+        while(j+n<W && d[j+n]==d[j] && n<256) n++;
+        *(b++)=0x00;  *(b++)=n-1;
+        j+=n;
+        continue;
+      }
+      if(delta>=-127 && delta<=126) {
+        *(b++)=delta+128;
+      } else {
+        *(b++)=0xff;  *(b++)=d[j]&0xff;  *(b++)=d[j]>>8;
+      }
+      last=d[j];
+      j++;
+    }
+  }
+  buffer.resizeCopy(b-buffer.p);
+}
+
+void unpack_depth16(uint16A& depth, const byte* buffer, uint size, uint H, uint W) {
+  depth.resize(H, W);
+  const byte* b=buffer, *bstop=buffer+size;
+  for(uint i=0; i<H; i++) {
+    uint16_t* d=depth.p+i*W;
+    int last=0;
+    for(uint j=0; j<W;) {
+      CHECK(b<bstop, "depth buffer ended early");
+      byte c=*(b++);
+      if(c==0x00) {
+        CHECK(b<bstop, "depth buffer ended early");
+        uint n=uint(*(b++))+1;
+        CHECK_LE(j+n, W, "corrupt depth buffer");
+        for(uint k=0; k<n; k++) d[j++]=last;
+      } else if(c==0xff) {
+        CHECK_LE(b+2, bstop, "depth buffer ended early");
+        last = uint16_t(b[0]) | (uint16_t(b[1])<<8);
+        b+=2;
+        d[j++]=last;
+      } else {
+        last += int(c)-128;
+        d[j++]=last;
+      }
+    }
+  }
+  CHECK_EQ(b, bstop, "depth buffer has trailing bytes");
+}
+
+bool depth2depth16(uint16A& depth16, const floatA& depth, double scale) {
+  if(depth.nd==2) depth16.resize(depth.d0, depth.d1); else depth16.resize(depth.N);
+  float s=1./scale;
+  bool inRange=true;
+  for(uint i=0; i<depth.N; i++) {
+    float d=depth.p[i]*s+.5f;
+    if(d>=1.f && d<65535.5f) depth16.p[i] = uint16_t(d);
+    else {
+      depth16.p[i] = 0;
+      if(depth.p[i]>0.f) inRange=false; //(a valid depth -- not negative or nan -- that is too small or too far)
+    }
+  }
+  return inRange;
+}
+
+void depth162depth(floatA& depth, const uint16A& depth16, double scale) {
+  if(depth16.nd==2) depth.resize(depth16.d0, depth16.d1); else depth.resize(depth16.N);
+  for(uint i=0; i<depth16.N; i++) depth.p[i] = depth16.p[i] ? float(scale*depth16.p[i]) : -1.f;
+}
 }
 
 void KinectDepthPacking::open() {}
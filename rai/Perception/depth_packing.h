@@ -22,4 +22,15 @@ struct KinectDepthPacking : Thread {
 namespace rai {
 // pack 16bit depth image into 3 8-bit channels
 void pack_kindepth2rgb(const uint16A& depth, byteA& buffer);
+
+// lossless compression of a 16bit depth image: horizontal deltas as single bytes, runs of equal pixels, escapes for jumps
+// (smooth depth images take about 1 byte per pixel); unpack needs the image size -- unlike pack_kindepth2rgb, which
+// spreads the depth over 3 bytes for video streams and keeps only 12 bits
+void pack_depth16(const uint16A& depth, byteA& buffer);
+void unpack_depth16(uint16A& depth, const byte* buffer, uint size, uint height, uint width);
+
+// float depth (meters) <-> 16bit depth in units of scale (rounded; with the default 0.1mm up to 6.5535m); invalid
+// (negative or nan) depths become 0, and -1 when unpacking; returns false if a valid depth was out of range (also 0)
+bool depth2depth16(uint16A& depth16, const floatA& depth, double scale=1e-4);
+void depth162depth(floatA& depth, const uint16A& depth16, double scale=1e-4);
 }
@@ -25,7 +25,7 @@ void Kinect2PointCloud::step() {
   depth = kinect_depth.get();
   rgb = kinect_rgb.get();
 
-  depthData2pointCloud(pts, depth, depthShift_dx, depthShift_dy);
+  if(!compact) depthData2pointCloud(pts, depth, depthShift_dx, depthShift_dy);
 //  cout <<depthShift_dx <<' ' <<depthShift_dy <<endl;
 
   frame = kinect_frame.get(); //this is relative to "/base_link"
@@ -45,6 +45,13 @@ void Kinect2PointCloud::step() {
 //  cout <<"ors: frame=" <<k <<" real/k" <<frame/k <<" k/real" <<k/frame <<endl;
 
   if(frameShift.N) frame.addRelativeTranslation(frameShift(0), frameShift(1), frameShift(2));
+
+  if(compact) {
+    depthData2pointCloud(fused, depthMeters, depth, frame, depthShift_dx, depthShift_dy);
+    kinect_cloud.set() = fused.points;
+    return;
+  }
+
   if(!frame.isZero()) frame.applyOnPointArray(pts);
 
   kinect_points.set() = pts;
@@ -83,3 +90,29 @@ void depthData2pointCloud(arr& pts, const uint16A& depth, int depthShift_dx, int
 
   pts.reshape(H, W, 3);
 }
+
+void depthData2pointCloud(DepthToPointCloud& cloud, floatA& depthMeters, const uint16A& depth, const rai::Transformation& frame, int depthShift_dx, int depthShift_dy) {
+  uint H=depth.d0, W=depth.d1;
+  CHECK_EQ(H, 480, "");
+  CHECK_EQ(W, 640, "");
+
+  //-- shifted depth in meters; 0 and 2047 (2^11-1) are invalid
+  depthMeters.resize(H, W);
+  for(uint i=0; i<depth.N; i++) {
+    int j = i+depthShift_dx+depthShift_dy*depth.d1;
+    if(j<0) j=0;
+    if(j>=(int)depth.N) j=depth.N-1;
+    uint16_t d = depth.elem(j);
+    depthMeters.elem(i) = (d!=0 && d!=2047) ? .001f*d : NAN;
+  }
+
+  //-- the pixel convention and focal lengths of the dense version above; the fused pipeline's camera looks along -z
+  //   with y up, which is the kinect frame rotated by 180 degrees about x
+  cloud.fx = rai::getParameter<int>("focal_x", 530);
+  cloud.fy = rai::getParameter<int>("focal_y", 510);
+  cloud.px = int(W>>1)-1;
+  cloud.py = int(H>>1)-1;
+  rai::Transformation X = frame;
+  X.addRelativeRotationDeg(180., 1., 0., 0.);
+  cloud.compute(depthMeters, X);
+}
@@ -11,6 +11,7 @@
 #include "../Core/thread.h"
 #include "../Gui/opengl.h"
 #include "../Geo/geo.h"
+#include "../Geo/depth2PointCloud.h"
 
 struct Kinect2PointCloud : Thread {
   //inputs
@@ -20,6 +21,7 @@ struct Kinect2PointCloud : Thread {
   Var<arr> pr2_odom;
   //outputs
   Var<arr> kinect_points;
+  Var<floatA> kinect_cloud;   ///< only if compact: the compacted world-frame points of the fused pipeline
 
   arr pts, cols;
   uint16A depth;
@@ -27,6 +29,9 @@ struct Kinect2PointCloud : Thread {
   rai::Transformation frame;
   int depthShift_dx, depthShift_dy;
   arr frameShift;
+  bool compact=false;         ///< use the fused pipeline (configured in fused) and write kinect_cloud instead of kinect_points
+  DepthToPointCloud fused;
+  floatA depthMeters;
 
   Kinect2PointCloud();
   virtual ~Kinect2PointCloud();
@@ -38,3 +43,5 @@ struct Kinect2PointCloud : Thread {
 
 /// convert raw depth data to a pointcloud (no color)
 void depthData2pointCloud(arr& pts, const uint16A& depth, int depthShift_dx=0, int depthShift_dy=0);
+/// the same via the fused pipeline: only the valid points, transformed by frame (the kinect frame: looking along +z, y down)
+void depthData2pointCloud(DepthToPointCloud& cloud, floatA& depthMeters, const uint16A& depth, const rai::Transformation& frame, int depthShift_dx=0, int depthShift_dy=0);
@@ -146,6 +146,7 @@ void MinEigModel::computeConvexHull2() {
   for(uint i=0; i<hull.d0; i++) {
     convexHull.V[i] = mean + b0*hull(i, 0) + b1*hull(i, 1);
   }
+  convexHull.changed();
 }
 
 double MinEigModel::coveredData(bool novelDataOnly) {
@@ -0,0 +1,235 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#include "simulationLog.h"
+#include "depth_packing.h"
+#include "../Kin/simulation.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+
+namespace rai {
+
+static const char logHeader[16] = "RAI_SIMLOG_v1\0";
+static const char logIndexMagic[8] = {'R', 'L', 'I', 'D', 'X', 0, 0, 0};
+
+static uint64_t pad8(uint64_t n) { return (n+7)&~uint64_t(7); }
+
+/// whether a chunk at offset off is complete within a file of the given size, with sections that fit into the chunk
+static bool chunkIsValid(const byte* data, uint64_t size, uint64_t off) {
+  if(off<16 || off%8 || off>size || size-off<sizeof(SimulationLogChunk)) return false;
+  const SimulationLogChunk* c = (const SimulationLogChunk*)(data+off);
+  if(memcmp(c->magic, "RLCK", 4) || c->size>size-off) return false;
+  if(c->depthCodec!=SimulationLogWriter::depthFloat && c->depthCodec!=SimulationLogWriter::depth16) return false;
+  //(arrays have 32 bit sizes; with these bounds, the 64 bit section sizes below can't overflow)
+  uint64_t rgbPixels = uint64_t(c->rgbH)*c->rgbW, depthPixels = uint64_t(c->depthH)*c->depthW;
+  if(7*uint64_t(c->framesN)>UINT32_MAX || rgbPixels>UINT32_MAX/3 || depthPixels>UINT32_MAX || c->depthBytes>UINT32_MAX) return false;
+  if(c->depthCodec==SimulationLogWriter::depthFloat && c->depthBytes!=depthPixels*sizeof(float)) return false;
+  uint64_t sections = pad8(sizeof(SimulationLogChunk)) + pad8(c->qN*sizeof(double)) + pad8(7*uint64_t(c->framesN)*sizeof(double))
+                      + pad8(3*rgbPixels) + pad8(c->depthBytes);
+  return sections==c->size;
+}
+
+//===========================================================================
+
+SimulationLogWriter::SimulationLogWriter(const char* filename, DepthCodec depthCodec, double depthScale, uint maxQueue)
+  : fil(filename, std::ios::binary), depthCodec(depthCodec), depthScale(depthScale), maxQueue(maxQueue) {
+  CHECK(fil.good(), "could not open '" <<filename <<"'");
+  fil.write(logHeader, 16);
+  offset = 16;
+  worker = std::thread(&SimulationLogWriter::run, this);
+}
+
+SimulationLogWriter::~SimulationLogWriter() {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    stop=true;
+  }
+  changed.notify_all();
+  worker.join();
+
+  //-- index: (time, offset) pairs, then their number and a magic, so that the reader finds it from the end
+  for(auto& i:index) {
+    fil.write((char*)&i.first, sizeof(double));
+    fil.write((char*)&i.second, sizeof(uint64_t));
+  }
+  uint64_t n=index.size();
+  fil.write((char*)&n, sizeof(uint64_t));
+  fil.write(logIndexMagic, 8);
+}
+
+void SimulationLogWriter::append(double time, const arr& q, const arr& frameState, const byteA& rgb, const floatA& depth) {
+  CHECK(!frameState.N || (frameState.nd==2 && frameState.d1==7), "frame state needs to be (n,7)");
+  CHECK(!rgb.N || (rgb.nd==3 && rgb.d2==3), "rgb needs to be (h,w,3)");
+  CHECK(!depth.N || depth.nd==2, "depth needs to be (h,w)");
+  Record r = {time, q, frameState, rgb, depth}; //(the only work in the caller's thread: copies)
+  std::unique_lock<std::mutex> lock(mutex);
+  changed.wait(lock, [this]() { return queue.size()<maxQueue; });
+  queue.push_back(std::move(r));
+  lock.unlock();
+  changed.notify_all();
+}
+
+void SimulationLogWriter::append(Simulation& S) {
+  byteA rgb;
+  floatA depth;
+  S.getImageAndDepth(rgb, depth);
+  append(S.time, S.get_q(), S.C.getFrameState(), rgb, depth);
+}
+
+void SimulationLogWriter::flush() {
+  std::unique_lock<std::mutex> lock(mutex);
+  changed.wait(lock, [this]() { return queue.empty() && !busy; });
+  fil.flush();
+}
+
+void SimulationLogWriter::run() {
+  for(;;) {
+    Record r;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait(lock, [this]() { return stop || !queue.empty(); });
+      if(queue.empty()) return; //(stop, and all written)
+      r = std::move(queue.front());
+      queue.pop_front();
+      busy=true;
+    }
+    changed.notify_all();
+    write(r);
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      busy=false;
+    }
+    changed.notify_all();
+  }
+}
+
+void SimulationLogWriter::write(Record& r) {
+  SimulationLogChunk c;
+  memset(&c, 0, sizeof(c));
+  memcpy(c.magic, "RLCK", 4);
+  c.time = r.time;
+  c.qN = r.q.N;
+  c.framesN = r.X.d0;
+  if(r.rgb.N) { c.rgbH = r.rgb.d0;  c.rgbW = r.rgb.d1; }
+  if(r.depth.N) { c.depthH = r.depth.d0;  c.depthW = r.depth.d1; }
+  c.depthScale = depthScale;
+
+  byteA packed;
+  const byte* depthData = (const byte*)r.depth.p;
+  c.depthCodec = depthFloat;
+  c.depthBytes = r.depth.N*sizeof(float);
+  uint16A d16;
+  if(depthCodec==depth16 && r.depth.N && depth2depth16(d16, r.depth, depthScale)) { //(otherwise this record keeps float depth)
+    pack_depth16(d16, packed);
+    depthData = packed.p;
+    c.depthCodec = depth16;
+    c.depthBytes = packed.N;
+  }
+
+  c.size = pad8(sizeof(c)) + pad8(r.q.N*sizeof(double)) + pad8(r.X.N*sizeof(double)) + pad8(r.rgb.N) + pad8(c.depthBytes);
+  index.push_back({r.time, offset});
+  offset += c.size;
+
+  static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  auto section = [this](const void* p, uint64_t n) {
+    if(n) fil.write((const char*)p, n);
+    if(pad8(n)!=n) fil.write(zeros, pad8(n)-n);
+  };
+  section(&c, sizeof(c));
+  section(r.q.p, r.q.N*sizeof(double));
+  section(r.X.p, r.X.N*sizeof(double));
+  section(r.rgb.p, r.rgb.N);
+  section(depthData, c.depthBytes);
+  CHECK(fil.good(), "writing the log failed");
+}
+
+//===========================================================================
+
+SimulationLogReader::SimulationLogReader(const char* filename) {
+  fd = ::open(filename, O_RDONLY);
+  CHECK(fd>=0, "could not open '" <<filename <<"'");
+  struct stat st;
+  fstat(fd, &st);
+  size = st.st_size;
+  CHECK_GE(size, 16, "'" <<filename <<"' is not a simulation log");
+  data = (const byte*)mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  CHECK(data!=MAP_FAILED, "could not map '" <<filename <<"'");
+  CHECK(!memcmp(data, logHeader, 16), "'" <<filename <<"' is not a simulation log");
+
+  //-- the index at the end
+  if(size>=32 && !memcmp(data+size-8, logIndexMagic, 8)) {
+    uint64_t n;
+    memcpy(&n, data+size-16, 8);
+    if(n <= (size-32)/16) { //(n is untrusted: 16*n could overflow)
+      const byte* idx = data+size-16-16*n;
+      chunks.resize(n);
+      for(uint64_t i=0; i<n; i++) {
+        uint64_t off;
+        memcpy(&off, idx+16*i+8, 8);
+        CHECK(chunkIsValid(data, size-16-16*n, off), "'" <<filename <<"': corrupt chunk " <<i <<" at offset " <<off);
+        chunks[i] = (const SimulationLogChunk*)(data+off);
+      }
+      return;
+    }
+  }
+
+  //-- no index (the recording was interrupted): scan the complete chunks
+  LOG(0) <<"'" <<filename <<"' has no index -- scanning the chunks";
+  uint64_t off=16;
+  while(chunkIsValid(data, size, off)) {
+    const SimulationLogChunk* c = (const SimulationLogChunk*)(data+off);
+    chunks.push_back(c);
+    off += c->size;
+  }
+}
+
+SimulationLogReader::~SimulationLogReader() {
+  if(data) munmap((void*)data, size);
+  if(fd>=0) ::close(fd);
+}
+
+uint SimulationLogReader::seek(double t) const {
+  auto it = std::upper_bound(chunks.begin(), chunks.end(), t, [](double t, const SimulationLogChunk* c) { return t < c->time; });
+  if(it==chunks.begin()) return 0;
+  return (it-chunks.begin())-1;
+}
+
+double SimulationLogReader::getState(uint i, arr& q, arr& frameState) {
+  CHECK_LE(i+1, chunks.size(), "");
+  const SimulationLogChunk* c = chunks[i];
+  const byte* p = (const byte*)c + pad8(sizeof(SimulationLogChunk));
+  if(!!q) q.referTo((const double*)p, c->qN);
+  p += pad8(c->qN*sizeof(double));
+  if(!!frameState) {
+    frameState.referTo((const double*)p, 7*c->framesN);
+    frameState.reshape(c->framesN, 7);
+  }
+  return c->time;
+}
+
+void SimulationLogReader::getImages(uint i, byteA& rgb, floatA& depth) {
+  CHECK_LE(i+1, chunks.size(), "");
+  const SimulationLogChunk* c = chunks[i];
+  const byte* p = (const byte*)c + pad8(sizeof(SimulationLogChunk)) + pad8(c->qN*sizeof(double)) + pad8(7*c->framesN*sizeof(double));
+  rgb.referTo(p, 3*c->rgbH*c->rgbW);
+  rgb.reshape(c->rgbH, c->rgbW, 3);
+  p += pad8(3*c->rgbH*c->rgbW);
+  if(c->depthCodec==SimulationLogWriter::depthFloat) {
+    depth.referTo((const float*)p, c->depthH*c->depthW);
+    depth.reshape(c->depthH, c->depthW);
+  } else {
+    unpack_depth16(depth16, p, c->depthBytes, c->depthH, c->depthW);
+    depth162depth(depth, depth16, c->depthScale);
+  }
+}
+
+} //namespace
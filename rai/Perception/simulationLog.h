@@ -0,0 +1,98 @@
+/*  ------------------------------------------------------------------
+    Copyright (c) 2011-2020 Marc Toussaint
+    email: toussaint@tu-berlin.de
+
+    This code is distributed under the MIT License.
+    Please see <root-path>/LICENSE for details.
+    --------------------------------------------------------------  */
+
+#pragma once
+
+#include "../Core/array.h"
+
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+namespace rai {
+
+struct Simulation;
+
+//===========================================================================
+//
+// chunked binary log of synchronized simulation states and images
+//
+// file: a 16 byte header, one chunk per record, and a timestamp index at the end. Each chunk starts with a
+// SimulationLogChunk header and holds joint state q, frame poses (n,7), rgb (h,w,3) and depth, each section 8-byte
+// aligned, so that the reader can refer to them directly in the memory mapped file. Depth is stored as raw float (the
+// default), or -- if the writer is created with depth16 -- rounded to multiples of depthScale (0.1mm by default) as 16
+// bit and compressed losslessly with pack_depth16, which is exact only for sensors that deliver depth in these units;
+// invalid depths (<=0 or nan) are then replayed as -1, and records with a depth beyond the 16 bit range (6.5535m by
+// default) are stored as raw float. If the index is missing (e.g., the recording crashed), the reader rebuilds it by
+// scanning the chunks. The reader checks all offsets and section sizes against the file size.
+//
+
+struct SimulationLogChunk {
+  char magic[4];                  ///< "RLCK"
+  uint32_t depthCodec;            ///< SimulationLogWriter::DepthCodec (per chunk: depth16 falls back to depthFloat)
+  double time;
+  uint64_t size;                  ///< bytes of the whole chunk, including this header
+  uint32_t qN, framesN;           ///< #joints, #frames (with 7 pose doubles each)
+  uint32_t rgbH, rgbW, depthH, depthW;
+  uint64_t depthBytes;
+  double depthScale;
+};
+
+/// records in a background thread: append() only copies the data into a queue, compression and disk writes happen
+/// concurrently -- it blocks only if maxQueue records are pending (nothing is dropped)
+struct SimulationLogWriter {
+  enum DepthCodec { depthFloat=0, depth16=1 };
+
+  SimulationLogWriter(const char* filename, DepthCodec depthCodec=depthFloat, double depthScale=1e-4, uint maxQueue=64);
+  ~SimulationLogWriter(); ///< writes the pending records and the index
+
+  void append(double time, const arr& q, const arr& frameState, const byteA& rgb, const floatA& depth);
+  void append(Simulation& S); ///< time, joint state, frame state and the current sensor's image and depth
+  void flush();               ///< waits until all records are written
+
+ private:
+  struct Record { double time; arr q, X; byteA rgb; floatA depth; };
+  std::ofstream fil;
+  DepthCodec depthCodec;
+  double depthScale;
+  uint maxQueue;
+  std::deque<Record> queue;
+  std::mutex mutex;
+  std::condition_variable changed;
+  bool stop=false, busy=false;
+  std::vector<std::pair<double, uint64_t>> index; ///< time and file offset of each chunk
+  uint64_t offset=0;
+  std::thread worker;
+  void write(Record& r);
+  void run();
+};
+
+/// replays a log via a read-only memory mapping: q, frame poses and rgb (and raw float depth) refer directly into the
+/// mapping (read-only, and valid while the reader lives); compressed depth is decoded
+struct SimulationLogReader {
+  SimulationLogReader(const char* filename);
+  ~SimulationLogReader();
+
+  uint N() const { return chunks.size(); }
+  double time(uint i) const { return chunks[i]->time; }
+  uint seek(double time) const; ///< the last record with a time <= time (or 0)
+
+  double getState(uint i, arr& q, arr& frameState); ///< returns the time of record i
+  void getImages(uint i, byteA& rgb, floatA& depth);
+
+ private:
+  const byte* data=nullptr;
+  uint64_t size=0;
+  int fd=-1;
+  std::vector<const SimulationLogChunk*> chunks;
+  uint16A depth16; //buffer
+};
+
+}
@@ -529,7 +529,10 @@ allows you to control robot motors by position, velocity, or accelerations, \
     auto depthSet = self.depth.set();
     if(visualsOnly) self.cam->renderMode = rai::CameraView::visuals;
     else self.cam->renderMode = rai::CameraView::all;
-    self.cam->computeImageAndDepth(imageSet, depthSet);
+    {
+      pybind11::gil_scoped_release release;
+      self.cam->computeImageAndDepth(imageSet, depthSet);
+    }
     pybind11::tuple ret(2);
     ret[0] = Array2numpy<byte>(imageSet);
     ret[1] = Array2numpy<float>(depthSet);
@@ -550,7 +553,10 @@ allows you to control robot motors by position, velocity, or accelerations, \
 
   .def("computeSegmentation", [](ry::RyCameraView& self) {
     auto segSet = self.segmentation.set();
-    self.cam->computeSegmentation(segSet);
+    {
+      pybind11::gil_scoped_release release;
+      self.cam->computeSegmentation(segSet);
+    }
     return Array2numpy<byte>(segSet());
   })
 
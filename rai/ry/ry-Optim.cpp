@@ -171,7 +171,8 @@ void init_Optim(pybind11::module& m) {
       .def("setSolver", &NLP_Solver::setSolver)
 
       .def("setTracing", &NLP_Solver::setTracing)
-      .def("solve", &NLP_Solver::solve, "", pybind11::arg("resampleInitialization")=-1)
+      .def("solve", &NLP_Solver::solve, "(releases the GIL while solving)", pybind11::arg("resampleInitialization")=-1,
+           pybind11::call_guard<pybind11::gil_scoped_release>())
 
       .def("getTrace_x", &NLP_Solver::getTrace_x)
       .def("getTrace_costs", &NLP_Solver::getTrace_costs)
@@ -294,6 +295,24 @@ void init_Optim(pybind11::module& m) {
 
 #undef ENUMVAL
 
+  //===========================================================================
+
+  m.def("solveInParallel", [](const std::vector<shared_ptr<NLP>>& nlps, NLP_SolverID solverID, const rai::OptOptions& opt, uint numThreads) {
+    rai::Array<shared_ptr<NLP>> Ps;
+    for(const shared_ptr<NLP>& P:nlps) Ps.append(P);
+    rai::Array<shared_ptr<SolverReturn>> R;
+    {
+      pybind11::gil_scoped_release release;
+      R = NLP_solveInParallel(Ps, solverID, opt, numThreads);
+    }
+    return Array2vec<shared_ptr<SolverReturn>>(R);
+  },
+  "solve a list of independent NLPs (e.g. [komo.nlp() for komo in komos]) concurrently in C++ with released GIL; returns the list of SolverReturns",
+  pybind11::arg("nlps"),
+  pybind11::arg("solverID") = NLPS_augmentedLag,
+  pybind11::arg("opt") = rai::OptOptions(),
+  pybind11::arg("numThreads") = 0
+      );
 }
 
 #endif
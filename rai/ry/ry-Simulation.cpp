@@ -33,10 +33,38 @@ void init_Simulation(pybind11::module& m) {
   }))
 
   .def("step", &rai::Simulation::step,
-       "",
+       "(releases the GIL while stepping)",
        pybind11::arg("u_control"),
        pybind11::arg("tau") = .01,
-       pybind11::arg("u_mode") = rai::Simulation::_velocity
+       pybind11::arg("u_mode") = rai::Simulation::_velocity,
+       pybind11::call_guard<pybind11::gil_scoped_release>()
+      )
+
+  .def("stepMany", [](std::shared_ptr<rai::Simulation>& self, const arr& u_controls, uint n, double tau, rai::Simulation::ControlMode u_mode) {
+    arr q;
+    {
+      pybind11::gil_scoped_release release;
+      if(u_controls.nd==2){ //one control row per step
+        n = u_controls.d0;
+        for(uint t=0; t<n; t++){
+          self->step(u_controls[t], tau, u_mode);
+          q.append(self->get_q());
+        }
+      }else{ //the same control in every step
+        for(uint t=0; t<n; t++){
+          self->step(u_controls, tau, u_mode);
+          q.append(self->get_q());
+        }
+      }
+      if(n) q.reshape(n, q.N/n);
+    }
+    return q;
+  },
+  "step the simulation n times within C++ (GIL released); u_controls is either a single control (applied n times) or an (n x d) matrix with one control per step (then n is ignored); returns the (n x dim(q)) joint states after each step",
+  pybind11::arg("u_controls"),
+  pybind11::arg("n") = 1,
+  pybind11::arg("tau") = .01,
+  pybind11::arg("u_mode") = rai::Simulation::_velocity
       )
 
   .def("setMoveto", &rai::Simulation::setMoveTo,
@@ -80,7 +108,10 @@ void init_Simulation(pybind11::module& m) {
   .def("getImageAndDepth", [](std::shared_ptr<rai::Simulation>& self) {
     byteA rgb;
     floatA depth;
-    self->getImageAndDepth(rgb, depth);
+    {
+      pybind11::gil_scoped_release release;
+      self->getImageAndDepth(rgb, depth);
+    }
     return pybind11::make_tuple(Array2numpy<byte>(rgb),
                                 Array2numpy<float>(depth));
   })
@@ -25,6 +25,7 @@ void init_CfgFileParameters(){
 
 namespace pybind11{
   bool logCallback(const char* str, int log_level){
+    pybind11::gil_scoped_acquire acquire; //logs may come from solvers/threads that released the GIL
     std::string _str(str);
     pybind11::print("[rai]", str, "flush"_a=true);
     //pybind11::print("flush"_a=true);
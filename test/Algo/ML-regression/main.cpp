@@ -1,6 +1,7 @@
 #include <Algo/MLcourse.h>
 #include <Gui/plot.h>
 #include <Optim/GlobalIterativeNewton.h>
+#include <Algo/gaussianProcess.h>
 
 #include <math.h>
 
@@ -147,6 +148,15 @@ void testKernelGradients() {
     checkHessian(f, x1, 1e-5);
   }
 
+  //-- the vectorized kernel matrix agrees with pairwise evaluation
+  kernel.type = DefaultKernelFunction::Gauss;
+  kernel.hyperParam1 = arr{.5};
+  kernel.hyperParam2 = arr{2.};
+  arr X1 = randn(7, 3), X2 = randn(5, 3), J, H, J2, H2;
+  arr K = kernel.kernelMatrix(X1, X2, J, H);
+  arr K2 = kernel.KernelFunction::kernelMatrix(X1, X2, J2, H2);
+  cout <<"kernel matrix errors: " <<maxDiff(K, K2) <<' ' <<maxDiff(J, J2) <<' ' <<maxDiff(H, H2) <<endl;
+  CHECK_LE(maxDiff(K, K2) + maxDiff(J, J2) + maxDiff(H, H2), 1e-10, "");
 }
 
 //===========================================================================
@@ -226,6 +236,100 @@ void testKernelReg(const char *datafile=nullptr) {
 
 //===========================================================================
 
+void testKernelRegIncremental() {
+  DefaultKernelFunction kernel;
+  kernel.type = DefaultKernelFunction::Gauss;
+  kernel.hyperParam1 = arr{.5};
+  kernel.hyperParam2 = arr{1.};
+  double lambda=1e-2, mu=.3;
+
+  //-- growing the Cholesky factor datum by datum is the same as solving with the full kernel matrix
+  arr X = randn(50, 2), y = randn(50);
+  KernelRidgeRegression f(X.sub(0, 9, 0, -1), y.sub(0, 9), kernel, lambda, mu);
+  for(uint i=10; i<X.d0; i++) f.append(X[i], y(i));
+
+  arr K(X.d0, X.d0);
+  for(uint i=0; i<X.d0; i++) for(uint j=0; j<X.d0; j++) K(i, j) = kernel.k(X[i], X[j], NoArr, NoArr);
+  arr L = K + lambda*eye(X.d0), d;
+  double shift = choleskyModified(L, d);
+  CHECK_ZERO(shift, 1e-10, "kernel matrix is not pos-def");
+  double err = maxDiff(f.alpha, choleskyModified_solve(L, d, y-mu));
+  cout <<"alpha error = " <<err <<endl;
+  CHECK_LE(err, 1e-6, "");
+
+  arr Z = randn(5, 2), s2;
+  arr fZ = f.evaluate(Z, s2);
+  for(uint i=0; i<Z.d0; i++) {
+    arr kappa(X.d0);
+    for(uint j=0; j<X.d0; j++) kappa(j) = kernel.k(Z[i], X[j], NoArr, NoArr);
+    CHECK_LE(fabs(fZ(i) - mu - scalarProduct(kappa, choleskyModified_solve(L, d, y-mu))), 1e-6, "");
+    CHECK_LE(fabs(s2(i) - kernel.k(Z[i], Z[i], NoArr, NoArr) + scalarProduct(kappa, choleskyModified_solve(L, d, kappa))), 1e-6, "");
+  }
+
+  for(uint k=0; k<3; k++) {
+    arr x = randn(2);
+    checkGradient(f.getF(1.), x, 1e-4);
+    checkHessian(f.getF(1.), x, 1e-4);
+  }
+
+  //-- the same for a GaussianProcess, also with a repeated input (whose pivot is jittered instead of failing)
+  GaussKernelParams P(1., .5, .1);
+  GaussianProcess gp;
+  gp.setGaussKernelGP(&P, mu);
+  gp.obsVar = lambda;
+  for(uint i=0; i<20; i++) gp.appendObservation(X[i], y(i));
+  gp.appendObservation(X[3], y(3));
+  arr cholG = gp.cholG, GinvY = gp.GinvY;
+  gp.recompute();
+  CHECK_ZERO(maxDiff(cholG, gp.cholG)+maxDiff(GinvY, gp.GinvY), 1e-10, "appended factor differs from the recomputed one");
+  arr gpY, gpS;
+  gp.evaluate(Z, gpY, gpS);
+  for(uint i=0; i<Z.d0; i++) {
+    double yi, si;
+    gp.evaluate(Z[i], yi, si);
+    CHECK_ZERO(fabs(yi-gpY(i))+fabs(si-gpS(i)), 1e-10, "batch and pointwise evaluation differ");
+  }
+
+  //-- timing: appending the n-th datum costs O(n^2)
+  KernelRidgeRegression g(arr(0u, 2), {}, kernel, lambda, mu);
+  double time=rai::cpuTime();
+  for(uint n=1; n<=1000; n++) {
+    g.append(randn(2), rnd.gauss());
+    if(!(n%250)) cout <<"n=" <<n <<" total append time=" <<rai::cpuTime()-time <<"sec" <<endl;
+  }
+}
+
+//===========================================================================
+
+void testParallelMultiStart() {
+  DefaultKernelFunction kernel;
+  kernel.type = DefaultKernelFunction::Gauss;
+  kernel.hyperParam1 = arr{.2};
+  kernel.hyperParam2 = arr{1.};
+  arr X = 2.*rand(40, 2)-1., y = randn(40);
+  KernelRidgeRegression f(X, y, kernel, 1e-4, 0.);
+
+  //-- descents of a batch run concurrently, but the merged minima don't depend on the batch size or scheduling
+  arr bounds_lo = {-1., -1.}, bounds_hi = {1., 1.};
+  rai::Array<GlobalIterativeNewton::LocalMinimum> minima[2];
+  for(uint k=0; k<2; k++) {
+    rnd.seed(0);
+    GlobalIterativeNewton opt(f.getF(-1.), bounds_lo, bounds_hi, rai::OptOptions().set_stopTolerance(1e-4));
+    opt.parallelBatch = (k ? 7 : 4);
+    opt.run(30);
+    opt.reOptimizeAllPoints();
+    minima[k] = opt.localMinima;
+    cout <<"batch " <<opt.parallelBatch <<": #local minima=" <<opt.localMinima.N <<" best=" <<opt.best->fx <<endl;
+  }
+  CHECK_EQ(minima[0].N, minima[1].N, "");
+  for(uint i=0; i<minima[0].N; i++) {
+    CHECK_EQ(minima[0](i).hits, minima[1](i).hits, "");
+    CHECK_ZERO(minima[0](i).fx - minima[1](i).fx, 1e-12, "");
+  }
+}
+
+//===========================================================================
+
 void test2Class() {
 //  rnd.seed(1);
 
@@ -465,6 +569,8 @@ int main(int argc, char *argv[]) {
     case 6:  testKernelLogReg();  break;
     case 7:  testRobustRegression();  break;
     case 8:  testKernelGradients();  break;
+    case 9:  testKernelRegIncremental();  break;
+    case 10:  testParallelMultiStart();  break;
     break;
   }
   
@@ -97,10 +97,50 @@ void TEST(Path){
 
 }
 
+void TEST(AllocationFree){
+  arr X = randn(20, 3);
+  arr T = integral(rand(20)+0.1);
+
+  rai::Spline S;
+  S.set(2, X, T);
+  rai::CubicSpline C;
+  C.set(X, randn(20, 3), T);
+
+  rai::PiecewisePolynomial PS, PC;
+  PS.set(S);
+  PC.set(C);
+
+  //-- same values as the splines themselves
+  arr x, xDot, xDDot, y, yDot, yDDot;
+  for(double t=S.begin()-.1; t<S.end()+.1; t+=1e-2){
+    S.eval(x, xDot, xDDot, t);
+    PS.eval(y, yDot, yDDot, t);
+    CHECK_ZERO(maxDiff(x, y) + maxDiff(xDot, yDot) + maxDiff(xDDot, yDDot), 1e-6, "t=" <<t);
+  }
+  for(double t=C.begin(); t<C.end(); t+=1e-2){
+    C.eval(x, xDot, xDDot, t);
+    PC.eval(y, yDot, yDDot, t);
+    CHECK_ZERO(maxDiff(x, y) + maxDiff(xDot, yDot) + maxDiff(xDDot, yDDot), 1e-6, "t=" <<t);
+  }
+
+  //-- no allocations once the outputs are sized
+  uint64_t allocs = rai::globalMemoryAllocs;
+  for(double t=C.begin(); t<C.end(); t+=1e-3){
+    PS.eval(y, yDot, yDDot, t);
+    PC.eval(y, yDot, yDDot, t);
+    C.eval(x, xDot, xDDot, t);
+  }
+  CHECK_EQ(rai::globalMemoryAllocs, allocs, "evaluation allocated");
+  cout <<"AllocationFree: ok" <<endl;
+}
+
+//==============================================================================
+
 int MAIN(int argc,char** argv){
   rai::initCmdLine(argc, argv);
 
   testBasics();
+  testAllocationFree();
 //  testSpeed();
 
 //  testPath();
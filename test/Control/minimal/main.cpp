@@ -1,4 +1,5 @@
 #include <Control/control.h>
+#include <Control/SecMPC.h>
 
 #include <Kin/viewer.h>
 #include <Kin/F_pose.h>
@@ -151,9 +152,67 @@ void testIneqCarrot(){
 
 //===========================================================================
 
+void testSecMPCThreaded(){
+  //a planar 3-link arm that reaches two targets in sequence
+  rai::Configuration C;
+  rai::Frame* link = C.addFrame("base");
+  link->setShape(rai::ST_box, {.1, .1, .1});
+  for(uint i=0;i<3;i++){
+    rai::Frame* pre = C.addFrame(STRING("pre" <<i), link->name);
+    pre->setRelativePosition({0., 0., i?.3:.05});
+    link = C.addFrame(STRING("link" <<i), pre->name);
+    link->setJoint(rai::JT_hingeX);
+  }
+  C.addFrame("gripper", link->name)->setRelativePosition({0., 0., .3});
+  C.addFrame("target1")->setPosition({0., .4, .4});
+  C.addFrame("target2")->setPosition({0., -.4, .4});
+
+  KOMO komo;
+  komo.setModel(C, false);
+  komo.setTiming(2., 1, 1., 1);
+  komo.add_qControlObjective({}, 1, 1e-1);
+  komo.addObjective({1.}, FS_positionDiff, {"gripper", "target1"}, OT_eq, {1e1});
+  komo.addObjective({2.}, FS_positionDiff, {"gripper", "target2"}, OT_eq, {1e1});
+  komo.optimize(0.);
+
+  SecMPC mpc(komo, 0, -1, 1e0, 1e0, false);
+  mpc.opt.verbose = 0;
+  mpc.opt.tauCutoff = .1;
+  mpc.startThreads(C);
+
+  //the control loop only publishes its state and follows the latest spline (a perfect joint controller)
+  arr q = C.getJointState(), qDot = zeros(q.N);
+  double ctrlTime=0., tau=.01, minDist=1.;
+  for(uint t=0;t<500;t++){
+    mpc.cycle(C, q, qDot, q, qDot, ctrlTime);
+    rai::CubicSplineCtor sp = mpc.getSpline(ctrlTime);
+    if(sp.pts.N){
+      rai::CubicSpline S;
+      S.set(sp.pts, sp.vels, sp.times);
+      q = S.eval(arr{tau}).reshape(-1);
+      qDot = S.eval(arr{tau}, 1).reshape(-1);
+      C.setJointState(q);
+    }
+    mpc.getShortPath(ctrlTime);
+    minDist = rai::MIN(minDist, length(C.getFrame("gripper")->getPosition() - C.getFrame("target1")->getPosition()));
+    ctrlTime += tau;
+    rai::wait(tau);
+  }
+  mpc.stopThreads();
+  mpc.reportLatency(cout);
+
+  CHECK_GE(mpc.wayStats.n, 1, "");
+  CHECK_GE(mpc.timingStats.n, 1, "");
+  CHECK_GE(mpc.shortStats.n, 1, "");
+  CHECK_LE(minDist, .05, "the first target was not reached");
+}
+
+//===========================================================================
+
 int main(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
+  testSecMPCThreaded();
   testMinimal();
 //  testGrasp();
 //  testIneqCarrot();
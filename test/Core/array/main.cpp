@@ -625,6 +625,45 @@ void TEST(PCA) {
 
 //===========================================================================
 
+void TEST(CholeskyModified){
+  cout <<"\n*** modified Cholesky\n";
+  uint n=50;
+  arr J = randn(2*n, n);
+  arr A = ~J*J, b = randn(n), L=A, d;
+
+  //pos-def: no shift, exact solve
+  double shift = choleskyModified(L, d);
+  arr x = choleskyModified_solve(L, d, b);
+  cout <<"pos-def: shift=" <<shift <<" error=" <<maxDiff(A*x, b) <<endl;
+  CHECK_EQ(shift, 0., "");
+  CHECK_ZERO(maxDiff(A*x, b), 1e-8, "");
+
+  //indefinite: shifted to pos-def, so that the solution is a descent direction for gradient -b
+  A -= 2.*max(A)*eye(n);
+  A(0,0) += 1e3;
+  L=A;
+  shift = choleskyModified(L, d);
+  x = choleskyModified_solve(L, d, b);
+  cout <<"indefinite: shift=" <<shift <<" min(d)=" <<min(d) <<" <x,b>=" <<scalarProduct(x, b) <<endl;
+  CHECK(shift>0., "");
+  CHECK_GE(min(d), 0., "");
+  CHECK_GE(scalarProduct(x, b), 0., "");
+
+  //the factors are exact for A plus a diagonal shift E with 0<=E<=shift, and x solves that shifted system
+  arr Lunit = eye(n);
+  for(uint i=0; i<n; i++) for(uint j=0; j<i; j++) Lunit(i,j) = L(i,j);
+  arr M = Lunit*diag(d)*~Lunit, E = M-A;
+  for(uint i=0; i<n; i++) {
+    CHECK_GE(E(i,i), -1e-8, "");
+    CHECK_LE(E(i,i), shift+1e-8, "");
+    E(i,i) = 0.;
+  }
+  CHECK_ZERO(absMax(E), 1e-8*absMax(A), "off-diagonal entries must not be modified");
+  CHECK_ZERO(maxDiff(M*x, b), 1e-8, "");
+}
+
+//===========================================================================
+
 void TEST(Inverse){
   cout <<"\n*** matrix inverse\n";
   uint m=300,n=300,svdr;
@@ -961,6 +1000,7 @@ int MAIN(int argc, char **argv){
   testSparseVector();
   testSparseMatrix();
   testInverse();
+  testCholeskyModified();
   testMM();
   testSVD();
   testPCA();
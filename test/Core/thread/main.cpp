@@ -201,6 +201,107 @@ void TEST(Logging){
   t2.threadClose();
 }
 
+//===========================================================================
+//
+// one writer and several readers of a joint state: Var<arr> (RWLock) vs. SeqVar<arr> (seqlock)
+
+void TEST(VarContention){
+  uint n=14, nReaders=3;
+  double duration=1.;
+  Var<arr> x;
+  x.set() = zeros(n);
+  SeqVar<arr> y(zeros(n));
+  Event listener;
+  listener.listenTo(y);
+
+  for(uint mode=0; mode<2; mode++){
+    std::atomic<bool> stop={false};
+    std::atomic<uint> reads={0};
+    std::vector<std::thread> readers;
+    for(uint r=0; r<nReaders; r++) readers.emplace_back([&](){
+      arr q(n);
+      for(; !stop; reads++){
+        if(mode==0) q = x.get()(); else y.get(q);
+        for(uint i=1; i<n; i++) CHECK_EQ(q(i), q(0), "torn read");
+      }
+    });
+
+    uint writes=0;
+    arr q(n);
+    double time=rai::realTime();
+    while(rai::realTime()-time<duration){
+      q = (double)writes;
+      if(mode==0) x.set() = q; else y.set(q);
+      writes++;
+    }
+    stop=true;
+    for(std::thread& th:readers) th.join();
+
+    cout <<(mode==0?"Var<arr>:    ":"SeqVar<arr>: ") <<writes/duration <<" writes/sec, " <<reads/duration <<" reads/sec" <<endl;
+    if(mode==1){
+      CHECK_EQ(y.getRevision(), writes, "");
+      CHECK_EQ(y.data->revision, writes, "");
+      CHECK_EQ(listener.getStatus(), (int)writes, "listeners missed writes");
+    }
+  }
+
+  //-- a set of the wrong size throws, but leaves the variable readable
+  bool thrown=false;
+  try { y.set(zeros(n+1)); } catch(...) { thrown=true; }
+  CHECK(thrown, "");
+  arr q;
+  CHECK_EQ(y.get(q), y.getRevision(), "");
+  CHECK_EQ(q.N, n, "");
+}
+
+//===========================================================================
+//
+// scalability of parallel_reduce over pool sizes, nested loops, task overhead
+
+void TEST(ThreadPool){
+  uint N=1<<20;
+  auto f = [](uint i){ double x=i; for(uint k=0; k<20; k++) x = .5*x + 1./(1.+x*x); return x; };
+
+  double serial=0.;
+  double time=rai::realTime();
+  for(uint i=0; i<N; i++) serial += f(i);
+  time = rai::realTime()-time;
+  cout <<"serial: " <<time <<"sec" <<endl;
+
+  uint maxThreads = std::max(4u, 2*std::thread::hardware_concurrency());
+  for(uint n=1; n<=maxThreads; n*=2){
+    ThreadPool pool(n-1);
+    double t=rai::realTime();
+    double s = parallel_reduce(0u, N, 0., f, std::plus<double>(), 0, pool);
+    t = rai::realTime()-t;
+    CHECK_ZERO(s-serial, 1e-9*serial, "");
+    CHECK_EQ(s, parallel_reduce(0u, N, 0., f, std::plus<double>(), 0, pool), "not deterministic");
+    cout <<"threads: " <<n <<" time: " <<t <<"sec  speedup: " <<time/t <<endl;
+  }
+
+  ThreadPool pool(3);
+
+  //-- nested loops
+  uintA count(64, 64);
+  count.setZero();
+  parallel_for(0, 64, [&](uint i){ parallel_for(0, 64, [&](uint j){ count(i, j)++; }, 0, pool); }, 1, pool);
+  for(uint c:count) CHECK_EQ(c, 1, "");
+
+  //-- exceptions are passed to the waiting thread
+  bool caught=false;
+  try{ parallel_for(0, 100, [](uint i){ if(i==42) HALT("task failed"); }, 1, pool); } catch(const std::exception&){ caught=true; }
+  CHECK(caught, "");
+  caught=false; //(all tasks throwing concurrently)
+  try{ parallel_for(0, 1000, [](uint){ throw std::runtime_error("task failed"); }, 1, pool); } catch(const std::runtime_error&){ caught=true; }
+  CHECK(caught, "");
+
+  //-- overhead per task
+  uint n=100000;
+  time = rai::realTime();
+  parallel_for(0, n, [](uint){}, 1, pool);
+  cout <<"per task: " <<1e9*(rai::realTime()-time)/n <<"nsec" <<endl;
+}
+
 //===========================================================================
 
 int MAIN(int argc,char** argv){
@@ -213,6 +314,8 @@ int MAIN(int argc,char** argv){
   testWay0();
   testWay1();
   testLogging();
+  testVarContention();
+  testThreadPool();
 
   return 0;
 }
@@ -1,7 +1,13 @@
+#define RAI_PROFILE //(profile this test, even if not compiled with PROFILE=1)
+
 #include <Core/util.h>
 #include <Core/graph.h>
+#include <Core/profiler.h>
 #include <math.h>
 #include <iomanip>
+#include <thread>
+#include <fstream>
+#include <map>
 
 void TEST(String){
   //-- basic IO
@@ -105,6 +111,121 @@ void TEST(Inotify){
   }
 }
 
+//===========================================================================
+
+double profiledWork(uint depth){
+  RAI_PROFILE("work");
+  RAI_PROFILE_COUNT("calls", 1);
+  double s=0.;
+  for(uint i=0;i<100000;i++) s += 1./(1.+i);
+  if(depth) for(uint k=0;k<2;k++) s += profiledWork(depth-1);
+  return s;
+}
+
+struct TraceEvent { std::string name; double ts, dur; uint tid; };
+
+rai::Array<TraceEvent> readTrace(const char* filename, std::map<uint, double>& calls){
+  //-- the file must be valid JSON; here just: balanced brackets outside of strings, no dangling commas
+  std::ifstream fil(filename);
+  std::string all((std::istreambuf_iterator<char>(fil)), std::istreambuf_iterator<char>());
+  std::string stack;
+  bool inString=false;
+  char last=0;
+  for(char c:all){
+    if(inString){ if(c=='"') inString=false; continue; }
+    if(c=='"') inString=true;
+    if(c=='{' || c=='[') stack.push_back(c=='{' ? '}' : ']');
+    if(c=='}' || c==']'){
+      CHECK(stack.size() && stack.back()==c, "unbalanced '" <<c <<"'");
+      CHECK(last!=',', "dangling comma");
+      stack.pop_back();
+    }
+    if(!isspace(c)) last=c;
+  }
+  CHECK(!inString && stack.empty(), "truncated trace");
+
+  //-- one event per line
+  rai::Array<TraceEvent> events;
+  std::istringstream is(all);
+  std::string line;
+  char name[64];
+  double ts, dur;
+  uint tid;
+  while(std::getline(is, line)){
+    if(sscanf(line.c_str(), "{\"name\":\"%63[^\"]\",\"ph\":\"X\",\"ts\":%lf,\"dur\":%lf,\"pid\":0,\"tid\":%u}", name, &ts, &dur, &tid)==4){
+      events.append({name, ts, dur, tid});
+    }
+    if(sscanf(line.c_str(), "{\"name\":\"calls\",\"ph\":\"C\",\"ts\":%lf,\"pid\":0,\"tid\":%u,\"args\":{\"value\":%lf}}", &ts, &tid, &dur)==3){
+      calls[tid] = dur;
+    }
+  }
+  return events;
+}
+
+void TEST(Profiler){
+  rai::Profiler::clear();
+  {
+    RAI_PROFILE("main");
+    profiledWork(3);
+    std::thread th([](){ profiledWork(2); });
+    th.join();
+  }
+  rai::Profiler::report();
+  rai::Profiler::writeChromeTrace("z.trace.json");
+
+  //-- per thread: the scopes of the recursion (1+2+4+8 on this thread, 1+2+4 on the other), each nested in its caller
+  std::map<uint, double> calls;
+  rai::Array<TraceEvent> events = readTrace("z.trace.json", calls);
+  std::map<uint, uint> works;
+  const TraceEvent* mainScope=0;
+  for(const TraceEvent& e:events){
+    CHECK_GE(e.dur, 0., "");
+    if(e.name=="work") works[e.tid]++;
+    if(e.name=="main"){ CHECK(!mainScope, ""); mainScope=&e; }
+  }
+  CHECK(mainScope, "");
+  CHECK_EQ(works.size(), 2, "");
+  for(auto& w:works) CHECK_EQ(w.second, (w.first==mainScope->tid ? 15 : 7), "");
+  for(auto& c:calls) CHECK_EQ(c.second, (c.first==mainScope->tid ? 15. : 7.), "");
+  for(const TraceEvent& e:events) if(e.tid==mainScope->tid && e.name=="work"){
+    CHECK(e.ts>=mainScope->ts && e.ts+e.dur<=mainScope->ts+mainScope->dur, "work scope not nested in main");
+  }
+  //(the recursion nests 4 resp. 3 levels deep, and the direct children of a call take at most as long as the call)
+  auto contains = [](const TraceEvent& e, const TraceEvent& f){ return &f!=&e && f.tid==e.tid && f.ts>=e.ts && f.ts+f.dur<=e.ts+e.dur; };
+  std::map<const TraceEvent*, uint> level;
+  for(const TraceEvent& e:events) if(e.name=="work"){
+    for(const TraceEvent& f:events) if(f.name=="work" && contains(f, e)) level[&e]++;
+    CHECK_LE(level[&e], (e.tid==mainScope->tid ? 3 : 2), "");
+  }
+  for(const TraceEvent& e:events) if(e.name=="work"){
+    uint n=0;
+    double children=0.;
+    for(const TraceEvent& f:events) if(f.name=="work" && contains(e, f) && level[&f]==level[&e]+1){ n++; children += f.dur; }
+    CHECK_EQ(n, (level[&e]==(e.tid==mainScope->tid ? 3u : 2u) ? 0 : 2), "");
+    CHECK_LE(children, e.dur, "");
+  }
+
+  //-- a scope that is open during clear() is dropped, and doesn't overwrite the events recorded after clear()
+  {
+    RAI_PROFILE("cleared");
+    rai::Profiler::clear();
+    { RAI_PROFILE("inner"); }
+    rai::wait(.01);
+  }
+  rai::Profiler::writeChromeTrace("z.trace.json");
+  events = readTrace("z.trace.json", calls);
+  CHECK_EQ(events.N, 1, "");
+  CHECK_EQ(events(0).name, "inner", "");
+  CHECK_LE(events(0).dur, 5e3, "the inner scope's end was overwritten");
+
+  //overhead per scope
+  double time=rai::realTime();
+  for(uint i=0;i<100000;i++){ RAI_PROFILE("empty"); }
+  cout <<"per scope: " <<1e4*(rai::realTime()-time) <<"nsec" <<endl;
+}
+
+//===========================================================================
+
 int MAIN(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
@@ -119,6 +240,7 @@ int MAIN(int argc,char** argv){
   testTimer();
   testLogging();
   testException();
+  testProfiler();
   testInotify();
 
   return 0;
@@ -1,4 +1,5 @@
 #include <Geo/geo.h>
+#include <Geo/depth2PointCloud.h>
 #include <Core/array.h>
 #include <Core/util.h>
 
@@ -56,11 +57,58 @@ void TEST(QuaternionJacobian){
 
 //===========================================================================
 
+void TEST(DepthToPointCloud){
+  //the plane z = -1 - y/2 (camera frame), with invalid (negative and nan) pixels
+  uint H=120, W=160;
+  floatA depth(H, W);
+  for(uint i=0;i<H;i++) for(uint j=0;j<W;j++) depth(i,j) = ((i*7+j*13)%31 ? 1./(1.+.5*(i-60.)/100.) : -1.);
+  for(uint i=0;i<H;i++) depth(i,W-1) = NAN;
+  arr Fxypxy = {100., 100., 80., 60.};
+  rai::Transformation X;
+  X.setRandom();
+
+  //-- the fused pipeline gives the valid points of the two-pass version
+  arr pts;
+  depthData2pointCloud(pts, depth, Fxypxy);
+  pts.reshape(H*W, 3);
+  X.applyOnPointArray(pts);
+
+  DepthToPointCloud D(Fxypxy);
+  D.computeNormals = true;
+  D.compute(depth, X);
+  uint n=0;
+  for(uint i=0;i<depth.N;i++) if(depth.elem(i)>=0.) n++;
+  CHECK_EQ(D.points.d0, n, "");
+  double err=0.;
+  for(uint k=0;k<n;k++) for(uint c=0;c<3;c++) err = rai::MAX(err, fabs(D.points(k,c)-pts(D.pixels(k),c)));
+  TEST_ZERO(err);
+
+  //-- normals of a plane are all equal (where the neighbors are valid) and face the camera
+  arr nrm = {0., .5, 1.};
+  nrm = X.rot.getArr() * (nrm/length(nrm));
+  uint m=0;
+  for(uint k=0;k<n;k++) if(D.normals(k,0)!=0.f || D.normals(k,1)!=0.f || D.normals(k,2)!=0.f) {
+    m++;
+    for(uint c=0;c<3;c++) CHECK_ZERO(D.normals(k,c)-nrm(c), 1e-3, "");
+  }
+  cout <<"normals: " <<m <<" of " <<n <<endl;
+  CHECK(m>n/2, "too few normals");
+
+  //-- voxel downsampling: one point per occupied voxel
+  D.voxelSize = .05;
+  D.compute(depth, X);
+  cout <<"voxels: " <<D.points.d0 <<endl;
+  CHECK(D.points.d0>0 && D.points.d0<n/10, "");
+}
+
+//===========================================================================
+
 int MAIN(int argc,char **argv){
   rai::initCmdLine(argc, argv);
 
   testBasics();
   testQuaternionJacobian();
+  testDepthToPointCloud();
 
   return 0;
 }
@@ -120,6 +120,29 @@ void TEST(Volume){
 
 //===========================================================================
 
+void TEST(Decimate){
+  rai::Mesh m;
+  m.setSphere(6);
+  OpenGL gl;
+  gl.add(drawInit,0);
+  gl.add(m);
+  gl.drawOptions.drawWires=true;
+  gl.watch();
+  for(uint target:{10000u, 1000u, 100u}){
+    double time=-rai::cpuTime();
+    m.decimate(target);
+    time+=rai::cpuTime();
+    double err=0.;
+    for(uint i=0;i<m.V.d0;i++) err=rai::MAX(err, fabs(length(m.V[i])-1.));
+    cout <<"decimated to #T=" <<m.T.d0 <<" (" <<time <<"sec) max radius error=" <<err <<" volume error=" <<4./3.*RAI_PI-m.getVolume() <<endl;
+    CHECK_LE(m.T.d0, target, "");
+    CHECK_EQ(int(m.V.d0)-int(m.T.d0/2), 2, "decimation changed the topology");
+    gl.watch();
+  }
+}
+
+//===========================================================================
+
 void TEST(DistanceFunctions) {
   rai::Transformation t;
   t.setRandom();
@@ -242,6 +265,7 @@ int MAIN(int argc, char** argv){
   testAddMesh();
   testMeshes3();
   testVolume();
+  testDecimate();
   testDistanceFunctions();
 //  testDistanceFunctions2();
   testSimpleImplicitSurfaces();
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <math.h>
 #include <GL/gl.h>
 
 #include <Geo/signedDistanceFunctions.h>
@@ -107,11 +108,120 @@ void TEST(DistanceFunctions2) {
 
 }
 
+//===========================================================================
+
+void TEST(SparseGrid) {
+  rai::Transformation pose;
+  pose.setRandom();
+  pose.pos *= .1;
+  SDF_ssBox box(pose, arr{.4, .6, .8}, .05);
+
+  arr lo = {-1., -1., -1.}, up = {1., 1., 1.};
+  SDF_SparseGrid S(box, lo, up, .01, .05);
+  cout <<"sparse grid: #bricks=" <<S.getNumBricks() <<" of " <<S.brickIndex.N <<" (memory ratio to dense: " <<S.getDenseSizeRatio() <<")" <<endl;
+
+  //-- batched query equals single queries, and matches the analytic function within the band
+  arr X = .5*randn(10000, 3);
+  arr y, g;
+  double time = -rai::cpuTime();
+  S.evalBatch(y, g, X);
+  time += rai::cpuTime();
+  cout <<"batched query of " <<X.d0 <<" points: " <<time <<"sec" <<endl;
+
+  double err=0.;
+  for(uint i=0; i<X.d0; i++) {
+    arr gi;
+    CHECK_ZERO(S.f(gi, NoArr, X[i]) - y(i), 1e-10, "");
+    CHECK_ZERO(maxDiff(gi, g[i]), 1e-10, "");
+    if(boundCheck(X[i], lo, up, 0., false)) {
+      double d = box.f(NoArr, NoArr, X[i]);
+      if(fabs(d)<.04) err = rai::MAX(err, fabs(d - y(i)));
+    }
+  }
+  cout <<"max error within band: " <<err <<endl;
+  CHECK_LE(err, .01, "");
+
+  for(uint i=0; i<10; i++) {
+    arr x = .3*randn(3);
+    checkGradient(S, x, 1e-4);
+  }
+}
+
 //===========================================================================
 //
 // implicit surfaces
 //
 
+void TEST(BatchEval) {
+  rai::Transformation pose;
+  pose.setRandom();
+  SDF_ssBox box(pose, arr{.4, .6, .8}, .05);
+  rai::Array<shared_ptr<SDF>> fcts = {
+    make_shared<SDF_Sphere>(pose, .5),
+    make_shared<SDF_ssBox>(pose, arr{.4, .6, .8}, .05),
+    make_shared<SDF_Cylinder>(pose, .8, .3),
+    make_shared<SDF_Capsule>(pose, .8, .3),
+    make_shared<SDF_SuperQuadric>(pose, arr{.4, .6, .8}, 4.),
+    make_shared<SDF_GridData>(box, arr{-1., -1., -1.}, arr{1., 1., 1.}, uintA{40, 50, 60}),
+  };
+
+  //-- the batched kernels equal the single-point evaluation
+  arr X = .6*randn(10000, 3);
+  for(shared_ptr<SDF>& f: fcts) {
+    arr y, g;
+    double time = -rai::cpuTime();
+    f->evalBatch(y, g, X);
+    time += rai::cpuTime();
+    cout <<"batched query of " <<X.d0 <<" points: " <<time <<"sec" <<endl;
+    for(uint i=0; i<X.d0; i++) {
+      arr gi;
+      CHECK_ZERO(f->f(gi, NoArr, X[i]) - y(i), 1e-10, "");
+      CHECK_ZERO(maxDiff(gi, g[i]), 1e-10, "");
+    }
+  }
+
+  //-- on the inner box of the ssBox (distance -r) the gradient is the normal of the nearest side
+  SDF_ssBox box0(rai::Transformation(0), arr{.4, .6, .8}, .05);
+  arr y, g, gi;
+  box0.evalBatch(y, g, arr{.15, 0., 0., .1, -.25, .2}.reshape(2, 3));
+  CHECK_ZERO(maxDiff(g, arr{1., 0., 0., 0., -1., 0.}.reshape(2, 3)), 1e-10, "");
+  box0.f(gi, NoArr, arr{.15, 0., 0.});
+  CHECK_ZERO(maxDiff(gi, g[0]), 1e-10, "");
+
+  //-- grid gradients (also outside the grid bounds)
+  SDF_GridData& grid = dynamic_cast<SDF_GridData&>(*fcts(-1));
+  for(uint i=0; i<20; i++) {
+    arr x = .8*randn(3);
+    checkGradient(grid, x, 1e-4);
+  }
+}
+
+//===========================================================================
+
+void TEST(ParallelImplicitSurface) {
+  rai::Transformation pose;
+  pose.setRandom();
+  pose.pos *= .1;
+  SDF_ssBox box(pose, arr{.4, .6, .8}, .05);
+
+  //-- slab-parallel marching cubes, with and without skipping blocks far from the surface
+  for(uint res:{64u, 128u, 256u}) {
+    rai::Mesh dense, adaptive;
+    double timeDense = -rai::realTime();
+    dense.setImplicitSurface(box, -1., 1., res);
+    timeDense += rai::realTime();
+    double timeAdaptive = -rai::realTime();
+    adaptive.setImplicitSurface(box, -1., 1., res, true);
+    timeAdaptive += rai::realTime();
+    cout <<"res=" <<res <<" #V=" <<dense.V.d0 <<" #T=" <<dense.T.d0 <<" time dense: " <<timeDense <<"sec adaptive: " <<timeAdaptive <<"sec" <<endl;
+    CHECK_EQ(dense.V.d0, adaptive.V.d0, "");
+    CHECK_EQ(dense.T.d0, adaptive.T.d0, "");
+    CHECK_ZERO(dense.getArea()-adaptive.getArea(), 1e-6, "");
+  }
+}
+
+//===========================================================================
+
 void TEST(SimpleImplicitSurfaces) {
   rai::Transformation pose;
   pose.setRandom();
@@ -207,6 +317,9 @@ int MAIN(int argc, char** argv){
 
   testDistanceFunctions();
   testDistanceFunctions2();
+  testSparseGrid();
+  testBatchEval();
+  testParallelImplicitSurface();
   testSimpleImplicitSurfaces();
 
   projectToSurface();
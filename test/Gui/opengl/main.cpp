@@ -385,11 +385,55 @@ void TEST(Image) {
 
 //extern void qtCheckInitialized();
 
+/************ retained-mode mesh buffers vs client arrays ************/
+
+void TEST(MeshBuffers) {
+  //a large mesh drawn at many poses -- like the same link in all KOMO time slices
+  rai::Mesh mesh;
+  mesh.setSphere(6);
+  mesh.scale(.1);
+  mesh.C = {.8, .5, .2};
+  rai::Array<rai::Transformation> poses(100);
+  for(uint i=0; i<poses.N; i++) { poses(i).setZero(); poses(i).pos.set(.3*(i%10)-1.5, .3*(i/10)-1.5, 0.); }
+
+  OpenGL gl("mesh buffers", 640, 480, true);
+  gl.add([&mesh, &poses](OpenGL& gl) { glStandardLight(nullptr, gl); mesh.glDrawInstances(gl, poses); });
+
+  //(float buffers vs double client arrays: allow rare off-by-a-few pixel values)
+  auto differ = [](const byteA& a, const byteA& b) {
+    uint n=0;
+    for(uint i=0; i<a.N; i++) if(abs(int(a.elem(i))-int(b.elem(i)))>2) n++;
+    return a.N!=b.N || n>a.N/1000;
+  };
+  byteA images[2];
+  for(bool buffers: {false, true}) {
+    gl.drawOptions.meshBuffers = buffers;
+    gl.renderInBack(); //(first frame uploads the buffers)
+    images[buffers] = gl.captureImage;
+    uint n=50;
+    double time = -rai::realTime();
+    for(uint k=0; k<n; k++) gl.renderInBack();
+    time += rai::realTime();
+    cout <<"offscreen frame time, " <<mesh.T.d0 <<" tris x " <<poses.N <<" instances, meshBuffers=" <<buffers <<": " <<1e3*time/n <<"ms" <<endl;
+  }
+  CHECK(!differ(images[1], images[0]), "buffers and client arrays render differently");
+
+  //-- in-place edits of a single vertex are re-uploaded (after changed())
+  mesh.V[mesh.V.d0/2] *= 10.; //(a spike in every instance)
+  mesh.changed();
+  gl.renderInBack();
+  images[1] = gl.captureImage;
+  gl.drawOptions.meshBuffers = false;
+  gl.renderInBack();
+  CHECK(!differ(images[1], gl.captureImage), "edited mesh was drawn from stale buffers");
+}
+
 int MAIN(int argc,char **argv){
   rai::initCmdLine(argc,argv);
 
   testTeapot();
   testOfflineRendering();
+  testMeshBuffers();
   testGrab();
   testMultipleViews();
   testUI();
@@ -2,6 +2,8 @@
 #include <Kin/F_collisions.h>
 #include <Kin/viewer.h>
 #include <Kin/F_pose.h>
+#include <Kin/F_forces.h>
+#include <Kin/frame.h>
 #include <Optim/NLP_Solver.h>
 
 #include <thread>
@@ -253,6 +255,61 @@ void TEST(Threading) {
 
 //===========================================================================
 
+void TEST(TorqueLimits){
+  //-- a 3-link arm; the 5th entry of the joint limits is the torque limit (see getTorqueLimits)
+  rai::Configuration C;
+  rai::Frame *prev = C.addFrame("base");
+  prev->setPosition({0, 0, .5});
+  for(uint i=0;i<3;i++){
+    if(i){ prev = C.addFrame(STRING("link"<<i), prev->name); prev->setRelativePosition({0, 0, .3}); } //(a joint frame's Q is its joint transform)
+    rai::Frame *f = C.addFrame(STRING("arm"<<i), prev->name);
+    f->setJoint(i ? rai::JT_hingeY : rai::JT_hingeZ);
+    f->setShape(rai::ST_box, {.05, .05, .3});
+    f->setMass(1.);
+    f->inertia->com = rai::Vector(0, 0, .15);
+    f->joint->limits = {-3., 3., 10., 10., 5.}; //(the unconstrained motion needs up to 7)
+    prev = f;
+  }
+  C.addFrame("endeff", "arm2")->setRelativePosition({0, 0, .3});
+  C.addFrame("target")->setPosition({.4, .2, .6});
+  C.setJointState({.3, .5, .5}); //(not upright: there, the hinge about z doesn't move the endeff)
+
+  KOMO komo;
+  komo.setModel(C, false);
+  komo.setTiming(1., 20, 1., 2);
+  komo.add_qControlObjective({}, 2, 1.);
+  komo.addObjective({1.}, FS_positionDiff, {"endeff", "target"}, OT_eq, {1e1});
+  komo.addObjective({1.}, FS_qItself, {}, OT_eq, {1e1}, {}, 1);
+  auto torques = komo.addObjective({}, FS_torqueLimits, {"arm0", "arm1", "arm2"}, OT_ineq);
+
+  //-- analytic Jacobian (via the inverse dynamics derivatives) vs. finite differences, on a random path
+  komo.run_prepare(.5);
+  shared_ptr<Feature> f = torques->feat;
+  VectorFunction torqueLimits = [&komo, &f](const arr& x) -> arr {
+    komo.pathConfig.setJointState(x);
+    return f->eval(f->getFrames(komo.pathConfig, komo.k_order+10));
+  };
+  arr x = komo.x;
+  CHECK(checkJacobian(torqueLimits, x, 1e-5), "");
+
+  uint K=100;
+  double time=rai::cpuTime();
+  for(uint k=0;k<K;k++) torqueLimits(x);
+  double tAnalytic=rai::cpuTime()-time;
+  for(uint k=0;k<K;k++) finiteDifferenceJacobian(torqueLimits, x);
+  double tFiniteDiff=rai::cpuTime()-time-tAnalytic;
+  cout <<"torque limits Jacobian (" <<x.N <<" path dofs): analytic=" <<1e3*tAnalytic/K <<"ms  finite differences=" <<1e3*tFiniteDiff/K <<"ms" <<endl;
+
+  //-- the optimized path respects the limits
+  komo.optimize(0.);
+  double maxViolation=-1.;
+  for(uint t=0;t<komo.T;t++) maxViolation = rai::MAX(maxViolation, max(f->eval(f->getFrames(komo.pathConfig, komo.k_order+t))));
+  cout <<"max torque limit violation=" <<maxViolation <<endl;
+  CHECK_LE(maxViolation, 1e-2, "");
+}
+
+//===========================================================================
+
 int MAIN(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
@@ -263,6 +320,7 @@ int MAIN(int argc,char** argv){
   testThin();
   testPR2();
   testThreading();
+  testTorqueLimits();
 
   return 0;
 }
@@ -5,6 +5,8 @@
 #include <Core/graph.h>
 #include <Kin/switch.h>
 #include <Kin/viewer.h>
+#include <Kin/frame.h>
+#include <Kin/proxy.h>
 
 using namespace std;
 
@@ -48,6 +50,158 @@ void testPickAndPlace(rai::ArgWord pathOrSeq){
 
 //===========================================================================
 
+void testPickAndPlaceCollisionTiming(){
+  rai::Configuration C;
+  C.addFile("model.g");
+
+  //same problem (T=100, with collisions) with serial and with parallel, change-aware collision queries, and with static frames shared across slices
+  arr x;
+  for(uint mode:{0, 1, 2}){
+    KOMO komo;
+    komo.opt.parallelCollisions = (mode>=1);
+    komo.opt.shareStaticFrames = (mode==2);
+    komo.setModel(C, true);
+    komo.setTiming(2.5, 40, 5., 2);
+    komo.add_qControlObjective({}, 2);
+    komo.addQuaternionNorms();
+    komo.add_collision(true);
+
+    rai::Skeleton S = {
+      { 1., 1., rai::SY_touch, {"gripper", "box2"} },
+      { 1., 2., rai::SY_stable, {"gripper", "box2"} },
+      { .8, 1.2, rai::SY_downUp, {"gripper"} },
+      { 1.8, 2.2, rai::SY_downUp, {"gripper"} },
+      { 2., 2., rai::SY_poseEq, {"box2", "target2"} },
+      { 2., -1., rai::SY_stable, {"table", "box2"} },
+    };
+    S.addObjectives(komo);
+
+    double time = -rai::realTime();
+    komo.optimize(0.); //no initialization noise, so that all runs are comparable
+    time += rai::realTime();
+    cout <<"parallelCollisions=" <<komo.opt.parallelCollisions <<" shareStaticFrames=" <<komo.opt.shareStaticFrames <<" T=" <<komo.T
+         <<" timeCollisions=" <<komo.timeCollisions <<" (total=" <<komo.timeTotal <<" wall=" <<time <<") #proxies=" <<komo.pathConfig.proxies.N <<endl;
+    if(mode==0) x = komo.x;
+    else if(mode==1){ CHECK_ZERO(maxDiff(x, komo.x), 1e-6, "parallel collision queries changed the solution"); }
+    else{ CHECK_ZERO(maxDiff(x, komo.x), 1e-3, "shared static frames changed the solution"); } //(only constant static-static proxies are dropped)
+  }
+}
+
+//===========================================================================
+
+void testParallelCollisionsAfterUpdate(){
+  //a 2-link arm reaching between boxes
+  rai::Configuration C;
+  rai::Frame* link = C.addFrame("base");
+  for(uint i=0;i<2;i++){
+    rai::Frame* pre = C.addFrame(STRING("pre" <<i), link->name);
+    pre->setRelativePosition({0., 0., i?.3:.05});
+    link = C.addFrame(STRING("link" <<i), pre->name);
+    link->setJoint(rai::JT_hingeX);
+    C.addFrame(STRING("shape" <<i), link->name)->setRelativePosition({0., 0., .15}).setShape(rai::ST_box, {.04, .04, .3}).setContact(1);
+  }
+  C.addFrame("gripper", link->name)->setRelativePosition({0., 0., .3});
+  for(uint i=0;i<10;i++){
+    C.addFrame(STRING("box" <<i))->setPosition({.1*i-.45, .3, .2}).setShape(rai::ST_box, {.08, .08, .08}).setContact(1);
+  }
+
+  //the per-slice collision managers report the same proxies as the serial query -- also after the boxes moved
+  KOMO komo[2];
+  for(uint k=0;k<2;k++){
+    komo[k].opt.parallelCollisions = k;
+    komo[k].setModel(C, true);
+    komo[k].setTiming(1., 10, 5., 2);
+    komo[k].add_qControlObjective({}, 2);
+    komo[k].add_collision(true);
+    komo[k].addObjective({1.}, FS_positionDiff, {"gripper", "box4"}, OT_eq, {1e1});
+    komo[k].optimize(0.);
+  }
+  CHECK_ZERO(maxDiff(komo[0].x, komo[1].x), 1e-6, "");
+  CHECK_EQ(komo[0].pathConfig.proxies.N, komo[1].pathConfig.proxies.N, "");
+  for(uint i=0;i<10;i++) C[STRING("box" <<i)]->setPosition({.1*i-.45, .2, .3});
+  for(uint k=0;k<2;k++){
+    komo[k].updateRootObjects(C);
+    komo[k].set_x(komo[0].x);
+  }
+  CHECK(komo[0].pathConfig.proxies.N>0, "");
+  CHECK_EQ(komo[0].pathConfig.proxies.N, komo[1].pathConfig.proxies.N, "");
+}
+
+//===========================================================================
+
+void testSharedStaticFramesTwoKomos(){
+  //a 3-link arm between static boxes
+  rai::Configuration C;
+  rai::Frame* link = C.addFrame("base");
+  for(uint i=0;i<3;i++){
+    rai::Frame* pre = C.addFrame(STRING("pre" <<i), link->name);
+    pre->setRelativePosition({0., 0., i?.3:.05});
+    link = C.addFrame(STRING("link" <<i), pre->name);
+    link->setJoint(rai::JT_hingeX);
+    rai::Frame* shape = C.addFrame(STRING("shape" <<i), link->name);
+    shape->setRelativePosition({0., 0., .15});
+    shape->setShape(rai::ST_box, {.04, .04, .3}).setContact(1);
+  }
+  C.addFrame("gripper", link->name)->setRelativePosition({0., 0., .3});
+  C.addFrame("target")->setPosition({0., .4, .4});
+  for(uint i=0;i<20;i++){
+    rai::Frame* box = C.addFrame(STRING("box" <<i));
+    box->setPosition({.14*(i%5)-.3, .6+.2*(i/5), .1}); //(neighbors in a row touch)
+    box->setShape(rai::ST_box, {.15, .15, .15}).setContact(1);
+  }
+  C.stepFcl();
+  uint nProxies = C.proxies.N;
+  CHECK(nProxies>0, "");
+
+  //the same problem without shared frames, as reference
+  KOMO komo0;
+  komo0.setModel(C, true);
+  komo0.setTiming(1., 20, 5., 2);
+  komo0.add_qControlObjective({}, 2);
+  komo0.add_collision(true);
+  komo0.addObjective({1.}, FS_positionDiff, {"gripper", "target"}, OT_eq, {1e1});
+  komo0.optimize(0.);
+
+  //two problems on the same model share its collision models: each needs its own static broadphase
+  for(uint k=0;k<2;k++){
+    KOMO komo;
+    komo.opt.shareStaticFrames = true;
+    komo.setModel(C, true);
+    komo.setTiming(1., 20, 5., 2);
+    komo.add_qControlObjective({}, 2);
+    komo.add_collision(true);
+    komo.addObjective({1.}, FS_positionDiff, {"gripper", "target"}, OT_eq, {1e1});
+    komo.optimize(0.);
+    //the boxes and the target exist once in the path configuration, the arm once per slice
+    CHECK_EQ(komo.pathConfig.frames.N, 23+9*komo.timeSlices.d0, "");
+    CHECK_ZERO(maxDiff(komo0.x, komo.x), 1e-10, "");
+
+    KOMO komo2;
+    komo2.clone(komo);
+    komo2.set_x(komo.x);
+    CHECK_EQ(komo2.pathConfig.proxies.N, komo.pathConfig.proxies.N, "");
+
+    //moving a static box: all slices see it at the new pose
+    if(k) continue;
+    rai::Frame* box = C["box0"];
+    uint nBox=0;
+    for(const rai::Proxy& p:komo.pathConfig.proxies) if(p.a->name=="box0" || p.b->name=="box0") nBox++;
+    CHECK(nBox>0, "");
+    box->setPosition({0., 0., -1.});
+    komo.updateRootObjects(C);
+    komo.set_x(komo.x);
+    for(uint s=0;s<komo.timeSlices.d0;s++) CHECK_ZERO(maxDiff(komo.timeSlices(s, box->ID)->getPosition(), box->getPosition()), 1e-10, "");
+    for(const rai::Proxy& p:komo.pathConfig.proxies) CHECK(p.a->name!="box0" && p.b->name!="box0", "proxy of the moved box");
+    box->setPosition({-.3, .6, .1});
+  }
+
+  //the model's own collision query still sees all (also the static) objects
+  C.stepFcl();
+  CHECK_EQ(C.proxies.N, nProxies, "");
+}
+
+//===========================================================================
+
 void testPickAndPush(rai::ArgWord pathOrSeq){
   rai::Configuration C;
   C.addFile("model.g");
@@ -370,6 +524,9 @@ int main(int argc,char** argv){
 
   testPickAndPlace(rai::_path);
 //  testPickAndPlace(rai::_sequence);
+  testPickAndPlaceCollisionTiming();
+  testParallelCollisionsAfterUpdate();
+  testSharedStaticFramesTwoKomos();
   testPickAndPush(rai::_path);
 //  testPickAndPush(rai::_sequence);
   testPickAndThrow(rai::_path);
@@ -1,6 +1,7 @@
 
 #include <Kin/frame.h>
 #include <Kin/cameraview.h>
+#include <Geo/depth2PointCloud.h>
 #include <Gui/viewer.h>
 
 //===========================================================================
@@ -43,11 +44,109 @@ void TEST(CameraView){
 
 }
 
+//===========================================================================
+
+void TEST(RayCast){
+  //-- a table with boxes and a sphere, seen from above
+  rai::Configuration K;
+  K.addFrame("table")->setShape(rai::ST_box, {2., 2., .1}).setColor({.6, .5, .4});
+  for(uint i=0; i<20; i++) {
+    rai::Frame* f = K.addFrame(STRING("box_" <<i));
+    f->setShape(rai::ST_box, {.1, .15, .05+.01*i}).setColor({.1+.04*i, .3, .8-.03*i});
+    f->setPosition({-.8+.08*i, .5*sin(.7*i), .1});
+  }
+  rai::Mesh sphere;
+  sphere.setSphere(5);
+  K.addFrame("sphere")->setMesh(sphere).setPosition({.3, -.4, .4}).setColor({.9, .2, .2});
+  K.addFrame("cam")->setPosition({0., 0., 3.});
+
+  rai::CameraView V(K, true, 0);
+  V.addSensor("kinect", "cam", 640, 480, 580./480., -1., {.1, 50.} );
+  V.renderMode = V.visuals;
+
+  //-- GL and CPU ray-cast depth should agree (up to pixel center conventions at depth discontinuities)
+  byteA image, imageRC;
+  floatA depth, depthRC;
+  V.computeImageAndDepth(image, depth);
+  V.rayCast = true;
+  V.computeImageAndDepth(imageRC, depthRC);
+  CHECK_EQ(depthRC.d0, depth.d0, "");
+  CHECK_EQ(depthRC.d1, depth.d1, "");
+  uint agree=0;
+  for(uint i=0; i<depth.N; i++) if(fabs(depth.elem(i)-depthRC.elem(i))<.01) agree++;
+  cout <<"depth agreement GL vs ray cast: " <<double(agree)/depth.N <<endl;
+  CHECK_GE(double(agree)/depth.N, .95, "ray-cast depth differs from GL depth");
+
+  //-- the compacted point cloud holds the valid points of the dense one
+  arr pts;
+  DepthToPointCloud cloud;
+  V.computePointCloud(pts, depthRC);
+  V.computePointCloud(cloud, depthRC);
+  pts.reshape(-1, 3);
+  uint valid=0;
+  for(float d:depthRC) if(d>=0.f) valid++;
+  CHECK_EQ(cloud.points.d0, valid, "");
+  double err=0.;
+  for(uint k=0; k<cloud.points.d0; k++) for(uint c=0; c<3; c++) err = rai::MAX(err, fabs(cloud.points(k, c)-pts(cloud.pixels(k), c)));
+  CHECK_ZERO(err, 1e-4, "");
+
+  //-- seg mode without labels gives id colors, on both paths
+  byteA segColors, segImage;
+  V.renderMode = V.seg;
+  V.computeSegmentation(segColors);
+  V.computeImageAndDepth(segImage, depthRC);
+  CHECK_EQ(segImage.nd, 3, "");
+  CHECK(segImage==segColors, "seg-mode image differs from the segmentation");
+  V.rayCast = false;
+  V.computeImageAndDepth(segImage, depth);
+  V.rayCast = true;
+  CHECK_EQ(segImage.nd, 3, "");
+  agree=0;
+  for(uint i=0; i<segImage.N/3; i++) if(color2id(segImage.p+3*i)==color2id(segColors.p+3*i)) agree++;
+  cout <<"segmentation agreement GL vs ray cast: " <<double(agree)/depth.N <<endl;
+  CHECK_GE(double(agree)/depth.N, .95, "ray-cast segmentation differs from GL segmentation");
+  V.renderMode = V.visuals;
+
+  uintA seg;
+  V.computeSegmentation(seg);
+
+  //-- editing a mesh of the view's copy (which bumps its revision) rebuilds its cached BVH
+  uint sphereId = K["sphere"]->ID;
+  uint nSphere=0, nScaled=0;
+  for(uint i:seg) if(i==sphereId) nSphere++;
+  V.C["sphere"]->getShape().mesh().scale(.5);
+  V.computeSegmentation(seg);
+  for(uint i:seg) if(i==sphereId) nScaled++;
+  CHECK(nScaled>0 && nScaled<nSphere/2, "ray caster did not notice the mesh edit");
+  V.C["sphere"]->getShape().mesh().scale(2.);
+
+  //-- frames per second at 640x480
+  uint n=20;
+  double time = -rai::realTime();
+  for(uint k=0; k<n; k++) V.computeImageAndDepth(imageRC, depthRC);
+  time += rai::realTime();
+  cout <<"ray cast 640x480 depth+rgb: " <<n/time <<" frames/sec" <<endl;
+
+  V.renderMode = V.seg;
+  time = -rai::realTime();
+  for(uint k=0; k<n; k++) V.computeSegmentation(seg);
+  time += rai::realTime();
+  cout <<"ray cast 640x480 segmentation: " <<n/time <<" frames/sec" <<endl;
+
+  V.rayCast = false;
+  V.renderMode = V.visuals;
+  time = -rai::realTime();
+  for(uint k=0; k<n; k++) V.computeImageAndDepth(image, depth);
+  time += rai::realTime();
+  cout <<"OpenGL 640x480 depth+rgb: " <<n/time <<" frames/sec" <<endl;
+}
+
 // =============================================================================
 
 int MAIN(int argc,char **argv){
   rai::initCmdLine(argc, argv);
 
+  testRayCast();
   testCameraView();
 
   return 0;
@@ -2,6 +2,8 @@
 //#include <Kin/kin_swift.h>
 #include <Gui/opengl.h>
 #include <Kin/frame.h>
+#include <Geo/fclInterface.h>
+#include <Core/thread.h>
 
 /*void TEST(Swift) {
   rai::Configuration C("swift_test.g");
@@ -101,10 +103,124 @@ void TEST(CollisionTiming){
   cout <<" query time: " <<rai::timerRead(true) <<"sec" <<endl;
 }
 
+//===========================================================================
+
+uintA sortedPairs(const uintA& collisions){ //(as sorted list of a*n+b, a<b)
+  uintA P;
+  for(uint i=0;i<collisions.d0;i++){
+    uint a=collisions(i,0), b=collisions(i,1);
+    if(a>b) std::swap(a,b);
+    P.append(a*100000+b);
+  }
+  return P.sort();
+}
+
+void TEST(FclCopiesAndReuse){
+  rai::Configuration C;
+  for(uint i=0;i<200;i++){
+    rai::Frame *a = C.addFrame(STRING("obj_i"<<i));
+    a->setShape(rai::ST_box, {.3, .3, .3});
+    a->setPosition(2.*rand(3));
+    a->setContact(1);
+  }
+  arr X = C.getFrameState();
+  rai::FclInterface& base = *C.fcl();
+  base.step(X);
+  uintA P = sortedPairs(base.collisions);
+  CHECK(P.N, "");
+
+  //copies share the models, but query on their own; an unchanged query reuses the last collisions
+  rai::FclInterface copy(base);
+  copy.step(X);
+  CHECK(sortedPairs(copy.collisions)==P, "");
+  double time = -rai::realTime();
+  for(uint k=0;k<100;k++) copy.step(X);
+  time += rai::realTime();
+  cout <<"100 unchanged queries: " <<time <<"sec" <<endl;
+  CHECK(sortedPairs(copy.collisions)==P, "");
+
+  //moving one object changes the collisions
+  arr X2 = X;
+  X2(0, {0, 2}) = X2(1, {0, 2});
+  copy.step(X2);
+  base.step(X2);
+  CHECK(sortedPairs(copy.collisions)==sortedPairs(base.collisions), "");
+  CHECK(sortedPairs(copy.collisions)!=P, "");
+
+  //copies can be queried concurrently
+  uint K=20;
+  rai::Array<shared_ptr<rai::FclInterface>> copies(K);
+  arrA Xs(K);
+  for(uint k=0;k<K;k++){
+    copies(k) = make_shared<rai::FclInterface>(base);
+    Xs(k) = X;
+    Xs(k)(k, {0, 2}) += .5;
+  }
+  parallel_for(0, K, [&](uint k){ copies(k)->step(Xs(k)); }, 1);
+  for(uint k=0;k<K;k++){
+    base.step(Xs(k));
+    CHECK(sortedPairs(copies(k)->collisions)==sortedPairs(base.collisions), "");
+  }
+
+  //static objects: pairs among them are not reported anymore
+  uintA statics;
+  for(uint i=10;i<X.d0;i++) statics.append(i);
+  rai::FclInterface split(base);
+  split.setStaticObjects(statics, X);
+  rai::FclInterface splitCopy(split);
+  splitCopy.step(X);
+  uintA P2;
+  for(uint p:P) if(p/100000<10) P2.append(p);
+  CHECK(sortedPairs(splitCopy.collisions)==P2, "");
+}
+
+//===========================================================================
+
+void TEST(MeshLods){
+  rai::Configuration C;
+  rai::Frame *a = C.addFrame("a"), *b = C.addFrame("b");
+  rai::Mesh sphere;
+  sphere.setSphere(4);
+  for(rai::Frame* f:{a, b}) f->setMesh(sphere).setContact(1);
+  b->setPosition({1.5, 0., 0.});
+  rai::Shape& s = *a->shape;
+
+  //-- levels are cached, and rebuilt when the mesh is modified (its revision changes)
+  shared_ptr<rai::Mesh> l1 = s.lod(1);
+  CHECK_LE(l1->T.d0, s.mesh().T.d0/4, "");
+  CHECK(s.lod(1)==l1, "lod was not cached");
+  s.mesh().scale(2.);
+  shared_ptr<rai::Mesh> l1b = s.lod(1);
+  CHECK(l1b!=l1, "mesh modification was not noticed");
+  CHECK_ZERO(absMax(l1b->V)-2.*absMax(l1->V), 1e-10, "");
+
+  a->setColor({1., 0., 0.});
+  CHECK(s.lod(1)==l1b, "");
+  CHECK(s.lod(1)->C==arr({1., 0., 0.}), "lod does not follow the shape color");
+
+  //-- copies build their own chain
+  rai::Configuration C2;
+  C2.copy(C);
+  CHECK(!C2.frames(0)->shape->_lods.N, "");
+  CHECK(C2.frames(0)->shape->lod(1)!=l1b, "");
+
+  //-- a different collision level of detail rebuilds the interface
+  auto fcl1 = C.fcl(1);
+  CHECK(C.fcl()==fcl1, "");
+  CHECK(C.fcl(1)==fcl1, "");
+  auto fcl0 = C.fcl(0);
+  CHECK(fcl0!=fcl1, "");
+  C.stepFcl();
+}
+
+//===========================================================================
+
 int MAIN(int argc, char** argv){
   rai::initCmdLine(argc, argv);
 
   //  testSwift();
+  testMeshLods();
+  testFclCopiesAndReuse();
   testFCL();
   testCollisionTiming();
 
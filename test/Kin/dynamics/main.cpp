@@ -1,4 +1,6 @@
 #include <Kin/kin.h>
+#include <Kin/frame.h>
+#include <Kin/kin_feather.h>
 #include <Kin/kin_ode.h>
 #include <Algo/spline.h>
 #include <Algo/algos.h>
@@ -92,9 +94,125 @@ void TEST(Dynamics){
 
 // =============================================================================
 
+//---------- ABA and RNEA: consistency with M, F and their Jacobians
+
+void TEST(RecursiveDynamics){
+  //a chain of hinges and translations with offset centers of mass
+  auto chain = [](rai::Configuration& C, uint n){
+    C.addFrame("base")->setPosition({0,0,1.});
+    rai::Frame *prev=C.frames.last();
+    for(uint i=0;i<n;i++){
+      rai::Frame *f = C.addFrame(STRING("l"<<i), prev->name);
+      rai::JointType type = rai::JointType(rai::JT_hingeX + i%3);
+      if(i%5==3) type = rai::JT_transX;
+      if(i==1) type = rai::JT_transXY;
+      if(i==6) type = rai::JT_trans3;
+      f->setJoint(type);
+      f->setRelativePosition({.05*(i%2), .1, .2});
+      f->setShape(rai::ST_box, {.1, .1, .2});
+      new rai::Inertia(*f);
+      f->inertia->mass = 1.+.1*i;
+      f->inertia->com = rai::Vector(.02, -.03*(i%2), .1);
+      f->inertia->matrix.setDiag(arr{.01, .012, .008});
+      prev = f;
+    }
+  };
+
+  for(uint n:{6, 11, 27}){
+    rai::Configuration C;
+    chain(C, n);
+    uint d = C.getJointStateDimension();
+    CHECK_EQ(d, n+(n>1)+2*(n>6), "");
+    arr q=randn(d), qd=randn(d), tau=randn(d);
+    C.setJointState(q);
+
+    arr M, F, qdd, tau2;
+    C.equationOfMotion(M, F, qd);
+    C.fwdDynamics(qdd, qd, tau);
+    C.inverseDynamics(tau2, qd, qdd);
+    double err = maxDiff(M*qdd+F, tau) + maxDiff(tau2, tau);
+    cout <<"dofs=" <<d <<"  fwd-inv error=" <<err <<endl;
+    CHECK_LE(err, 1e-8, "ABA, RNEA and M,F inconsistent");
+
+    //Jacobians w.r.t. q, qd, and qdd or tau
+    for(uint wrt=0;wrt<3;wrt++){
+      VectorFunction inv = [&](const arr& x) -> arr {
+        arr y, J;
+        if(wrt==0){ C.setJointState(x); C.inverseDynamics(y, qd, qdd, true, J); }
+        if(wrt==1){ C.setJointState(q);  C.inverseDynamics(y, x, qdd, true, NoArr, J); }
+        if(wrt==2){ C.setJointState(q);  C.inverseDynamics(y, qd, x, true, NoArr, NoArr, J); }
+        y.J() = J;
+        return y;
+      };
+      VectorFunction fwd = [&](const arr& x) -> arr {
+        arr y, J;
+        if(wrt==0){ C.setJointState(x); C.fwdDynamics(y, qd, tau, true, J); }
+        if(wrt==1){ C.setJointState(q);  C.fwdDynamics(y, x, tau, true, NoArr, J); }
+        if(wrt==2){ C.setJointState(q);  C.fwdDynamics(y, qd, x, true, NoArr, NoArr, J); }
+        y.J() = J;
+        return y;
+      };
+      arr x = (wrt==0 ? q : (wrt==1 ? qd : qdd));
+      CHECK(checkJacobian(inv, x, 1e-3), "");
+      if(wrt==2) x = tau;
+      CHECK(checkJacobian(fwd, x, 1e-3), "");
+    }
+    C.setJointState(q);
+
+    //external forces (at the centers of mass) and torques, in world coordinates, enter as -J^T f
+    arr tau0, tau1, qdd1, JTf=zeros(d);
+    C.inverseDynamics(tau0, qd, qdd);
+    FeatherstoneInterface& fs = C.fs();
+    for(uint i=2;i<fs.tree.N;i+=3){
+      F_Link& link = fs.tree(i);
+      link.force = rai::Vector(randn(3));
+      link.torque = rai::Vector(randn(3));
+      rai::Frame *f = C.frames(link.ID);
+      arr Jpos, Jang;
+      C.jacobian_pos(Jpos, f, f->ensure_X()*link.com);
+      C.jacobian_angular(Jang, f);
+      JTf += ~Jpos*link.force.getArr() + ~Jang*link.torque.getArr();
+    }
+    C.inverseDynamics(tau1, qd, qdd);
+    C.fwdDynamics(qdd1, qd, tau1);
+    err = maxDiff(tau1, tau0-JTf) + maxDiff(qdd1, qdd);
+    cout <<"dofs=" <<d <<"  external forces error=" <<err <<endl;
+    CHECK_LE(err, 1e-8, "external forces are not -J^T f");
+    VectorFunction onlyExt = [&](const arr& x) -> arr { //(the link frames rotate the world-fixed forces)
+      arr y, J;
+      C.setJointState(x);
+      C.inverseDynamics(y, zeros(d), zeros(d), false, J);
+      y.J() = J;
+      return y;
+    };
+    CHECK(checkJacobian(onlyExt, q, 1e-5), "");
+    C.setJointState(q);
+
+    //gravity as external forces
+    for(F_Link& link:fs.tree) link.torque.setZero();
+    fs.setGravity();
+    C.inverseDynamics(tau1, qd, qdd, false);
+    fs.setGravity(0.);
+    C.inverseDynamics(tau0, qd, qdd, true);
+    CHECK_LE(maxDiff(tau1, tau0), 1e-8, "gravity as root acceleration and as external forces differ");
+
+    //O(n) ABA vs. O(n^3) M^{-1}(tau-F), for 7, 14 and 30 dofs
+    uint K=1000;
+    double time=rai::cpuTime();
+    for(uint k=0;k<K;k++) C.fwdDynamics(qdd, qd, tau);
+    double tABA=rai::cpuTime()-time;
+    for(uint k=0;k<K;k++){ fs.update(); fs.fwdDynamics_MF(qdd, qd, tau); }
+    double tMF=rai::cpuTime()-time-tABA;
+    cout <<"dofs=" <<d <<"  time ABA=" <<1e6*tABA/K <<"us  MF=" <<1e6*tMF/K <<"us" <<endl;
+  }
+}
+
+// =============================================================================
+
 int MAIN(int argc,char **argv){
   rai::initCmdLine(argc, argv);
 
+  testRecursiveDynamics();
   testDynamics();
 
   return 0;
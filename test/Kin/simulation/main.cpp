@@ -321,9 +321,81 @@ void testMotors(){
 
 //===========================================================================
 
+void testKinematicStep(){
+  //a planar 2-link arm
+  rai::Configuration C;
+  rai::Frame* link = C.addFrame("base");
+  for(uint i=0;i<2;i++){
+    rai::Frame* pre = C.addFrame(STRING("pre" <<i), link->name);
+    pre->setRelativePosition({0., 0., .3});
+    link = C.addFrame(STRING("link" <<i), pre->name);
+    link->setJoint(rai::JT_hingeX);
+    link->setShape(rai::ST_box, {.05, .05, .3});
+  }
+
+  rai::Simulation S(C, S._kinematic, 0);
+  double tau=.01;
+
+  //position control: the reference is the next state
+  arr q = {.3, -.2};
+  S.step(q, tau, S._position);
+  CHECK_ZERO(maxDiff(C.getJointState(), q), 1e-10, "");
+
+  //velocity control integrates
+  arr qDot = {1., .5};
+  for(uint t=0;t<10;t++) S.step(qDot, tau, S._velocity);
+  CHECK_ZERO(maxDiff(C.getJointState(), q+10.*tau*qDot), 1e-10, "");
+  CHECK_ZERO(maxDiff(S.qDot, qDot), 1e-10, "");
+
+  //no control: the state stays
+  S.step({}, tau, S._none);
+  CHECK_ZERO(maxDiff(C.getJointState(), q+10.*tau*qDot), 1e-10, "");
+}
+
+//===========================================================================
+
+void testBatch(){
+  rai::Configuration C;
+  C.addFile(rai::raiPath("../rai-robotModels/scenarios/liftRing.g"));
+  C.addFrame("batchCam")->setPosition({0., 0., 3.});
+
+  uint N=32;
+  rai::SimulationBatch B(C, N, rai::Simulation::_kinematic);
+  B.addSensor("batchCam", 160, 120, 1.);
+
+  //different initial states, same velocity control
+  arr Q0 = repmat(~C.getJointState(), N, 1) + .1*randn(N, C.getJointStateDimension());
+  B.setJointStates(Q0);
+  arr U = .1*ones(N, Q0.d1);
+
+  double tau=.01;
+  byteA images;
+  floatA depths;
+  double time=-rai::realTime();
+  for(uint t=0;t<100;t++){
+    B.step(U, tau, rai::Simulation::_velocity);
+    if(!(t%10)) B.getImagesAndDepths(images, depths);
+  }
+  time += rai::realTime();
+  cout <<N <<" envs, 100 steps, 10 renderings: " <<time <<"sec" <<endl;
+
+  //each env behaves as a single simulation
+  rai::Configuration C1(C);
+  rai::Simulation S(C1, S._kinematic, 0);
+  C1.setJointState(Q0[3]);
+  for(uint t=0;t<100;t++) S.step(U[3], tau, S._velocity);
+  CHECK_ZERO(maxDiff(C1.getJointState(), B.getJointStates()[3]), 1e-10, "batch env differs from single simulation");
+  CHECK_EQ(images.nd, 4, "");
+  CHECK_EQ(depths.d0, N, "");
+}
+
+//===========================================================================
+
 int MAIN(int argc,char **argv){
   rai::initCmdLine(argc, argv);
 
+  testKinematicStep();
+  testBatch();
   testMotors();
   testRndScene();
   testFriction();
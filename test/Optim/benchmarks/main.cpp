@@ -1,6 +1,7 @@
 #include <KOMO/opt-benchmarks.h>
 #include <Optim/NLP_Solver.h>
 #include <KOMO/komo.h>
+#include <Optim/benchmarks.h>
 
 
 //===========================================================================
@@ -44,12 +45,41 @@ void TEST(Skeleton_Handover) {
 
 //===========================================================================
 
+void TEST(LBFGS) {
+  //L-BFGS (with augmented Lagrangian outer loop) vs Newton inner steps on Optim and KOMO benchmarks
+  OptBench_InvKin_Endeff ik("../../KOMO/switches/model2.g", true);
+  rai::Array<shared_ptr<NLP>> problems = {
+    make_shared<NLP_Squared>(20, 100., true),
+    make_shared<NLP_TrivialSquareFunction>(10, .5, 1.), //optimum at the lower bound
+    make_shared<NLP_HalfCircle>(),
+    make_shared<NLP_CircleLine>(),
+    make_shared<NLP_Wedge>(),
+    ik.get() };
+
+  for(shared_ptr<NLP>& P:problems){
+    arr x_init = P->getInitializationSample();
+    for(NLP_SolverID sid:{NLPS_augmentedLag, NLPS_LBFGS}){
+      NLP_Solver S;
+      S.setSolver(sid).setProblem(P).setInitialization(x_init);
+      S.opt.set_verbose(0).set_stopTolerance(1e-5);
+      auto ret = S.solve();
+      cout <<"dim:" <<P->getDimension() <<' ' <<rai::Enum<NLP_SolverID>(sid) <<" \tevals:" <<ret->evals <<" \ttime:" <<ret->time
+           <<" \tf:" <<ret->f <<" sos:" <<ret->sos <<" eq:" <<ret->eq <<" ineq:" <<ret->ineq <<endl;
+      CHECK(ret->feasible, "");
+      if(sid==NLPS_LBFGS) CHECK_LE(ret->eq+ret->ineq, 1e-4, "");
+    }
+  }
+}
+
+//===========================================================================
+
 int MAIN(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
 //  rnd.clockSeed();
   rnd.seed(0);
 
+  testLBFGS();
   testKOMO_IK();
   testSkeleton_Handover();
 
@@ -52,12 +52,47 @@ void TEST(Solver) {
 
 //===========================================================================
 
+struct NLP_SquaredFromOnes : NLP_Squared {
+  using NLP_Squared::NLP_Squared;
+  arr getInitializationSample(const arr& previousOptima={}){ return ones(n); } //(rnd is not thread safe)
+};
+
+struct NLP_Failing : NLP_SquaredFromOnes {
+  using NLP_SquaredFromOnes::NLP_SquaredFromOnes;
+  void evaluate(arr& phi, arr& J, const arr& x){ HALT("evaluation failed"); }
+};
+
+void TEST(SolveInParallel) {
+  rai::OptOptions opt;
+  opt.verbose=0;
+  rai::Array<shared_ptr<NLP>> Ps;
+  for(uint i=0;i<8;i++) Ps.append(make_shared<NLP_SquaredFromOnes>(5+i, 10.));
+
+  for(uint numThreads:{0, 1, 3}){
+    rai::Array<shared_ptr<SolverReturn>> R = NLP_solveInParallel(Ps, NLPS_newton, opt, numThreads);
+    CHECK_EQ(R.N, Ps.N, "");
+    for(uint i=0;i<R.N;i++){
+      CHECK(R(i) && R(i)->evals>0, "problem " <<i <<" not solved");
+      CHECK_ZERO(absMax(R(i)->x), 1e-2, "");
+    }
+  }
+
+  //an exception of one solver reaches the caller
+  Ps(3) = make_shared<NLP_Failing>(5, 10.);
+  bool thrown=false;
+  try{ NLP_solveInParallel(Ps, NLPS_newton, opt, 3); } catch(const std::exception&){ thrown=true; }
+  CHECK(thrown, "the exception of a solver was lost");
+}
+
+//===========================================================================
+
 int MAIN(int argc,char** argv){
   rai::initCmdLine(argc,argv);
 
   rnd.clockSeed();
 
 //  testDisplay();
+  testSolveInParallel();
   testSolver();
 
   return 0;
@@ -0,0 +1,121 @@
+#include <Perception/depth_packing.h>
+#include <Perception/simulationLog.h>
+
+#include <math.h>
+#include <fstream>
+
+//===========================================================================
+
+floatA rndDepth(uint H, uint W, double scale){
+  floatA depth(H, W);
+  for(uint i=0;i<depth.N;i++) depth.elem(i) = scale*(1000+rnd(30000)); //(on the grid)
+  depth(0,0) = -1.;
+  depth(0,1) = NAN;
+  depth(1,0) = 0.;
+  return depth;
+}
+
+void testDepthCodec(){
+  double scale=1e-4;
+  for(uint k=0;k<2;k++){
+    floatA depth = rndDepth(4, 7, scale);
+    if(k) depth.reshape(depth.N); //1-D arrays are (1,N) images
+    uint H = (depth.nd==2 ? depth.d0 : 1), W = depth.N/H;
+
+    uint16A d16, d16b;
+    CHECK(rai::depth2depth16(d16, depth, scale), "");
+    byteA buffer;
+    rai::pack_depth16(d16, buffer);
+    rai::unpack_depth16(d16b, buffer.p, buffer.N, H, W);
+    CHECK_EQ(d16b.N, d16.N, "");
+    for(uint i=0;i<d16.N;i++) CHECK_EQ(d16b.elem(i), d16.elem(i), "");
+
+    floatA depth2;
+    rai::depth162depth(depth2, d16b, scale);
+    for(uint i=0;i<depth.N;i++){
+      if(depth.elem(i)>0.f){ CHECK_LE(fabs(depth2.elem(i)-depth.elem(i)), 1e-6, ""); }
+      else{ CHECK_EQ(depth2.elem(i), -1.f, "invalid depths decode as -1"); }
+    }
+  }
+
+  //-- far (and positive but too small) depths are reported
+  floatA depth = rndDepth(4, 7, scale);
+  uint16A d16;
+  depth(2,3) = 7.;
+  CHECK(!rai::depth2depth16(d16, depth, scale), "");
+  CHECK(rai::depth2depth16(d16, depth, 2e-4), "");
+  depth(2,3) = 1e-5;
+  CHECK(!rai::depth2depth16(d16, depth, scale), "");
+}
+
+//===========================================================================
+
+void testLogRoundTrip(){
+  double scale=1e-4;
+  uint T=5, H=12, W=16;
+  rai::Array<arr> qs, Xs;
+  rai::Array<byteA> rgbs;
+  rai::Array<floatA> depths;
+  {
+    rai::SimulationLogWriter log("z.simLog", rai::SimulationLogWriter::depth16, scale);
+    for(uint t=0;t<T;t++){
+      arr q = randn(10), X = randn(6, 7);
+      byteA rgb(H, W, 3);
+      for(uint i=0;i<rgb.N;i++) rgb.elem(i) = rnd(256);
+      floatA depth = rndDepth(H, W, scale);
+      if(t==2) depth(5,5) = 8.5; //beyond the 16 bit range: this record is stored as float
+      log.append(.1*t, q, X, rgb, depth);
+      qs.append(q);  Xs.append(X);  rgbs.append(rgb);  depths.append(depth);
+    }
+  }
+
+  rai::SimulationLogReader log("z.simLog");
+  CHECK_EQ(log.N(), T, "");
+  CHECK_EQ(log.seek(.25), 2, "");
+  for(uint t=0;t<T;t++){
+    arr q, X;
+    byteA rgb;
+    floatA depth;
+    double time = log.getState(t, q, X);
+    log.getImages(t, rgb, depth);
+    CHECK_EQ(time, .1*t, "");
+    CHECK_ZERO(maxDiff(q, qs(t)), 0., "");
+    CHECK_ZERO(maxDiff(X, Xs(t)), 0., "");
+    CHECK(rgb==rgbs(t), "");
+    CHECK_EQ(depth.d0, H, "");
+    CHECK_EQ(depth.d1, W, "");
+    for(uint i=0;i<depth.N;i++){
+      float d = depths(t).elem(i);
+      if(t==2){ CHECK(depth.elem(i)==d || (d!=d && depth.elem(i)!=depth.elem(i)), "float records are exact"); }
+      else if(d>0.f){ CHECK_LE(fabs(depth.elem(i)-d), 1e-6, ""); }
+      else{ CHECK_EQ(depth.elem(i), -1.f, ""); }
+    }
+  }
+
+  //-- an interrupted recording (no index, last chunk cut off) is scanned up to the last complete chunk
+  std::ifstream is("z.simLog", std::ios::binary);
+  std::string file((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+  std::ofstream("z.cut.simLog", std::ios::binary).write(file.data(), file.size()-200);
+  CHECK_EQ(rai::SimulationLogReader("z.cut.simLog").N(), T-1, "");
+
+  //-- a corrupt index offset is reported, not dereferenced
+  uint64_t off = file.size(); //(the last index entry's offset)
+  memcpy(&file[file.size()-24], &off, 8);
+  std::ofstream("z.bad.simLog", std::ios::binary).write(file.data(), file.size());
+  bool thrown=false;
+  try{ rai::SimulationLogReader log("z.bad.simLog"); } catch(...){ thrown=true; }
+  CHECK(thrown, "corrupt index not detected");
+}
+
+//===========================================================================
+
+int MAIN(int argc,char **argv){
+  rai::initCmdLine(argc, argv);
+
+  rnd.seed(0);
+
+  testDepthCodec();
+  testLogRoundTrip();
+
+  return 0;
+}